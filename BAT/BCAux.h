@@ -23,6 +23,7 @@
 // ---------------------------------------------------------
 
 #include <string>
+#include <vector>
 
 #include "BCHistogramBase.h"
 #include "BCH1D.h"
@@ -82,6 +83,26 @@ std::string SafeName(const std::string& name);
  * @return Whether character is allowed in a safe name. */
 bool AllowedCharacter(char c);
 
+/**
+ * Parse a decimal number independent of the locale. Numbers with up
+ * to 19 significant digits are converted without copying the text:
+ * directly if mantissa and power of ten are exact doubles, otherwise
+ * by strtod on the digits and exponent. All others are converted by
+ * the standard library in the "C" locale.
+ * @param begin First character
+ * @param end Past the last character
+ * @param value Set to the number
+ * @return Whether all characters form one number. */
+bool ParseNumber(const char* begin, const char* end, double& value);
+
+/**
+ * Parse all numbers separated by white space in a range of text.
+ * @param begin First character
+ * @param end Past the last character
+ * @param values The numbers are appended.
+ * @return Whether all tokens are numbers; parsing stops at the first other token. */
+bool ParseNumbers(const char* begin, const char* end, std::vector<double>& values);
+
 /** An enumerator for the knowledge update drawing style presets. */
 enum BCKnowledgeUpdateDrawingStyle {
     kKnowledgeUpdateDefaultStyle      = 0, ///< Simple line-drawn histograms
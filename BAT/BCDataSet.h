@@ -9,8 +9,11 @@
  * \version 1.0
  * \date 08.2008
  * \detail This class represents a data set containing a set of data
- * points. The data points are organized in a vector. The class
- * provides functions to read in data from a file.
+ * points. The values are stored in one contiguous column per
+ * component, so a loop over one component of all data points runs
+ * over consecutive memory; see GetColumn(). Single data points are
+ * accessed through lightweight row views. The class provides
+ * functions to read in data from a file.
  */
 
 /*
@@ -40,6 +43,117 @@ class BCDataSet
 {
 public:
 
+    class ConstRow;
+
+    /**
+     * \brief View of one data point of a data set.
+     * \detail The values stay in the columns of the data set; the view
+     * is invalidated when data points are added or the data set is reset. */
+    class Row
+    {
+    public:
+
+        /**
+         * Constructor
+         * @param columns The columns of the data set
+         * @param row The index of the data point */
+        Row(std::vector<double*>& columns, unsigned row)
+            : fColumns(&columns), fRow(row)
+        {}
+
+        /**
+         * Raw and fast access. */
+        double& operator[](unsigned index) const
+        { return (*fColumns)[index][fRow]; }
+
+        /**
+         * Safer access, but slower
+         * @param index The index of the variable.
+         * @return The value of the variable. */
+        double GetValue(unsigned index) const
+        { return fColumns->at(index)[fRow]; }
+
+        /**
+         * Safer, but slower, value setting of a variable.
+         * @param index The index of the variable
+         * @param value The value of the variable */
+        void SetValue(unsigned index, double value) const
+        { fColumns->at(index)[fRow] = value; }
+
+        /**
+         * @return A copy of the values. */
+        std::vector<double> GetValues() const;
+
+        /**
+         * @return The number of values. */
+        unsigned GetNValues() const
+        { return fColumns->size(); }
+
+        /**
+         * Print summary of data point to the string handler.
+         * @param output String handler (default = BCLog::OutSummary. */
+        void PrintSummary(void (*output)(const std::string&) = BCLog::OutSummary) const
+        { BCDataPoint(GetValues()).PrintSummary(output); }
+
+    private:
+        friend class ConstRow;
+        std::vector<double*>* fColumns;
+        unsigned fRow;
+    };
+
+    /**
+     * \brief Read-only view of one data point of a data set.
+     * \detail See Row. */
+    class ConstRow
+    {
+    public:
+
+        /**
+         * Constructor
+         * @param columns The columns of the data set
+         * @param row The index of the data point */
+        ConstRow(const std::vector<double*>& columns, unsigned row)
+            : fColumns(&columns), fRow(row)
+        {}
+
+        /**
+         * Conversion from a writable view. */
+        ConstRow(const Row& row)
+            : fColumns(row.fColumns), fRow(row.fRow)
+        {}
+
+        /**
+         * Raw and fast access. */
+        const double& operator[](unsigned index) const
+        { return (*fColumns)[index][fRow]; }
+
+        /**
+         * Safer access, but slower
+         * @param index The index of the variable.
+         * @return The value of the variable. */
+        double GetValue(unsigned index) const
+        { return fColumns->at(index)[fRow]; }
+
+        /**
+         * @return A copy of the values. */
+        std::vector<double> GetValues() const;
+
+        /**
+         * @return The number of values. */
+        unsigned GetNValues() const
+        { return fColumns->size(); }
+
+        /**
+         * Print summary of data point to the string handler.
+         * @param output String handler (default = BCLog::OutSummary. */
+        void PrintSummary(void (*output)(const std::string&) = BCLog::OutSummary) const
+        { BCDataPoint(GetValues()).PrintSummary(output); }
+
+    private:
+        const std::vector<double*>* fColumns;
+        unsigned fRow;
+    };
+
     /** \name Constructors and destructor */
     /** @{ */
 
@@ -48,9 +162,18 @@ public:
      * @param n Dimensionality (Number of values inside) of data points. */
     BCDataSet(unsigned n = 0);
 
+    /**
+     * Copy constructor. The copy of a memory-mapped data set holds its
+     * values in memory. */
+    BCDataSet(const BCDataSet& other);
+
     /**
      * Destructor */
-    virtual ~BCDataSet() {};
+    virtual ~BCDataSet();
+
+    /**
+     * Copy assignment, see the copy constructor. */
+    BCDataSet& operator=(const BCDataSet& other);
 
     /** @} */
     /** \name operators*/
@@ -58,13 +181,13 @@ public:
 
     /**
      * Raw and fast access. */
-    BCDataPoint& operator[](unsigned index)
-    {	return fDataVector[index]; }
+    Row operator[](unsigned index)
+    {	return Row(fColumnData, index); }
 
     /**
      * Raw and fast access. */
-    const BCDataPoint& operator[](unsigned index) const
-    {	return fDataVector[index]; }
+    ConstRow operator[](unsigned index) const
+    {	return ConstRow(fColumnData, index); }
 
     /** @} */
     /** \name Member functions (get) */
@@ -73,7 +196,7 @@ public:
     /**
      * @return The number of data points. */
     unsigned GetNDataPoints() const
-    { return fDataVector.size(); }
+    { return fNDataPoints; }
 
     /**
      * @return number of values per data point (dimension of data). */
@@ -84,24 +207,67 @@ public:
      * Safer, but slower, access to data points
      * @param index The index of the data point to be returned.
      * @return The data point at the index. */
-    BCDataPoint& GetDataPoint(unsigned index)
-    { return fDataVector.at(index); }
+    Row GetDataPoint(unsigned index)
+    { return Row(fColumnData, CheckIndex(index)); }
 
     /**
      * Safer, but slower, access to data points
      * @param index The index of the data point to be returned.
      * @return The data point at the index. */
-    const BCDataPoint& GetDataPoint(unsigned index) const
-    { return fDataVector.at(index); }
+    ConstRow GetDataPoint(unsigned index) const
+    { return ConstRow(fColumnData, CheckIndex(index)); }
 
     /**
      * Access to last added data point. */
-    BCDataPoint& Back()
-    { return fDataVector.back(); }
+    Row Back()
+    { return Row(fColumnData, fNDataPoints - 1); }
+
+    /**
+     * Viewing the data set as a table with one row per point,
+     * this method returns a specified column without copying.
+     * @param index The index of the component to be returned.
+     * @return Pointer to the (index)th component of GetNDataPoints()
+     * data points; valid until data points are added or the data set
+     * is reset. */
+    const double* GetColumn(unsigned index) const
+    { return fColumnData.at(index); }
+
+    /**
+     * @param index The index of the component
+     * @return The name of the component; empty if not set. */
+    const std::string& GetComponentName(unsigned index) const
+    { return fComponentNames.at(index); }
+
+    /**
+     * @return Whether the data points carry weights, see Compact(). */
+    bool HasWeights() const
+    { return !fWeights.empty(); }
+
+    /**
+     * @param index The index of the data point
+     * @return The weight of the data point; 1 if there are no weights. */
+    double GetWeight(unsigned index) const
+    { return fWeights.empty() ? 1 : fWeights.at(index); }
+
+    /**
+     * @return Pointer to the weights of all data points; NULL if there are no weights. */
+    const double* GetWeights() const
+    { return fWeights.empty() ? 0 : &fWeights[0]; }
+
+    /**
+     * @return The sum of the weights of all data points, i.e. the
+     * number of data points before Compact(). */
+    double GetTotalWeight() const;
+
+    /**
+     * @return Whether the values are mapped from a binary file. */
+    bool IsMapped() const
+    { return fMapping != 0; }
 
     /**
      * Viewing the data set as a table with one row per point,
-     * this method returns a specified column.
+     * this method returns a copy of a specified column.
+     * @see GetColumn() to avoid the copy.
      * @param index The index of the component to be returned.
      * @return The (index)th component of all data points */
     std::vector<double> GetDataComponents(unsigned index) const;
@@ -180,6 +346,13 @@ public:
     void Fix(unsigned i, bool b = true)
     { if (i < fFixed.size()) fFixed[i] = b; }
 
+    /**
+     * Set the name of a component, e.g. to be stored in a binary file.
+     * @param index The index of the component
+     * @param name The name */
+    void SetComponentName(unsigned index, const std::string& name)
+    { fComponentNames.at(index) = name; }
+
     /** @} */
 
     /** \name Member functions (miscellaneous methods) */
@@ -222,10 +395,48 @@ public:
      * @return Success of action. */
     bool ReadDataFromFileTxt(const std::string& filename, int nvariables);
 
+    /**
+     * Opens a binary file written by WriteDataToFileBinary(). Files
+     * from a machine with another byte order, and files whose counts
+     * don't fit the file size, are rejected before allocating. Where
+     * available, the file is mapped into memory instead of being read,
+     * so the values are loaded on demand and not copied. Values
+     * changed through row views stay private to this data set. Adding
+     * data points copies all values into memory.
+     * @param filename The name of the file.
+     * @return Success of action. */
+    bool ReadDataFromFileBinary(const std::string& filename);
+
+    /**
+     * Writes the data set into a binary file: a header with a magic
+     * word, a byte order mark, the number of components and data
+     * points, and the name and bounds of each component, followed by
+     * the values of each component in turn and the weights, if any.
+     * The values are stored in the byte order of this machine; the
+     * byte order mark lets other machines reject the file.
+     * @param filename The name of the file.
+     * @return Success of action. */
+    bool WriteDataToFileBinary(const std::string& filename) const;
+
     /**
      * Adds a data point to the data set.
-     * @param datapoint The data point to be added */
-    bool AddDataPoint(const BCDataPoint& datapoint);
+     * @param datapoint The data point to be added
+     * @param weight The weight of the data point */
+    bool AddDataPoint(const BCDataPoint& datapoint, double weight = 1);
+
+    /**
+     * Replace identical data points by one point whose weight is the
+     * sum of their weights. The first occurrence of each point is kept,
+     * in the original order. Likelihoods that are sums over data points
+     * can then sum the weighted terms of fewer points, which is exact.
+     * GetNDataPoints() returns the number of distinct points afterwards.
+     * @return The number of distinct data points. */
+    unsigned Compact();
+
+    /**
+     * Reserve memory in all columns.
+     * @param n The expected number of data points */
+    void Reserve(unsigned n);
 
     /**
      * Recalculate a data axis bound accounting for uncertainties
@@ -240,8 +451,7 @@ public:
 
     /**
      * Resets the content of the data set */
-    void Reset()
-    { fDataVector.clear(); SetNValuesPerPoint(0); }
+    void Reset();
 
     /**
      * Print summary to string handler
@@ -293,8 +503,47 @@ public:
 
 private:
     /**
-     * A vector containing the data points */
-    std::vector<BCDataPoint> fDataVector;
+     * Check that a data point exists.
+     * @param index The index of the data point
+     * @return The index
+     * @throw std::out_of_range */
+    unsigned CheckIndex(unsigned index) const;
+
+    /**
+     * Point fColumnData to the vectors in fColumns. */
+    void UpdateColumnData();
+
+    /**
+     * Copy mapped values into memory and remove the mapping. */
+    void Materialize();
+
+    /**
+     * Remove the mapping of a binary file. */
+    void Unmap();
+
+    /**
+     * The values of the data points, one vector per component,
+     * unless they are mapped from a file */
+    std::vector<std::vector<double> > fColumns;
+
+    /**
+     * Pointers to the values of each component, in fColumns or the mapped file */
+    std::vector<double*> fColumnData;
+
+    /** Start of the mapped binary file, if any. */
+    void* fMapping;
+
+    /** Size of the mapped binary file in bytes. */
+    size_t fMappingSize;
+
+    /** Names of the components. */
+    std::vector<std::string> fComponentNames;
+
+    /** Weights of the data points; empty if all weights are one. */
+    std::vector<double> fWeights;
+
+    /** number of data points. */
+    unsigned fNDataPoints;
 
     /** number of values per data point. */
     unsigned fNValuesPerPoint;
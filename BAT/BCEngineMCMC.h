@@ -39,6 +39,7 @@
 #include <algorithm>
 #include <limits>
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -89,6 +90,19 @@ public:
         kInitRandomPrior      =  3  ///< randomly distribute according to factorized priors
     };
 
+    /** An enumerator for the stages of the Markov chains that are timed.
+     * See BCEngineMCMC::SetProfiling. */
+    enum ProfileStage {
+        kProfileLogEval         = 0, ///< evaluating the posterior
+        kProfileProposal        = 1, ///< generating proposal points
+        kProfileStatistics      = 2, ///< updating the statistics of the chains
+        kProfileFillHistograms  = 3, ///< filling the marginalized histograms
+        kProfileFillTree        = 4, ///< writing the chains to the tree
+        kProfileRValue          = 5, ///< checking convergence of the chains in the pre-run
+        kProfileCholesky        = 6, ///< updating the multivariate proposal functions in the pre-run
+        kNProfileStages         = 7  ///< number of stages
+    };
+
     /** @} */
     /** \name Structs */
     /** @{ */
@@ -140,6 +154,30 @@ public:
         void Update(double prob, const std::vector<double>& par, const std::vector<double>& obs);
     };
 
+    /** A struct for counting the work done by the Markov chains in one
+     * phase and for timing it by stage. */
+    struct Profile {
+
+        /** Constructor. */
+        Profile();
+
+        unsigned long n_evaluations;    ///< number of evaluations of the posterior
+        unsigned long n_accepted;       ///< number of accepted proposals
+        unsigned long n_rejected;       ///< number of rejected proposals with finite posterior
+        unsigned long n_out_of_bounds;  ///< number of proposals outside the parameter ranges, not evaluated
+        unsigned long n_nonfinite;      ///< number of proposals with nan or infinite posterior
+        double time[kNProfileStages];   ///< wall-clock time in seconds spent in each stage; zero unless profiling
+
+        /** reset all members. */
+        void Reset();
+
+        /** @return total time of all stages in seconds. */
+        double GetTotalTime() const;
+
+        /** addition assignment operator. */
+        Profile& operator += (const Profile& rhs);
+    };
+
     /** @} */
     /** \name Constructors and destructor */
     /** @{ */
@@ -380,6 +418,16 @@ public:
     bool GetFlagPreRun() const
     { return fMCMCFlagPreRun; }
 
+    /**
+     * @return Whether the Markov chain of the main run is written to a ROOT file. */
+    bool GetWriteMarkovChainRun() const
+    { return fMCMCFlagWriteChainToFile; }
+
+    /**
+     * @return Whether the Markov chain of the pre-run is written to a ROOT file. */
+    bool GetWriteMarkovChainPreRun() const
+    { return fMCMCFlagWritePreRunToFile; }
+
     /**
      * Retrieve the tree containing the Markov chain. */
     TTree* GetMarkovChainTree() const
@@ -412,6 +460,32 @@ public:
     const std::vector<BCEngineMCMC::Statistics>& GetStatisticsVector() const
     { return fMCMCStatistics; }
 
+    /**
+     * @return Flag for whether the stages of the Markov chains are timed. */
+    bool GetProfiling() const
+    { return fMCMCFlagProfiling; }
+
+    /**
+     * Get counters and timers of a phase of the Markov chains, one
+     * entry per chain. The last entry holds the stages run for all
+     * chains at once: filling histograms and tree, R-value check and
+     * updates of the multivariate proposal functions.
+     * @param phase kPreRun or kMainRun. */
+    const std::vector<BCEngineMCMC::Profile>& GetProfileVector(BCEngineMCMC::Phase phase) const
+    { return (phase == kPreRun) ? fMCMCProfilePreRun : fMCMCProfileRun; }
+
+    /**
+     * Get counters and timers of a phase of the Markov chains, summed
+     * over all chains. Times of chains running in parallel add up, so
+     * the total may exceed the wall-clock time of the run.
+     * @param phase kPreRun or kMainRun. */
+    BCEngineMCMC::Profile GetProfile(BCEngineMCMC::Phase phase) const;
+
+    /**
+     * @param stage The stage.
+     * @return Name of the stage for printing. */
+    static std::string GetProfileStageName(BCEngineMCMC::ProfileStage stage);
+
     /**
      * @return Flag for whether to rescale histogram ranges to fit MCMC reach after pre-run. */
     bool GetRescaleHistogramRangesAfterPreRun() const
@@ -422,6 +496,11 @@ public:
     double GetHistogramRescalePadding() const
     { return fHistogramRescalePadding; }
 
+    /**
+     * @return Flag for whether 2D marginalized histograms are built on request. */
+    bool GetH2OnDemand() const
+    { return fH2OnDemand; }
+
     /**
      * @return vector indices for order of printing 1D histograms. */
     virtual std::vector<unsigned> GetH1DPrintOrder() const;
@@ -441,7 +520,10 @@ public:
      * @param index2 Y Index of histogram of which to check existence.
      * @return Whether the marginalized histogram exists. */
     bool MarginalizedHistogramExists(unsigned index1, unsigned index2) const
-    { return index1 < fH2Marginalized.size() and index2 < fH2Marginalized[index1].size() and fH2Marginalized[index1][index2]; }
+    {
+        return (index1 < fH2Marginalized.size() and index2 < fH2Marginalized[index1].size() and fH2Marginalized[index1][index2])
+               or fH2OnDemandPairs.count(std::make_pair(index1, index2)) > 0;
+    }
 
     /**
      * Obtain the individual marginalized distributions
@@ -933,6 +1015,29 @@ public:
     void SetHistogramRescalingPadding(double factor)
     { fHistogramRescalePadding = factor; }
 
+    /**
+     * Set flag for building 2D marginalized histograms on request
+     * instead of filling them during the run. The values of all
+     * variables appearing in requested pairs are stored at every
+     * iteration, and a pair's histogram is only booked and filled from
+     * them when first accessed. Memory then grows with the number of
+     * iterations times the number of variables instead of with the
+     * number of pairs times the number of bins squared. Takes effect
+     * the next time the histograms are created. */
+    void SetH2OnDemand(bool flag = true)
+    { fH2OnDemand = flag; }
+
+    /**
+     * Set flag for timing the stages of the Markov chains, see
+     * ProfileStage. The counters of evaluations and proposals are
+     * always kept. Reading the clock around every evaluation of the
+     * posterior costs some tens of nanoseconds, which matters only for
+     * very fast posteriors. Without effect if BAT was configured with
+     * --disable-profiling.
+     * @param flag Flag for timing (default: false). */
+    void SetProfiling(bool flag = true)
+    { fMCMCFlagProfiling = flag; }
+
     /**
      * Turn on/off writing of Markov chain to root file.
      * If setting true, you must first set filename with function with filename arguments.
@@ -1468,6 +1573,21 @@ private:
      * Ensure that there are as many storages as chains */
     void SyncThreadStorage();
 
+    /**
+     * @return Name of the 2D marginalized histogram of variable j vs. variable i. */
+    std::string GetH2Name(unsigned i, unsigned j) const;
+
+    /**
+     * Book the 2D marginalized histogram of variable j vs. variable i,
+     * or register it for building on request.
+     * @return Whether the histogram had not been booked before. */
+    bool BookH2(unsigned i, unsigned j);
+
+    /**
+     * Build the 2D marginalized histogram of variable j vs. variable i
+     * from the values stored for building on request. */
+    TH2* CreateH2OnDemand(unsigned i, unsigned j) const;
+
     typedef std::map<int, unsigned> ChainIndex_t;
     ChainIndex_t fChainIndex;
 
@@ -1499,6 +1619,10 @@ protected:
      * Print marginalization to log. */
     virtual void PrintMarginalizationSummary() const;
 
+    /**
+     * Print counters and timers of the Markov chains to log. */
+    virtual void PrintProfileSummary() const;
+
     /**
      * Update Paramater TTree with scales and efficiencies. */
     void UpdateParameterTree();
@@ -1739,8 +1863,9 @@ protected:
     std::vector<TH1*> fH1Marginalized;
 
     /**
-     * Vector of 2D marginalized distributions. */
-    std::vector<std::vector<TH2*> > fH2Marginalized;
+     * Vector of 2D marginalized distributions; mutable, since
+     * distributions built on request are stored on first access. */
+    mutable std::vector<std::vector<TH2*> > fH2Marginalized;
 
     /**
      * Vector of pairs of indices for which 2D histograms should be
@@ -1792,6 +1917,47 @@ protected:
      * factor for enlarging range of histograms when rescaling. */
     double fHistogramRescalePadding;
 
+    /**
+     * flag for building 2D marginalized histograms on request. */
+    bool fH2OnDemand;
+
+    /**
+     * Pairs of variable indices whose 2D marginalized histograms are built on request. */
+    std::set<std::pair<unsigned, unsigned> > fH2OnDemandPairs;
+
+    /**
+     * Histogram ranges of all variables at the time the histograms were created. */
+    std::vector<std::pair<double, double> > fH2OnDemandLimits;
+
+    /**
+     * Values of the variables in fH2OnDemandPairs from all chains and
+     * iterations, by variable index. */
+    std::map<unsigned, std::vector<double> > fH2OnDemandSamples;
+
+    /**
+     * flag for timing the stages of the Markov chains. */
+    bool fMCMCFlagProfiling;
+
+    /**
+     * Counters and timers of the pre-run, per chain, plus one entry for all chains. */
+    std::vector<BCEngineMCMC::Profile> fMCMCProfilePreRun;
+
+    /**
+     * Counters and timers of the main run, per chain, plus one entry for all chains. */
+    std::vector<BCEngineMCMC::Profile> fMCMCProfileRun;
+
+    /**
+     * @return Entry of the current phase's profile for a chain, or NULL outside of pre-run and main run.
+     * @param chain Chain index; fMCMCNChains for the entry of all chains. */
+    BCEngineMCMC::Profile* CurrentProfile(unsigned chain);
+
+    /**
+     * @return Time accumulator of a stage in the current phase's
+     * profile, or NULL if not profiling.
+     * @param chain Chain index; fMCMCNChains for the entry of all chains.
+     * @param stage The stage. */
+    double* ProfileTime(unsigned chain, BCEngineMCMC::ProfileStage stage);
+
 };
 
 // ---------------------------------------------------------
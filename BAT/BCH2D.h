@@ -95,10 +95,10 @@ public:
     /** @{ */
 
     /**
-     * Return the TH2 histogram
+     * Return the TH2 histogram; clears the cached table for smallest intervals.
      * @return The TH2 histogram. */
     TH2* GetHistogram()
-    { return (TH2*)fHistogram; }
+    { ClearSmallestIntervalCache(); return (TH2*)fHistogram; }
 
     /**
      * @return Band type. */
@@ -94,9 +94,11 @@ public:
     /** @{ */
 
     /**
+     * The histogram may be modified through the returned pointer, so
+     * the cached table for smallest intervals is cleared.
      * @return The histogram. */
     TH1* GetHistogram()
-    { return fHistogram; };
+    { ClearSmallestIntervalCache(); return fHistogram; };
 
     /**
      * @return Dimensions of BC Histogram. */
@@ -537,12 +539,20 @@ public:
      * @param sort order to sort in: -1 (default) decreasing; +1 increasing; 0 unsorted. */
     void GetNonzeroBinDensityMassVector(std::vector<std::pair<double, double> >& bin_dens_mass, int sort = -1);
 
+    /**
+     * Clear the cached table of bin densities and cumulative masses
+     * used for smallest intervals. The table is cleared automatically
+     * by SetHistogram, Smooth and GetHistogram; call this if a pointer
+     * from GetHistogram is kept and used to modify the histogram after
+     * intervals were computed. */
+    void ClearSmallestIntervalCache();
+
     /**
      * Get probability density levels bounding from below the
      * smallest-interval levels with probability mass near that provided
-     * in the argument. CAUTION: This function will sort all bins of the
-     * histogram; if the histogram has many bins, this can be an
-     * expensive calculation.
+     * in the argument. The bins are sorted only once per histogram
+     * state; the table of cumulative masses is cached and each mass is
+     * then found by a binary search.
      * @param probabilities Vector of probability masses to bound.
      * @param overcoverage Flag for providing values that overcover (if true), or undercover (if false).
      * @return Vector of pairs (probability density, probability mass lower-bounded by it). */
@@ -724,6 +734,22 @@ protected:
      * Storage for unused legend entries (for use with multicolumn legends). */
     std::vector<TLegendEntry*> fExtraLegendEntries;
 
+    /**
+     * Distinct densities of the nonzero bins in decreasing order, cached for smallest intervals. */
+    std::vector<double> fSmallestIntervalDensities;
+
+    /**
+     * Probability mass of all bins with density greater than or equal to fSmallestIntervalDensities[i]. */
+    std::vector<double> fSmallestIntervalMasses;
+
+    /**
+     * Length (1D), area (2D), or volume (3D) of all bins with density greater than or equal to fSmallestIntervalDensities[i]. */
+    std::vector<double> fSmallestIntervalSizes;
+
+    /**
+     * Fill the cached table of densities and cumulative masses and sizes, if empty. */
+    void FillSmallestIntervalCache();
+
 };
 
 // ---------------------------------------------------------
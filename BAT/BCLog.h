@@ -24,22 +24,47 @@
 
 /**
  * Macros to output a message to the log including the class and method name.
+ * The message is only formatted if it is written to screen or file.
  */
-#define BCLOG_INTERNAL_OUT(t, s) \
+#define BCLOG_INTERNAL_OUT(level, s) \
     do {\
-    BCLog:: t \
-      (std::string(__PRETTY_FUNCTION__) + ": " + s); \
+    if (BCLog::IsActive(BCLog:: level)) \
+      BCLog::Out(BCLog:: level, std::string(__PRETTY_FUNCTION__) + ": " + s); \
     } while (false)
 
-#define BCLOG_DEBUG(s)   BCLOG_INTERNAL_OUT(OutDebug, s)
+#define BCLOG_DEBUG(s)   BCLOG_INTERNAL_OUT(debug, s)
 
-#define BCLOG_DETAIL(s)  BCLOG_INTERNAL_OUT(OutDetail, s)
+#define BCLOG_DETAIL(s)  BCLOG_INTERNAL_OUT(detail, s)
 
-#define BCLOG_ERROR(s)   BCLOG_INTERNAL_OUT(OutError, s)
+#define BCLOG_ERROR(s)   BCLOG_INTERNAL_OUT(error, s)
 
-#define BCLOG_SUMMARY(s) BCLOG_INTERNAL_OUT(OutSummary, s)
+#define BCLOG_SUMMARY(s) BCLOG_INTERNAL_OUT(summary, s)
 
-#define BCLOG_WARNING(s) BCLOG_INTERNAL_OUT(OutWarning, s)
+#define BCLOG_WARNING(s) BCLOG_INTERNAL_OUT(warning, s)
+
+/**
+ * Macros for messages in code run very often, e.g. for every
+ * evaluation of the posterior. The statements producing the output
+ * are only executed if the log level is active, and at most \a limit
+ * times from each place in the code, counted over all threads; after
+ * the last one, a note is printed that further messages are suppressed.
+ * The counts start over after BCLog::ResetMessageLimits(), which is
+ * called at the start of every Markov chain run.
+ * BCLOG_LIMITED executes arbitrary statements, BCLOG_OUT_LIMITED writes one message.
+ */
+#define BCLOG_LIMITED(level, limit, statements) \
+    do {\
+    static unsigned bclog_counter = 0; \
+    static unsigned bclog_epoch = 0; \
+    if (BCLog::IsActive(BCLog:: level)) { \
+      const unsigned bclog_n = BCLog::CountMessage(bclog_counter, bclog_epoch); \
+      if (bclog_n <= (limit)) { statements; } \
+      if (bclog_n == (limit)) \
+        BCLog::Out(BCLog:: level, "(further messages of this kind are suppressed)"); \
+    } \
+    } while (false)
+
+#define BCLOG_OUT_LIMITED(level, limit, s) BCLOG_LIMITED(level, limit, BCLog::Out(BCLog:: level, s))
 
 // ---------------------------------------------------------
 
@@ -138,6 +163,25 @@ public:
     static void CloseLog()
     { fOutputStream.close(); }
 
+    /**
+     * @param loglevel loglevel of a message
+     * @return Whether a message of the level would be written to file or screen. */
+    static bool IsActive(BCLog::LogLevel loglevel)
+    { return loglevel >= fMinimumLogLevelScreen || (loglevel >= fMinimumLogLevelFile && IsOpen()); }
+
+    /**
+     * Increase a counter of messages, safe to call from several threads at once.
+     * Used by BCLOG_LIMITED. The counter stops at the largest unsigned value,
+     * and starts over if the limits were reset since it was last increased.
+     * @param counter The counter
+     * @param epoch The number of resets when the counter was last increased
+     * @return The value of the counter after increasing. */
+    static unsigned CountMessage(unsigned& counter, unsigned& epoch);
+
+    /**
+     * Let the messages limited by BCLOG_LIMITED be printed again from every place in the code. */
+    static void ResetMessageLimits();
+
     /**
      * Writes string to the file and screen log if the log level is equal or greater than the minimum
      * @param loglevelfile loglevel for the current message
@@ -202,6 +246,10 @@ private:
      * Specifies wheather there were output printouts already */
     static bool fFirstOutputDone;
 
+    /**
+     * Number of calls to ResetMessageLimits() */
+    static unsigned fMessageEpoch;
+
 };
 
 // ---------------------------------------------------------
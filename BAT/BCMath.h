@@ -109,6 +109,90 @@ double LogLogNormal(double x, double mean = 0, double sigma = 1);
 
 /** @} */
 
+/** \name Functions for log likelihoods of many points
+ * Array versions of the functions above, evaluating element i of
+ * each argument array into element i of the result, and versions
+ * returning the sum over all elements. They return the same values
+ * as the functions for single points up to the accuracy of BCMath::Log,
+ * which replaces the logarithm of the standard library; arguments out
+ * of the usual range are passed on to the functions for single points.
+ * The loops are written so that the compiler can vectorize them. The
+ * result arrays must not overlap the argument arrays, except in Log. */
+/** @{ */
+
+/**
+ * Natural logarithm of many values. For positive normal numbers, the
+ * logarithm is computed by a branch-free kernel that the compiler can
+ * vectorize; the error is at most one unit in the last place. Zero,
+ * negative, subnormal, infinite and NaN values are evaluated by log().
+ * @param n number of values
+ * @param x values
+ * @param result filled with the logarithms; may be the same as x. */
+void Log(unsigned n, const double* x, double* result);
+
+/**
+ * @see LogGaus(double, double, double, bool)
+ * @param n number of points
+ * @param result filled with the log densities */
+void LogGaus(unsigned n, const double* x, const double* mean, const double* sigma, double* result, bool norm = false);
+
+/**
+ * @see LogSplitGaus(double, double, double, double, bool)
+ * @param n number of points
+ * @param result filled with the log densities */
+void LogSplitGaus(unsigned n, const double* x, const double* mode, const double* sigma_below, const double* sigma_above, double* result, bool norm = false);
+
+/**
+ * @see LogPoisson(double, double)
+ * @param n number of points
+ * @param result filled with the log probabilities */
+void LogPoisson(unsigned n, const double* x, const double* lambda, double* result);
+
+/**
+ * @see LogApproxBinomial(unsigned, unsigned, double)
+ * @param n number of points
+ * @param trials numbers of trials
+ * @param result filled with the log probabilities */
+void LogApproxBinomial(unsigned n, const unsigned* trials, const unsigned* k, const double* p, double* result);
+
+/**
+ * @see LogLogNormal(double, double, double)
+ * @param n number of points
+ * @param result filled with the log densities */
+void LogLogNormal(unsigned n, const double* x, const double* mean, const double* sigma, double* result);
+
+/**
+ * @see LogGammaPDF(double, double, double)
+ * @param n number of points
+ * @param result filled with the log densities */
+void LogGammaPDF(unsigned n, const double* x, const double* alpha, const double* beta, double* result);
+
+/**
+ * @return The sum of LogGaus over n points. */
+double SumLogGaus(unsigned n, const double* x, const double* mean, const double* sigma, bool norm = false);
+
+/**
+ * @return The sum of LogSplitGaus over n points. */
+double SumLogSplitGaus(unsigned n, const double* x, const double* mode, const double* sigma_below, const double* sigma_above, bool norm = false);
+
+/**
+ * @return The sum of LogPoisson over n points. */
+double SumLogPoisson(unsigned n, const double* x, const double* lambda);
+
+/**
+ * @return The sum of LogApproxBinomial over n points. */
+double SumLogApproxBinomial(unsigned n, const unsigned* trials, const unsigned* k, const double* p);
+
+/**
+ * @return The sum of LogLogNormal over n points. */
+double SumLogLogNormal(unsigned n, const double* x, const double* mean, const double* sigma);
+
+/**
+ * @return The sum of LogGammaPDF over n points. */
+double SumLogGammaPDF(unsigned n, const double* x, const double* alpha, const double* beta);
+
+/** @} */
+
 /**
  * Calculates Binomial probability using approximations for
  * factorial calculations if calculation for number greater than 20
@@ -141,10 +225,17 @@ double ApproxLogFact(double x);
 double LogBinomFactorExact(unsigned n, unsigned k);
 
 /**
- * Calculates natural logarithm of the n-factorial (n!) */
+ * Calculates natural logarithm of the n-factorial (n!), from the
+ * table of cached values or else from the log of the Gamma function.
+ * Safe to call from several threads at once. */
 double LogFact(unsigned n);
 
-/** Cache factorials for first \arg \c n integers. */
+/**
+ * Cache factorials for first \arg \c n integers. By default, the
+ * first 900 are cached. The table is replaced by a larger copy,
+ * never modified, so readers in other threads are not disturbed;
+ * still, call it once at startup rather than from parallel code.
+ * @return The number of cached factorials. */
 unsigned CacheFactorials(unsigned int n);
 
 /**
@@ -168,14 +259,42 @@ double CorrectPValue(const double& pvalue, const unsigned& npar, const unsigned&
  * Calculate the p value using fast MCMC for a histogram and the likelihood as test statistic.
  * The method is explained in the appendix of http://arxiv.org/abs/1011.1674
  *
+ * The pseudo data sets are shared among independent Markov chains
+ * (walkers), each with its own random number generator. The walkers run
+ * in parallel if thread parallelization is enabled. The result only
+ * depends on the seed and the number of walkers, not on the scheduling.
+ * By default, one walker without burn-in reproduces the original serial algorithm.
+ *
  * @param observed The counts of observed events
  * @param expected The expected number of events (Poisson means)
  * @param nIterations Controls number of pseudo data sets
  * @param seed Set to nonzero value for reproducible results.
+ * @param nWalkers Number of independent Markov chains; 0 for one per thread,
+ *                 then the result depends on the number of threads.
+ * @param nBurnIn Number of pseudo data sets discarded at the start of each walker;
+ *                if negative, none for a single walker and 100 for several, which
+ *                all start from the mode.
+ * @param precision Stop early when the binomial uncertainty of the p value falls below;
+ *                  checked every 1000 iterations per walker. The uncertainty is
+ *                  underestimated by the autocorrelation of the chains. Disabled if non-positive.
  * @return The p value
  */
 double FastPValue(const std::vector<unsigned>& observed, const std::vector<double>& expected,
-                  unsigned nIterations = 1e5, unsigned seed = 0) throw (std::invalid_argument);
+                  unsigned nIterations = 1e5, unsigned seed = 0, unsigned nWalkers = 1,
+                  int nBurnIn = -1, double precision = -1) throw (std::invalid_argument);
+
+/** @} */
+
+/** \name Numerical integration */
+/** @{ */
+
+/**
+ * Compute nodes and weights of the n-point Gauss-Legendre quadrature
+ * rule on [-1, 1]. The rule integrates polynomials up to degree 2n-1 exactly.
+ * @param n Number of nodes (order of the rule).
+ * @param nodes Filled with the n nodes in ascending order.
+ * @param weights Filled with the n corresponding weights. */
+void GaussLegendre(unsigned n, std::vector<double>& nodes, std::vector<double>& weights);
 
 /** @} */
 
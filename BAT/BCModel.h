@@ -41,6 +41,46 @@ class BCModel : public BCIntegrate
 
 public:
 
+    /**
+     * \brief Log density of a single data point, for SumLogDensities()
+     * \detail Derive from this class and implement operator() to
+     * return the log density of a data point for the parameter values
+     * stored in the derived object. It is called from several threads
+     * at once, so it must not modify any state. */
+    class PointLogDensity
+    {
+    public:
+        virtual ~PointLogDensity()
+        {}
+
+        /**
+         * @param point The data point
+         * @return The log density of the data point */
+        virtual double operator()(const BCDataSet::ConstRow& point) const = 0;
+    };
+
+    /**
+     * \brief Log densities of a block of data points, for SumLogDensities()
+     * \detail Derive from this class if the points are not stored in
+     * the data set of the model, or if evaluating them needs a copy
+     * of some state per thread, e.g. of a function. It is called from
+     * several threads at once for different blocks. */
+    class BlockLogDensity
+    {
+    public:
+        virtual ~BlockLogDensity()
+        {}
+
+        /**
+         * @param begin Index of the first point of the block
+         * @param end Index after the last point; at most GetLogDensityBlockSize() points per block
+         * @param slot Index of the calling thread if the blocks are
+         * evaluated in parallel, else the current chain; smaller than
+         * the number of slots passed to SumLogDensities().
+         * @param logdensity Filled with the log densities of points begin, ..., end-1 */
+        virtual void operator()(unsigned begin, unsigned end, unsigned slot, double* logdensity) const = 0;
+    };
+
     /** \name Constructors and destructors */
     /** @{ */
 
@@ -195,6 +235,35 @@ public:
      * @return Natural logarithm of the likelihood */
     virtual double LogLikelihood(const std::vector<double>& params) = 0;
 
+    /**
+     * Sum the log densities of all points of the data set, e.g. for
+     * implementing LogLikelihood(). Points with weights, see
+     * BCDataSet::Compact(), contribute their weight times the log
+     * density. The points are split into blocks of fixed size that
+     * are evaluated in parallel if thread parallelization is enabled
+     * and no chains are running in parallel already. Each block and
+     * the block sums are added with compensated summation in a fixed
+     * order, so the result doesn't depend on the number of threads.
+     * @param f The log density of a data point
+     * @return The sum of the log densities; 0 without data set. */
+    double SumLogDensities(const PointLogDensity& f) const;
+
+    /**
+     * Sum the log densities of n points evaluated block by block. The
+     * blocks are evaluated and summed as in SumLogDensities(const PointLogDensity&).
+     * @param n The number of points
+     * @param f The log densities of a block of points
+     * @param nslots The number of threads or chains f can serve at
+     * once; the blocks are evaluated in parallel only if there are at
+     * least as many slots as threads.
+     * @param weights The weights of the points; 0 if all weights are one.
+     * @return The sum of the log densities. */
+    double SumLogDensities(unsigned n, const BlockLogDensity& f, unsigned nslots, const double* weights = 0) const;
+
+    /**
+     * @return The maximum number of points per block in SumLogDensities(). */
+    static unsigned GetLogDensityBlockSize();
+
     /**
      * Returns the likelihood times prior probability given a set of parameter values
      * @param params A set of parameter values
@@ -12,6 +12,14 @@
  * common data sets and performs operations on BCModels
  * simultaneously. Model comparsion in terms of a posteriori
  * probabilities is only possible with this class.
+ *
+ * Integrate(), FindMode() and MarginalizeAll() can run several models
+ * at once, see SetNConcurrentModels(). The threads are shared among
+ * the models, which run their chains in parallel with the remaining
+ * threads. The models must not share objects other than the data set.
+ * Models using Minuit, which keeps global state, for finding the mode
+ * or for the Laplace approximation take turns, as do models finding the
+ * mode by simulated annealing.
  */
 
 /*
@@ -27,6 +35,7 @@
 #include "BCDataSet.h"
 #include "BCModel.h"
 
+#include <algorithm>
 #include <string>
 
 // ---------------------------------------------------------
@@ -85,6 +94,11 @@ public:
     BCDataSet* GetDataSet()
     { return fDataSet; };
 
+    /**
+     * @return The maximum number of models run at the same time. */
+    unsigned GetNConcurrentModels() const
+    { return fNConcurrentModels; }
+
     /** @} */
 
     /** \name Member functions (set) */
@@ -146,6 +160,17 @@ public:
      * Sets the number of Markov chains */
     void SetNChains(unsigned int n);
 
+    /**
+     * Set the maximum number of models integrated, optimized or
+     * marginalized at the same time; the default 1 runs one model
+     * after the other. Only has an effect with thread parallelization.
+     * Histograms are not attached to the current ROOT directory
+     * while models run concurrently. Before ROOT 6, models writing
+     * Markov chains to files run afterwards, one at a time.
+     * @param n The number of models */
+    void SetNConcurrentModels(unsigned n)
+    { fNConcurrentModels = std::max(1u, n); }
+
     /** @} */
 
     /** \name Member functions (miscellaneous methods) */
@@ -234,6 +259,15 @@ private:
      * The data set common to all models. */
     BCDataSet* fDataSet;
 
+    /**
+     * Maximum number of models run at the same time. */
+    unsigned fNConcurrentModels;
+
+    /**
+     * Apply a task to all models, several at once if requested.
+     * @param task The task, e.g. integrating the model */
+    void RunModels(void (*task)(BCModel&));
+
 };
 
 // ---------------------------------------------------------
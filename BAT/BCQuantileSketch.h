@@ -0,0 +1,143 @@
+#ifndef __BCQUANTILESKETCH__H
+#define __BCQUANTILESKETCH__H
+
+/*!
+ * \class BCQuantileSketch
+ * \brief A compact streaming estimator of arbitrary quantiles.
+ * \detail This class implements the merging t-digest of T. Dunning
+ * and O. Ertl (arXiv:1902.04023). Values are collected in a buffer
+ * and periodically merged into a sorted list of weighted centroids.
+ * The size of the centroids is limited by a scale function such that
+ * the tails are resolved much better than the bulk. The memory is
+ * bounded by a few times the compression parameter, independent of
+ * the number of values added, and sketches can be merged.
+ */
+
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------
+
+class BCQuantileSketch
+{
+public:
+
+    /** \name Constructors and destructor */
+    /** @{ */
+
+    /**
+     * A constructor.
+     * @param compression Controls the accuracy and the memory usage; the
+     * number of centroids is at most about the compression. */
+    BCQuantileSketch(double compression = 100);
+
+    /** @} */
+
+    /** \name Member functions (get) */
+    /** @{ */
+
+    /**
+     * Estimate a quantile. The extreme quantiles 0 and 1 are
+     * the exact minimum and maximum of the values added.
+     * @note Not safe to call concurrently, as pending values are merged first.
+     * @param p Probability in [0, 1].
+     * @return The quantile; NaN if the sketch is empty. */
+    double GetQuantile(double p) const;
+
+    /**
+     * Estimate the smallest interval containing a given probability
+     * mass. The lower bound is scanned over a grid of probabilities,
+     * so the result is exact for unimodal distributions up to the
+     * resolution of the grid.
+     * @param mass The probability mass in [0, 1].
+     * @param nsteps Number of grid points for the lower bound.
+     * @return The lower and upper bounds of the interval. */
+    std::pair<double, double> GetSmallestInterval(double mass, unsigned nsteps = 100) const;
+
+    /**
+     * @return The total weight of all values added. */
+    double GetTotalWeight() const
+    { return fTotalWeight; }
+
+    /**
+     * @return The smallest value added. */
+    double GetMinimum() const
+    { return fMinimum; }
+
+    /**
+     * @return The largest value added. */
+    double GetMaximum() const
+    { return fMaximum; }
+
+    /**
+     * @return The number of centroids after merging pending values. */
+    unsigned GetNCentroids() const;
+
+    /**
+     * @return The compression parameter. */
+    double GetCompression() const
+    { return fCompression; }
+
+    /** @} */
+
+    /** \name Member functions (miscellaneous methods) */
+    /** @{ */
+
+    /**
+     * Add a value. Values are buffered and merged into the
+     * centroids whenever the buffer holds as many values as the
+     * compression parameter.
+     * @param x The value.
+     * @param w The weight of the value. */
+    void Add(double x, double w = 1);
+
+    /**
+     * Add all values of another sketch.
+     * @param other The sketch to merge into this one. */
+    void Merge(const BCQuantileSketch& other);
+
+    /**
+     * Remove all values. The memory is kept for reuse. */
+    void Reset();
+
+    /** @} */
+
+private:
+
+    /**
+     * Merge the pending values into the centroids. */
+    void Compress() const;
+
+    /** Compression parameter. */
+    double fCompression;
+
+    /** Means and weights of the centroids, sorted by mean. */
+    mutable std::vector<std::pair<double, double> > fCentroids;
+
+    /** Values not yet merged into the centroids. */
+    mutable std::vector<std::pair<double, double> > fBuffer;
+
+    /** Total weight including pending values. */
+    double fTotalWeight;
+
+    /** Smallest value added. */
+    double fMinimum;
+
+    /** Largest value added. */
+    double fMaximum;
+
+};
+
+// ---------------------------------------------------------
+
+#endif
@@ -0,0 +1,590 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// Time the inner kernels of BAT in isolation: proposal points, chain
+// statistics, histogram and tree filling, priors, the log densities of
+// BCMath, the likelihood of BCMTF and slices.
+//
+// Every kernel is called in a loop of fixed length after a warm-up;
+// the loop is repeated and the fastest and the median repetition are
+// reported in nanoseconds per call. The random seeds are fixed, so two
+// builds do the same work. The results are written as comma-separated
+// values, one line per kernel, variant and size, for comparison
+// between builds:
+//
+//     ./runKernelBenchmark -o before.csv
+//     ./runKernelBenchmark -o after.csv
+//
+// Options:
+//   -o file   output file (default: kernel_benchmark.csv)
+//   -s scale  scale the number of calls (default: 1)
+//   -k name   run only kernels whose name contains name
+//   -c n      number of channels of the BCMTF model
+//   -p n      number of processes of the BCMTF model
+//   -b n      number of bins of the BCMTF model
+
+#include <BAT/BCCauchyPrior.h>
+#include <BAT/BCConstantPrior.h>
+#include <BAT/BCGaussianPrior.h>
+#include <BAT/BCLog.h>
+#include <BAT/BCMath.h>
+#include <BAT/BCMTF.h>
+#include <BAT/BCModel.h>
+#include <BAT/BCParameter.h>
+#include <BAT/BCSplitGaussianPrior.h>
+#include <BAT/BCTF1Prior.h>
+
+#include <TH1.h>
+#include <TH1D.h>
+#include <TRandom3.h>
+#include <TStopwatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// ---------------------------------------------------------
+// timing
+
+/** Settings from the command line. */
+struct Options {
+    Options()
+        : output("kernel_benchmark.csv"),
+          scale(1),
+          filter(""),
+          mtf_channels(0),
+          mtf_processes(0),
+          mtf_bins(0)
+    {}
+    std::string output;
+    double scale;
+    std::string filter;
+    unsigned mtf_channels;
+    unsigned mtf_processes;
+    unsigned mtf_bins;
+};
+
+Options options;
+FILE* output = 0;
+
+/**
+ * Time a kernel, a class with a method double Call() doing one unit of
+ * work. The sum of the return values is reported to check that two
+ * builds compute the same, and keeps the compiler from dropping calls.
+ * @param kernel Name of the kernel
+ * @param variant Variant of the kernel, e.g. the prior type
+ * @param size Size of the problem, e.g. the number of parameters
+ * @param ncalls Number of calls per repetition, before scaling
+ * @param nrepeat Number of repetitions */
+template <class Kernel>
+void Time(const std::string& kernel, const std::string& variant, unsigned size, Kernel& k, unsigned ncalls, unsigned nrepeat = 5)
+{
+    if (kernel.find(options.filter) == std::string::npos)
+        return;
+
+    ncalls = std::max(1u, unsigned(ncalls * options.scale));
+
+    // warm up caches and branch predictors
+    double checksum = 0;
+    for (unsigned i = 0; i < std::max(1u, ncalls / 10); ++i)
+        checksum += k.Call();
+
+    std::vector<double> ns(nrepeat);
+    checksum = 0;
+    for (unsigned r = 0; r < nrepeat; ++r) {
+        TStopwatch sw;
+        sw.Start();
+        for (unsigned i = 0; i < ncalls; ++i)
+            checksum += k.Call();
+        sw.Stop();
+        ns[r] = 1e9 * sw.RealTime() / ncalls;
+    }
+    std::sort(ns.begin(), ns.end());
+    checksum /= nrepeat;
+
+    printf("%-28s %-20s %6u : %12.1f ns/call (median %12.1f)\n", kernel.data(), variant.data(), size, ns.front(), ns[nrepeat / 2]);
+    fprintf(output, "%s,%s,%u,%u,%u,%.6g,%.6g,%.10g\n", kernel.data(), variant.data(), size, ncalls, nrepeat, ns.front(), ns[nrepeat / 2], checksum);
+    fflush(output);
+}
+
+// ---------------------------------------------------------
+// models
+
+/**
+ * Model with independent Gaussian parameters, giving access to the
+ * protected kernels of BCEngineMCMC. */
+class KernelModel : public BCModel
+{
+public:
+    KernelModel(unsigned npar, bool histograms)
+        : BCModel(Form("kernel_%u", npar))
+    {
+        for (unsigned i = 0; i < npar; ++i)
+            AddParameter(Form("x%u", i), -5, 5);
+        GetParameters().SetPriorConstantAll();
+        GetParameters().FillHistograms(histograms);
+        SetNChains(4);
+        SetRandomSeed(1234);
+    }
+
+    double LogLikelihood(const std::vector<double>& x)
+    {
+        double logl = 0;
+        for (unsigned i = 0; i < x.size(); ++i)
+            logl -= 0.5 * x[i] * x[i];
+        return logl;
+    }
+
+    // kernels and setup
+    using BCEngineMCMC::GetProposalPointMetropolis;
+    using BCEngineMCMC::InChainFillHistograms;
+    using BCEngineMCMC::InChainFillTree;
+    using BCEngineMCMC::InitializeMarkovChainTree;
+    using BCEngineMCMC::MCMCInitialize;
+
+    /** Move the chains to new points, so filling does not repeat the same bin. */
+    void Move(TRandom& rng)
+    {
+        for (unsigned c = 0; c < fMCMCx.size(); ++c)
+            for (unsigned i = 0; i < fMCMCx[c].size(); ++i)
+                fMCMCx[c][i] = rng.Gaus();
+    }
+};
+
+// ---------------------------------------------------------
+// kernels
+
+class ProposalKernel
+{
+public:
+    ProposalKernel(KernelModel& m, bool multivariate)
+        : fModel(m), fMultivariate(multivariate), fX(m.GetNParameters(), 0), fParameter(0)
+    {}
+    double Call()
+    {
+        if (fMultivariate)
+            return fModel.GetProposalPointMetropolis(0, fX);
+        fParameter = (fParameter + 1) % fX.size();
+        return fModel.GetProposalPointMetropolis(0, fParameter, fX);
+    }
+private:
+    KernelModel& fModel;
+    bool fMultivariate;
+    std::vector<double> fX;
+    unsigned fParameter;
+};
+
+class StatisticsUpdateKernel
+{
+public:
+    StatisticsUpdateKernel(unsigned npar)
+        : fStatistics(npar, 0), fPoints(64, std::vector<double>(npar)), fIndex(0)
+    {
+        TRandom3 rng(1234);
+        for (unsigned i = 0; i < fPoints.size(); ++i)
+            for (unsigned j = 0; j < npar; ++j)
+                fPoints[i][j] = rng.Gaus();
+    }
+    double Call()
+    {
+        fIndex = (fIndex + 1) % fPoints.size();
+        fStatistics.Update(-0.5 * fIndex, fPoints[fIndex], fObservables);
+        return fStatistics.mean.front();
+    }
+private:
+    BCEngineMCMC::Statistics fStatistics;
+    std::vector<std::vector<double> > fPoints;
+    std::vector<double> fObservables;
+    unsigned fIndex;
+};
+
+class StatisticsSumKernel
+{
+public:
+    StatisticsSumKernel(unsigned npar)
+        : fA(npar, 0), fB(npar, 0)
+    {
+        TRandom3 rng(1234);
+        std::vector<double> x(npar), obs;
+        for (unsigned i = 0; i < 100; ++i) {
+            for (unsigned j = 0; j < npar; ++j)
+                x[j] = rng.Gaus();
+            fB.Update(-0.5 * i, x, obs);
+        }
+    }
+    double Call()
+    {
+        fA = fB;
+        fA += fB;
+        return fA.mean.front();
+    }
+private:
+    BCEngineMCMC::Statistics fA;
+    BCEngineMCMC::Statistics fB;
+};
+
+class FillKernel
+{
+public:
+    FillKernel(KernelModel& m, bool tree)
+        : fModel(m), fTree(tree), fRandom(1234)
+    {}
+    double Call()
+    {
+        fModel.Move(fRandom);
+        if (fTree)
+            fModel.InChainFillTree();
+        else
+            fModel.InChainFillHistograms();
+        return 0;
+    }
+private:
+    KernelModel& fModel;
+    bool fTree;
+    TRandom3 fRandom;
+};
+
+class LogPriorKernel
+{
+public:
+    LogPriorKernel(const BCParameterSet& parameters)
+        : fParameters(parameters), fPoints(64, std::vector<double>(parameters.Size())), fIndex(0)
+    {
+        TRandom3 rng(1234);
+        for (unsigned i = 0; i < fPoints.size(); ++i)
+            for (unsigned j = 0; j < fPoints[i].size(); ++j)
+                fPoints[i][j] = rng.Uniform(-4.9, 4.9);
+    }
+    double Call()
+    {
+        fIndex = (fIndex + 1) % fPoints.size();
+        return fParameters.GetLogPrior(fPoints[fIndex]);
+    }
+private:
+    const BCParameterSet& fParameters;
+    std::vector<std::vector<double> > fPoints;
+    unsigned fIndex;
+};
+
+/** Arguments for the log densities of BCMath, in [0.5, 50). */
+class MathKernel
+{
+public:
+    enum Function { kLogGaus, kLogPoisson, kLogFact, kLogApproxBinomial, kSumLogGaus, kSumLogPoisson };
+
+    MathKernel(Function f, unsigned n)
+        : fFunction(f), fX(n), fMean(n), fSigma(n), fIndex(0)
+    {
+        TRandom3 rng(1234);
+        for (unsigned i = 0; i < n; ++i) {
+            fX[i] = floor(rng.Uniform(0.5, 50));
+            fMean[i] = rng.Uniform(0.5, 50);
+            fSigma[i] = rng.Uniform(0.5, 5);
+        }
+    }
+    double Call()
+    {
+        fIndex = (fIndex + 1) % fX.size();
+        const unsigned i = fIndex;
+        switch (fFunction) {
+            case kLogGaus:
+                return BCMath::LogGaus(fX[i], fMean[i], fSigma[i], true);
+            case kLogPoisson:
+                return BCMath::LogPoisson(fX[i], fMean[i]);
+            case kLogFact:
+                return BCMath::LogFact(unsigned(fX[i]) * 20);
+            case kLogApproxBinomial:
+                return BCMath::LogApproxBinomial(100, unsigned(fX[i]), 0.01 * fMean[i]);
+            case kSumLogGaus:
+                return BCMath::SumLogGaus(fX.size(), &fX[0], &fMean[0], &fSigma[0], true);
+            case kSumLogPoisson:
+                return BCMath::SumLogPoisson(fX.size(), &fX[0], &fMean[0]);
+        }
+        return 0;
+    }
+private:
+    Function fFunction;
+    std::vector<double> fX;
+    std::vector<double> fMean;
+    std::vector<double> fSigma;
+    unsigned fIndex;
+};
+
+class MTFKernel
+{
+public:
+    MTFKernel(unsigned nchannels, unsigned nprocesses, unsigned nbins)
+        : fModel("kernel_mtf"), fIndex(0)
+    {
+        TRandom3 rng(1234);
+        for (unsigned p = 0; p < nprocesses; ++p)
+            fModel.AddProcess(Form("process_%u", p), 0, 2000);
+        for (unsigned c = 0; c < nchannels; ++c) {
+            std::string channel = Form("channel_%u", c);
+            fModel.AddChannel(channel);
+            TH1D data(Form("data_%u", c), "", nbins, 0, 1);
+            data.SetDirectory(0);
+            for (unsigned p = 0; p < nprocesses; ++p) {
+                // falling background or peaks at different positions
+                TH1D h(Form("template_%u_%u", c, p), "", nbins, 0, 1);
+                h.SetDirectory(0);
+                const double mean = (p + 0.5) / nprocesses;
+                for (unsigned b = 1; b <= nbins; ++b) {
+                    const double x = h.GetBinCenter(b);
+                    h.SetBinContent(b, p == 0 ? exp(-3 * x) : exp(-0.5 * (x - mean) * (x - mean) / 0.01));
+                }
+                h.Scale(1. / h.Integral());
+                fModel.SetTemplate(channel, Form("process_%u", p), h, 1);
+                data.Add(&h, 1000);
+            }
+            for (unsigned b = 1; b <= nbins; ++b)
+                data.SetBinContent(b, rng.Poisson(data.GetBinContent(b)));
+            fModel.SetData(channel, data);
+        }
+
+        fPoints.assign(64, std::vector<double>(fModel.GetNParameters()));
+        for (unsigned i = 0; i < fPoints.size(); ++i)
+            for (unsigned j = 0; j < fPoints[i].size(); ++j)
+                fPoints[i][j] = rng.Uniform(500, 1500);
+    }
+    double Call()
+    {
+        fIndex = (fIndex + 1) % fPoints.size();
+        return fModel.LogLikelihood(fPoints[fIndex]);
+    }
+private:
+    BCMTF fModel;
+    std::vector<std::vector<double> > fPoints;
+    unsigned fIndex;
+};
+
+class SliceKernel
+{
+public:
+    SliceKernel(KernelModel& m, unsigned dimension, unsigned nbins)
+        : fModel(m), fDimension(dimension), fNbins(nbins), fParameters(m.GetNParameters(), 0)
+    {}
+    double Call()
+    {
+        unsigned nIterations = 0;
+        double log_max_val;
+        TH1* h = (fDimension == 1) ?
+                 static_cast<TH1*>(fModel.GetSlice(0u, nIterations, log_max_val, fParameters, fNbins)) :
+                 static_cast<TH1*>(fModel.GetSlice(0u, 1u, nIterations, log_max_val, std::vector<double>(0), fNbins));
+        delete h;
+        return log_max_val;
+    }
+private:
+    KernelModel& fModel;
+    unsigned fDimension;
+    unsigned fNbins;
+    std::vector<double> fParameters;
+};
+
+// ---------------------------------------------------------
+// benchmarks
+
+void BenchmarkProposal()
+{
+    const unsigned npar[] = { 2, 10, 50, 100, 500 };
+    for (unsigned k = 0; k < sizeof(npar) / sizeof(npar[0]); ++k) {
+        KernelModel m(npar[k], false);
+        m.MCMCInitialize();
+        ProposalKernel univariate(m, false);
+        ProposalKernel multivariate(m, true);
+        Time("GetProposalPointMetropolis", "univariate", npar[k], univariate, 1000000);
+        Time("GetProposalPointMetropolis", "multivariate", npar[k], multivariate, 20000000 / (npar[k] * npar[k] + 100));
+    }
+}
+
+void BenchmarkStatistics()
+{
+    const unsigned npar[] = { 2, 10, 50, 100, 500 };
+    for (unsigned k = 0; k < sizeof(npar) / sizeof(npar[0]); ++k) {
+        StatisticsUpdateKernel update(npar[k]);
+        StatisticsSumKernel sum(npar[k]);
+        Time("Statistics::Update", "", npar[k], update, 20000000 / (npar[k] * npar[k] + 100));
+        Time("Statistics::operator+=", "", npar[k], sum, 10000000 / (npar[k] * npar[k] + 100));
+    }
+}
+
+void BenchmarkFill()
+{
+    // the number of 2D histograms grows quadratically
+    const unsigned npar[] = { 2, 5, 10, 20 };
+    for (unsigned k = 0; k < sizeof(npar) / sizeof(npar[0]); ++k) {
+        {
+            KernelModel m(npar[k], true);
+            m.MCMCInitialize();
+            FillKernel fill(m, false);
+            Time("InChainFillHistograms", "dense", npar[k], fill, 2000000 / (npar[k] * npar[k] + 10));
+        }
+        {
+            KernelModel m(npar[k], true);
+            m.SetH2OnDemand();
+            m.MCMCInitialize();
+            FillKernel fill(m, false);
+            Time("InChainFillHistograms", "on demand", npar[k], fill, 2000000 / (npar[k] * npar[k] + 10));
+        }
+        {
+            KernelModel m(npar[k], false);
+            m.WriteMarkovChain(options.output + ".root", "RECREATE");
+            m.MCMCInitialize();
+            m.InitializeMarkovChainTree(true, true);
+            FillKernel fill(m, true);
+            Time("InChainFillTree", "", npar[k], fill, 1000000 / (npar[k] + 10));
+            m.CloseOutputFile();
+        }
+    }
+    remove((options.output + ".root").data());
+}
+
+void BenchmarkLogPrior()
+{
+    const unsigned npar = 50;
+    const char* names[] = { "constant", "gaussian", "split gaussian", "cauchy", "tf1" };
+    for (unsigned k = 0; k < sizeof(names) / sizeof(names[0]); ++k) {
+        KernelModel m(npar, false);
+        for (unsigned i = 0; i < npar; ++i) {
+            BCParameter& p = m.GetParameter(i);
+            switch (k) {
+                case 0:
+                    p.SetPriorConstant();
+                    break;
+                case 1:
+                    p.SetPrior(new BCGaussianPrior(0, 1));
+                    break;
+                case 2:
+                    p.SetPrior(new BCSplitGaussianPrior(0, 1, 2));
+                    break;
+                case 3:
+                    p.SetPrior(new BCCauchyPrior(0, 1));
+                    break;
+                case 4:
+                    p.SetPrior(new BCTF1Prior("exp(-0.5*x*x)", -5, 5));
+                    break;
+            }
+        }
+        LogPriorKernel prior(m.GetParameters());
+        Time("BCParameterSet::GetLogPrior", names[k], npar, prior, 200000);
+    }
+}
+
+void BenchmarkMath()
+{
+    MathKernel gaus(MathKernel::kLogGaus, 1000);
+    MathKernel poisson(MathKernel::kLogPoisson, 1000);
+    MathKernel fact(MathKernel::kLogFact, 1000);
+    MathKernel binomial(MathKernel::kLogApproxBinomial, 1000);
+    Time("BCMath::LogGaus", "", 1, gaus, 10000000);
+    Time("BCMath::LogPoisson", "", 1, poisson, 10000000);
+    Time("BCMath::LogFact", "", 1, fact, 10000000);
+    Time("BCMath::LogApproxBinomial", "", 1, binomial, 10000000);
+
+    const unsigned n[] = { 10, 100, 1000, 10000 };
+    for (unsigned k = 0; k < sizeof(n) / sizeof(n[0]); ++k) {
+        MathKernel sumgaus(MathKernel::kSumLogGaus, n[k]);
+        MathKernel sumpoisson(MathKernel::kSumLogPoisson, n[k]);
+        Time("BCMath::SumLogGaus", "", n[k], sumgaus, 10000000 / n[k]);
+        Time("BCMath::SumLogPoisson", "", n[k], sumpoisson, 10000000 / n[k]);
+    }
+}
+
+void BenchmarkMTF()
+{
+    std::vector<unsigned> channels, processes, bins;
+    if (options.mtf_channels or options.mtf_processes or options.mtf_bins) {
+        channels.push_back(options.mtf_channels ? options.mtf_channels : 1);
+        processes.push_back(options.mtf_processes ? options.mtf_processes : 3);
+        bins.push_back(options.mtf_bins ? options.mtf_bins : 100);
+    } else {
+        const unsigned c[] = { 1, 4, 10 };
+        const unsigned p[] = { 3, 10, 20 };
+        const unsigned b[] = { 100, 100, 200 };
+        channels.assign(c, c + 3);
+        processes.assign(p, p + 3);
+        bins.assign(b, b + 3);
+    }
+
+    for (unsigned k = 0; k < channels.size(); ++k) {
+        MTFKernel mtf(channels[k], processes[k], bins[k]);
+        const unsigned size = channels[k] * processes[k] * bins[k];
+        Time("BCMTF::LogLikelihood", Form("%uc x %up x %ub", channels[k], processes[k], bins[k]), size, mtf, 100000000 / size);
+    }
+}
+
+void BenchmarkSlice()
+{
+    KernelModel m(2, false);
+    const unsigned nbins1[] = { 100, 1000 };
+    for (unsigned k = 0; k < 2; ++k) {
+        SliceKernel slice(m, 1, nbins1[k]);
+        Time("GetSlice", "1D", nbins1[k], slice, 1000000 / nbins1[k], 3);
+    }
+    const unsigned nbins2[] = { 30, 100 };
+    for (unsigned k = 0; k < 2; ++k) {
+        SliceKernel slice(m, 2, nbins2[k]);
+        Time("GetSlice", "2D", nbins2[k] * nbins2[k], slice, 1000000 / (nbins2[k] * nbins2[k]), 3);
+    }
+}
+
+}
+
+// ---------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-o") == 0)
+            options.output = argv[i + 1];
+        else if (strcmp(argv[i], "-s") == 0)
+            options.scale = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "-k") == 0)
+            options.filter = argv[i + 1];
+        else if (strcmp(argv[i], "-c") == 0)
+            options.mtf_channels = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-p") == 0)
+            options.mtf_processes = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-b") == 0)
+            options.mtf_bins = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    output = fopen(options.output.data(), "w");
+    if (!output) {
+        fprintf(stderr, "Could not open %s\n", options.output.data());
+        return 1;
+    }
+
+    BCLog::SetLogLevel(BCLog::warning);
+
+    fprintf(output, "# BAT %s, scale %g\n", BCLog::GetVersion().data(), options.scale);
+    fprintf(output, "kernel,variant,size,calls,repetitions,ns_min,ns_median,checksum\n");
+
+    BenchmarkProposal();
+    BenchmarkStatistics();
+    BenchmarkFill();
+    BenchmarkLogPrior();
+    BenchmarkMath();
+    BenchmarkMTF();
+    BenchmarkSlice();
+
+    fclose(output);
+    printf("Results written to %s\n", options.output.data());
+
+    return 0;
+}
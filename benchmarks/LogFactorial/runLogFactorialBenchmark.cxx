@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// Compare the immutable log-factorial table of BCMath with the former
+// implementation, which grew a shared vector and summed logs beyond
+// it. The former version is only timed serially; calling it from
+// several threads while the table grows is a data race.
+
+#include <BAT/BCMath.h>
+
+#include <TStopwatch.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+std::vector<double> FormerLogFactorials;
+
+unsigned FormerCacheFactorials(unsigned n)
+{
+    if (n < FormerLogFactorials.size())
+        return FormerLogFactorials.size();
+    FormerLogFactorials.reserve(n);
+    if (FormerLogFactorials.empty())
+        FormerLogFactorials.push_back(0);
+    for (unsigned i = FormerLogFactorials.size(); i <= n; ++i)
+        FormerLogFactorials.push_back(FormerLogFactorials.back() + log(static_cast<double>(i)));
+    return FormerLogFactorials.size();
+}
+
+double FormerLogFact(unsigned n)
+{
+    if (n < FormerLogFactorials.size())
+        return FormerLogFactorials[n];
+    double logfact = FormerLogFactorials.empty() ? 0 : FormerLogFactorials.back();
+    for (unsigned i = FormerLogFactorials.size(); i <= n; ++i)
+        logfact += log((double)i);
+    return logfact;
+}
+
+/**
+ * Time nrepeat sweeps over the arguments 0, ..., nmax-1.
+ * @return Nanoseconds per call */
+template <class Function>
+double Time(Function f, unsigned nmax, unsigned nrepeat, bool parallel, double& checksum)
+{
+    TStopwatch sw;
+    sw.Start();
+    double sum = 0;
+    for (unsigned r = 0; r < nrepeat; ++r) {
+        #pragma omp parallel for if(parallel) reduction(+:sum) schedule(static)
+        for (int i = 0; i < int(nmax); ++i)
+            sum += f(i);
+    }
+    sw.Stop();
+    checksum = sum;
+    return 1e9 * sw.RealTime() / (double(nmax) * nrepeat);
+}
+
+void Report(const char* name, unsigned nmax, int nthreads, double ns, double checksum)
+{
+    printf("%-22s nmax = %7u threads = %2d : %8.2f ns/call  (checksum %.10g)\n", name, nmax, nthreads, ns, checksum);
+}
+}
+
+int main(int argc, char* argv[])
+{
+    const unsigned ncalls = argc > 1 ? atoi(argv[1]) : 10000000;
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+
+    BCMath::CacheFactorials(899);
+    FormerCacheFactorials(899);
+
+    // within the table, just beyond it, and far beyond it
+    const unsigned nmax[] = { 900, 2000, 20000 };
+    for (unsigned k = 0; k < sizeof(nmax) / sizeof(nmax[0]); ++k) {
+        const unsigned n = nmax[k];
+        const unsigned nrepeat = std::max(1u, ncalls / n);
+        // the former version is quadratic beyond the table
+        const unsigned nrepeatformer = n > 900 ? std::max(1u, nrepeat / 100) : nrepeat;
+        double checksum;
+
+        double ns = Time(FormerLogFact, n, nrepeatformer, false, checksum);
+        Report("former LogFact", n, 1, ns, checksum / nrepeatformer);
+
+        ns = Time(BCMath::LogFact, n, nrepeat, false, checksum);
+        Report("BCMath::LogFact", n, 1, ns, checksum / nrepeat);
+
+        if (nthreads > 1) {
+            ns = Time(BCMath::LogFact, n, nrepeat, true, checksum);
+            Report("BCMath::LogFact", n, nthreads, ns, checksum / nrepeat);
+        }
+    }
+
+    return 0;
+}
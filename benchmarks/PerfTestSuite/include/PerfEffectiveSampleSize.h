@@ -0,0 +1,84 @@
+/*!
+ * \class BAT::PerfEffectiveSampleSize
+ * \brief Effective sample size of Markov chains from batch means
+ * \detail The samples of each chain are grouped into batches of
+ * sqrt(n) consecutive samples. The effective sample size of a parameter
+ * is the number of samples times the variance of the samples divided
+ * by the variance of the batch means times the batch size, pooled over
+ * all chains. Only correlations within a chain are taken into account,
+ * so chains stuck in different modes are not detected.
+ */
+
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+
+#ifndef BAT_PERFEFFECTIVESAMPLESIZE
+#define BAT_PERFEFFECTIVESAMPLESIZE
+
+#include <vector>
+
+class PerfEffectiveSampleSize
+{
+
+public:
+
+    /** \name Constructors and destructors  */
+    /* @{ */
+
+    /** The default constructor */
+    PerfEffectiveSampleSize();
+
+    /* @} */
+    /** \name Member functions (misc)  */
+    /* @{ */
+
+    /** Clear all sums and set up the batches.
+     * @param nchains the number of chains
+     * @param npar the number of parameters
+     * @param nsamples the expected number of samples per chain */
+    void Init(unsigned nchains, unsigned npar, unsigned nsamples);
+
+    /** Add one sample of each chain.
+     * @param x the points of all chains; ignored if the sizes don't match Init(). */
+    void Fill(const std::vector<std::vector<double> >& x);
+
+    /* @} */
+    /** \name Member functions (Get)  */
+    /* @{ */
+
+    /** @return the effective sample size of each parameter, summed over
+     * all chains; zero if there are fewer than two complete batches. */
+    std::vector<double> GetEffectiveSampleSize() const;
+
+    /** @return the approximate relative uncertainty of the effective
+     * sample size, from the number of batch means. */
+    double GetRelativeUncertainty() const;
+
+    /* @} */
+
+private:
+
+    /** The number of samples per batch. */
+    unsigned fBatchSize;
+
+    /** The number of samples filled per chain. */
+    unsigned fNSamples;
+
+    /** Sums of the samples and their squares, per chain and parameter. */
+    std::vector<std::vector<double> > fSum;
+    std::vector<std::vector<double> > fSum2;
+
+    /** Sums over the current batch, per chain and parameter. */
+    std::vector<std::vector<double> > fBatchSum;
+
+    /** Sums of the batch means and their squares, per chain and parameter. */
+    std::vector<std::vector<double> > fBatchMeanSum;
+    std::vector<std::vector<double> > fBatchMeanSum2;
+};
+
+#endif
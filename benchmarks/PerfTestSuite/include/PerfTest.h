@@ -31,7 +31,7 @@ public:
     /* @{ */
 
     /** An enumerator for the test categories. */
-    enum TestType { kUnknown, kFunction1D, kFunction2D, kVarPar };
+    enum TestType { kUnknown, kFunction1D, kFunction2D, kVarPar, kFunctionND, kMTF, kScaling };
 
     /** An enumerator for the test precision. */
     enum Precision { kCoarse, kMedium, kDetail };
@@ -61,6 +61,16 @@ public:
     void SetCpuTime(double time)
     { fCpuTime = time; };
 
+    /** Set the effective sample size of the MCMC.
+     * @param ess the effective sample size of each parameter
+     * @param uncertainty the relative uncertainty of the effective sample size */
+    void SetEffectiveSampleSize(const std::vector<double>& ess, double uncertainty)
+    { fEffectiveSampleSize = ess; fEffectiveSampleSizeUncertainty = uncertainty; };
+
+    /** Set the number of evaluations of the posterior in the main run of the MCMC. */
+    void SetNEvaluations(unsigned long n)
+    { fNEvaluations = n; };
+
     /** Set the variation parameter.
      * @param par the parameter value
      * @param name the name of the varied parameter.
@@ -147,6 +157,28 @@ public:
     double GetCpuTime()
     { return fCpuTime; };
 
+    /** Get the effective sample size of each parameter; empty if the
+     * test doesn't run an MCMC. */
+    const std::vector<double>& GetEffectiveSampleSize()
+    { return fEffectiveSampleSize; };
+
+    /** Get the relative uncertainty of the effective sample size. */
+    double GetEffectiveSampleSizeUncertainty()
+    { return fEffectiveSampleSizeUncertainty; };
+
+    /** Get the smallest effective sample size of all parameters. */
+    double GetMinEffectiveSampleSize();
+
+    /** Get the smallest effective sample size per second of real time. */
+    double GetEffectiveSamplesPerSecond();
+
+    /** Get the smallest effective sample size per evaluation of the posterior. */
+    double GetEffectiveSamplesPerEvaluation();
+
+    /** Get the number of evaluations of the posterior in the main run of the MCMC. */
+    unsigned long GetNEvaluations()
+    { return fNEvaluations; };
+
     /* @} */
     /** \name Member functions (misc)  */
     /* @{ */
@@ -245,6 +277,15 @@ private:
 
     /** CPU time test was running. */
     double fCpuTime;
+
+    /** Effective sample size of each parameter. */
+    std::vector<double> fEffectiveSampleSize;
+
+    /** Relative uncertainty of the effective sample size. */
+    double fEffectiveSampleSizeUncertainty;
+
+    /** Number of evaluations of the posterior in the main run. */
+    unsigned long fNEvaluations;
 };
 
 #endif
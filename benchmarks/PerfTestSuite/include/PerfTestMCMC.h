@@ -14,6 +14,7 @@
 #ifndef BAT_PERFTESTMCMC
 #define BAT_PERFTESTMCMC
 
+#include <include/PerfEffectiveSampleSize.h>
 #include <include/PerfTest.h>
 
 #include <BAT/BCModel.h>
@@ -80,6 +81,15 @@ public:
     // inherited methods
     void MCMCUserIterationInterface();
 
+protected:
+
+    /** Pass the effective sample size and the number of evaluations
+     * of the posterior of the last run to the test. */
+    void SetSamplerEfficiency();
+
+    /** The effective sample size of the main run. */
+    PerfEffectiveSampleSize fEffectiveSampleSizeEstimator;
+
 private:
 
     std::vector<TGraph*> fCorrelation;
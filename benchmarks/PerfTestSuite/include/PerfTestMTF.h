@@ -0,0 +1,86 @@
+/*!
+ * \class BAT::PerfTestMTF
+ * \brief A performance test class for BAT with a synthetic template fit
+ * \detail The BCMTF model has a falling background and narrow peaks
+ * at different positions as processes, shared by all channels. The data
+ * are the expected counts (Asimov data), so the posterior means of the
+ * process normalizations are close to the true values.
+ */
+
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+
+#ifndef BAT_PERFTESTMTF
+#define BAT_PERFTESTMTF
+
+#include <include/PerfEffectiveSampleSize.h>
+#include <include/PerfTest.h>
+
+#include <BAT/BCMTF.h>
+
+#include <string>
+#include <vector>
+
+class PerfTestMTF : public PerfTest, public BCMTF
+{
+
+public:
+
+    /** \name Constructors and destructors  */
+    /* @{ */
+
+    /** The default constructor
+     * @param name the name of the test
+     * @param nchannels the number of channels
+     * @param nprocesses the number of processes, including the background
+     * @param nbins the number of bins per channel */
+    PerfTestMTF(const std::string& name, unsigned nchannels, unsigned nprocesses, unsigned nbins);
+
+    /** The default destructor */
+    virtual ~PerfTestMTF();
+
+    /* @} */
+
+    virtual void SetProposal(bool multivariate, double dof)
+    {
+        SetProposeMultivariate(multivariate);
+        SetProposalFunctionDof(dof);
+    }
+
+    /** Run after the test
+     * @return an error code. */
+    int PostTest();
+
+    /** Run the test.
+     * @return an error code. */
+    int RunTest();
+
+    /** Defines the subtests. */
+    void DefineSubtests();
+
+    /** Writes the test to file.
+     * @return an error code. */
+    int WriteResults();
+
+    /** Define precision settings. */
+    void PrecisionSettings(PerfTest::Precision);
+
+    // inherited methods
+    void MCMCUserIterationInterface()
+    { fEffectiveSampleSizeEstimator.Fill(fMCMCx); }
+
+private:
+
+    /** The effective sample size of the main run. */
+    PerfEffectiveSampleSize fEffectiveSampleSizeEstimator;
+
+    /** The true normalizations of the processes. */
+    std::vector<double> fTrueNorm;
+};
+
+#endif
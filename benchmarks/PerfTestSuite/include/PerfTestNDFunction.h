@@ -0,0 +1,91 @@
+/*!
+ * \class BAT::PerfTestNDFunction
+ * \brief A performance test class for BAT with posteriors in many dimensions
+ * \detail The posterior is one of
+ * - a Gaussian with correlation rho between all pairs of parameters
+ *   and standard deviations growing from 1 to 2 with the parameter index,
+ * - a chain of Rosenbrock valleys, exp(-sum_i [(1-x_i)^2 + 100 (x_{i+1}-x_i^2)^2] / 20),
+ * - Neal's funnel: v ~ N(0, 3^2) and x_i | v ~ N(0, exp(v)).
+ * Since the posterior can be evaluated in O(N) operations, the test
+ * measures the overhead of the sampler in high dimensions.
+ */
+
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+
+#ifndef BAT_PERFTESTNDFUNCTION
+#define BAT_PERFTESTNDFUNCTION
+
+#include <include/PerfTestMCMC.h>
+
+#include <string>
+#include <vector>
+
+class PerfTestNDFunction : public PerfTestMCMC
+{
+
+public:
+
+    /** \name Enumerators  */
+    /* @{ */
+
+    /** An enumerator for the shape of the posterior. */
+    enum Shape { kGaussian, kRosenbrock, kFunnel };
+
+    /* @} */
+    /** \name Constructors and destructors  */
+    /* @{ */
+
+    /** The default constructor
+     * @param name the name of the test
+     * @param shape the shape of the posterior
+     * @param ndim the number of parameters
+     * @param rho the correlation of the Gaussian */
+    PerfTestNDFunction(const std::string& name, PerfTestNDFunction::Shape shape, unsigned ndim, double rho = 0.5);
+
+    /** The default destructor */
+    virtual ~PerfTestNDFunction();
+
+    /* @} */
+
+    /** Run before the test; no autocorrelation histograms in many dimensions.
+     * @return an error code. */
+    int PreTest()
+    { return 1; }
+
+    /** Run after the test
+     * @return an error code. */
+    int PostTest();
+
+    /** Defines the subtests. */
+    void DefineSubtests();
+
+    /* @} */
+
+    // inherited methods
+    double LogAPrioriProbability(const std::vector<double>& /*pars*/)
+    { return 0; }
+
+    double LogLikelihood(const std::vector<double>& pars);
+
+    void MCMCUserIterationInterface()
+    { fEffectiveSampleSizeEstimator.Fill(fMCMCx); }
+
+private:
+
+    /** The shape of the posterior. */
+    Shape fShape;
+
+    /** The correlation of the Gaussian. */
+    double fRho;
+
+    /** The standard deviations of the Gaussian. */
+    std::vector<double> fSigma;
+};
+
+#endif
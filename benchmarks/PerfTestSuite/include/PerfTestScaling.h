@@ -0,0 +1,100 @@
+/*!
+ * \class BAT::PerfTestScaling
+ * \brief A performance test class for the parallel scaling of BAT
+ * \detail The test runs the MCMC for a correlated Gaussian posterior for
+ * all combinations of the number of threads, chains and dimensions, with
+ * a fixed number of iterations. For each combination, the wall and CPU
+ * time are measured; the speed-up is the wall time with one thread
+ * divided by the wall time with n threads, the parallel efficiency is
+ * the speed-up divided by n. The threads are only used if BAT was
+ * configured with --enable-parallelization.
+ */
+
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+
+#ifndef BAT_PERFTESTSCALING
+#define BAT_PERFTESTSCALING
+
+#include <include/PerfTest.h>
+
+#include <string>
+#include <vector>
+
+class PerfTestScaling : public PerfTest
+{
+
+public:
+
+    /** \name Constructors and destructors  */
+    /* @{ */
+
+    /** The default constructor
+     * @param name the name of the test
+     * @param threads the numbers of threads; the first entry is the reference for the speed-up
+     * @param chains the numbers of chains
+     * @param dims the numbers of dimensions */
+    PerfTestScaling(const std::string& name, const std::vector<unsigned>& threads,
+                    const std::vector<unsigned>& chains, const std::vector<unsigned>& dims);
+
+    /** The default destructor */
+    ~PerfTestScaling();
+
+    /* @} */
+
+    virtual void SetProposal(bool multivariate, double dof)
+    {
+        fMultivariate = multivariate;
+        fDof = dof;
+    }
+
+    /** Run the test.
+     * @return an error code. */
+    int RunTest();
+
+    /** Run after the test
+     * @return an error code. */
+    int PostTest();
+
+    /** Writes the test to file.
+     * @return an error code. */
+    int WriteResults();
+
+    /** Define precision settings. */
+    void PrecisionSettings(PerfTest::Precision);
+
+private:
+
+    /** The measurement for one combination. */
+    struct Point {
+        unsigned threads;
+        unsigned chains;
+        unsigned dims;
+        double real_time;
+        double cpu_time;
+        double speedup;
+        double efficiency;
+    };
+
+    /** The numbers of threads, chains and dimensions. */
+    std::vector<unsigned> fThreads;
+    std::vector<unsigned> fChains;
+    std::vector<unsigned> fDims;
+
+    /** The measurements, with the number of threads running fastest. */
+    std::vector<Point> fPoints;
+
+    /** The number of iterations in the pre-run and the main run. */
+    unsigned fNIterations;
+
+    /** The proposal of the MCMC. */
+    bool fMultivariate;
+    double fDof;
+};
+
+#endif
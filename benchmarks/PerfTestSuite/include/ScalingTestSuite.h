@@ -0,0 +1,45 @@
+/*!
+ * \class BAT::ScalingTestSuite
+ * \brief A test suite for BAT in many dimensions and with many threads.
+ * It contains Gaussian, Rosenbrock and funnel posteriors with up to 500
+ * dimensions, synthetic template fits, and a sweep over the numbers of
+ * threads, chains and dimensions. The suite runs for a long time.
+ */
+
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+
+#ifndef BAT_SCALINGTESTSUITE
+#define BAT_SCALINGTESTSUITE
+
+#include <include/TestSuite.h>
+
+class ScalingTestSuite : public TestSuite
+{
+
+public:
+
+    /** \name Constructors and destructors  */
+    /* @{ */
+
+    /** The default constructor */
+    ScalingTestSuite(bool multivariate, double dof);
+
+    /* @} */
+    /** \name Member functions (misc)  */
+    /* @{ */
+
+    /**
+     * Prepare all tests.
+     * @return An error code. */
+    int PrepareTests();
+
+    /* @} */
+};
+
+#endif
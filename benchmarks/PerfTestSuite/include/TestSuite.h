@@ -12,6 +12,7 @@
 #define BAT_TESTSUITE
 
 #include <string>
+#include <map>
 #include <vector>
 
 #include <include/PerfTest.h>
@@ -70,6 +71,17 @@ public:
     void SetHtmlFileExtension(const std::string& ext)
     { fHtmlFileExtension = ext; };
 
+    /** Set the number of standard deviations by which a test has to be
+     * slower than the baseline to be flagged as a regression (3 by default). */
+    void SetRegressionThreshold(double n)
+    { fRegressionThreshold = n; };
+
+    /** Set the relative fluctuation of the real time of a test between
+     * runs (0.05 by default), added to the uncertainty of the comparison
+     * with the baseline. */
+    void SetTimingNoise(double noise)
+    { fTimingNoise = noise; };
+
     /* @} */
     /** \name Member functions (Get) */
     /* @{ */
@@ -96,6 +108,22 @@ public:
      * @return the test. */
     PerfTest* GetTest(const std::string& name);
 
+    /** Return the number of tests flagged as regression with respect to the baseline. */
+    int GetNRegressions();
+
+    /** Compare the performance of a test to the baseline. The performance
+     * is the smallest effective sample size per second, or the inverse real
+     * time for tests without MCMC.
+     * @param test the test.
+     * @return the logarithm of the ratio of the performance and the baseline
+     * divided by its uncertainty; negative if the test got slower, zero if
+     * the test is not in the baseline. */
+    double GetRegressionSignificance(PerfTest* test);
+
+    /** Return whether a test is significantly slower than the baseline. */
+    bool IsRegression(PerfTest* test)
+    { return GetRegressionSignificance(test) < -fRegressionThreshold; };
+
     /* @} */
     /** \name Member functions (misc) */
     /* @{ */
@@ -124,6 +152,17 @@ public:
      * @return an error code. */
     int RunTests();
 
+    /** Write the times and the effective sample sizes of all tests to a
+     * file, to compare later runs with.
+     * @param filename the name of the file.
+     * @return an error code. */
+    int WriteBaseline(const std::string& filename = "baseline.txt");
+
+    /** Read the baseline to compare the tests with from a file written by WriteBaseline().
+     * @param filename the name of the file.
+     * @return an error code. */
+    int ReadBaseline(const std::string& filename = "baseline.txt");
+
     /* @} */
 
 protected:
@@ -135,6 +174,16 @@ protected:
 
 private:
 
+    /** The performance of a test in an earlier run. */
+    struct Baseline {
+        double real_time;
+        double cpu_time;
+        double ess;
+        double ess_per_second;
+        double ess_per_evaluation;
+        double ess_uncertainty;
+    };
+
     /** A container of tests which belong to the test suite. */
     std::vector<PerfTest*> fTestContainer;
 
@@ -158,6 +207,15 @@ private:
 
     /** Set file extension for the html files (.html by default) */
     std::string fHtmlFileExtension;
+
+    /** The baseline of each test, by name. */
+    std::map<std::string, Baseline> fBaseline;
+
+    /** Number of standard deviations for flagging a regression. */
+    double fRegressionThreshold;
+
+    /** Relative fluctuation of the real time between runs. */
+    double fTimingNoise;
 };
 
 #endif
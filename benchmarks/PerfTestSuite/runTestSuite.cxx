@@ -1,4 +1,5 @@
 #include <include/ReleaseTestSuite.h>
+#include <include/ScalingTestSuite.h>
 #include <include/PerfTest.h>
 
 #include <TROOT.h>
@@ -6,35 +7,56 @@
 #include <TF1.h>
 
 #include <iostream>
+#include <string>
 
 using namespace std;
 
-int main()
+int main(int argc, char* argv[])
 {
+    // choose the suite: release (default) or scaling,
+    // optionally compare with the baseline of an earlier run
+    const string suite = argc > 1 ? argv[1] : "release";
+    if (argc > 3 or (suite != "release" and suite != "scaling")) {
+        cerr << "Usage: " << argv[0] << " [release|scaling] [baseline file]" << endl;
+        return 1;
+    }
+
     // create new test suite
     static const bool multivariate = false;
     static const double dof = 1.0;
     ReleaseTestSuite rts(multivariate, dof);
+    ScalingTestSuite sts(multivariate, dof);
+    TestSuite& ts = suite == "release" ? static_cast<TestSuite&>(rts) : static_cast<TestSuite&>(sts);
 
     // prepare test suite
-    rts.PrepareTests();
+    if (suite == "release")
+        rts.PrepareTests();
+    else
+        sts.PrepareTests();
 
     // setup html output as needed for BAT webpage
     //    rts.WebpageSetup();
 
     // set precision: kCoarse, kMedium, kDetail
-    rts.SetPrecision(PerfTest::kMedium);
+    ts.SetPrecision(PerfTest::kMedium);
+
+    // read baseline
+    if (argc > 2 and !ts.ReadBaseline(argv[2]))
+        return 1;
 
     // run all tests
-    rts.RunTests();
+    ts.RunTests();
+
+    // store results as baseline for later runs
+    ts.WriteBaseline("results_baseline.txt");
 
     // print results to screen
-    rts.PrintResultsScreen();
+    ts.PrintResultsScreen();
 
     // print results to html
     // to view it locally, turn off webpage setup, and save with .html extension
     // rts.PrintResultsHTML("results.php");
-    rts.PrintResultsHTML("results.html");
+    ts.PrintResultsHTML("results.html");
 
     return 0;
 }
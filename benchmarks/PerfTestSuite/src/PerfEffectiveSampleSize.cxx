@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+#include "include/PerfEffectiveSampleSize.h"
+
+#include <algorithm>
+#include <cmath>
+
+//______________________________________________________________________________
+PerfEffectiveSampleSize::PerfEffectiveSampleSize()
+    : fBatchSize(1)
+    , fNSamples(0)
+{
+}
+
+//______________________________________________________________________________
+void PerfEffectiveSampleSize::Init(unsigned nchains, unsigned npar, unsigned nsamples)
+{
+    fBatchSize = std::max(1u, unsigned(sqrt(double(nsamples))));
+    fNSamples = 0;
+
+    const std::vector<double> zero(npar, 0.);
+    fSum.assign(nchains, zero);
+    fSum2.assign(nchains, zero);
+    fBatchSum.assign(nchains, zero);
+    fBatchMeanSum.assign(nchains, zero);
+    fBatchMeanSum2.assign(nchains, zero);
+}
+
+//______________________________________________________________________________
+void PerfEffectiveSampleSize::Fill(const std::vector<std::vector<double> >& x)
+{
+    if (x.size() != fSum.size() || fSum.empty() || x.front().size() != fSum.front().size())
+        return;
+
+    ++fNSamples;
+    const bool batch_complete = (fNSamples % fBatchSize == 0);
+
+    for (unsigned c = 0; c < x.size(); ++c)
+        for (unsigned i = 0; i < x[c].size(); ++i) {
+            fSum[c][i] += x[c][i];
+            fSum2[c][i] += x[c][i] * x[c][i];
+            fBatchSum[c][i] += x[c][i];
+
+            if (batch_complete) {
+                const double mean = fBatchSum[c][i] / fBatchSize;
+                fBatchMeanSum[c][i] += mean;
+                fBatchMeanSum2[c][i] += mean * mean;
+                fBatchSum[c][i] = 0;
+            }
+        }
+}
+
+//______________________________________________________________________________
+std::vector<double> PerfEffectiveSampleSize::GetEffectiveSampleSize() const
+{
+    const unsigned nchains = fSum.size();
+    const unsigned npar = nchains > 0 ? fSum.front().size() : 0;
+    const unsigned nbatches = fNSamples / fBatchSize;
+
+    std::vector<double> ess(npar, 0.);
+    if (nbatches < 2)
+        return ess;
+
+    for (unsigned i = 0; i < npar; ++i) {
+        // variances within each chain, averaged over chains
+        double variance = 0;
+        double batch_variance = 0;
+        for (unsigned c = 0; c < nchains; ++c) {
+            const double mean = fSum[c][i] / fNSamples;
+            variance += (fSum2[c][i] - fNSamples * mean * mean) / (fNSamples - 1);
+            const double batch_mean = fBatchMeanSum[c][i] / nbatches;
+            batch_variance += (fBatchMeanSum2[c][i] - nbatches * batch_mean * batch_mean) / (nbatches - 1);
+        }
+
+        // n var(x) / (b var(batch means)), with n = number of batches * b
+        if (batch_variance > 0)
+            ess[i] = nchains * nbatches * variance / batch_variance;
+    }
+
+    return ess;
+}
+
+//______________________________________________________________________________
+double PerfEffectiveSampleSize::GetRelativeUncertainty() const
+{
+    // relative standard deviation of a variance estimated with k degrees of freedom: sqrt(2 / k)
+    const unsigned nbatches = fNSamples / fBatchSize;
+    if (nbatches < 2)
+        return 0;
+    return sqrt(2. / (fSum.size() * (nbatches - 1)));
+}
+
+//______________________________________________________________________________
@@ -11,6 +11,7 @@
 #include <TH1D.h>
 #include <TPDF.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
@@ -24,6 +25,9 @@ PerfTest::PerfTest(const std::string& name)
     , fName(name)
     , fRealTime(0.)
     , fCpuTime(0.)
+    , fEffectiveSampleSize(std::vector<double>(0))
+    , fEffectiveSampleSizeUncertainty(0.)
+    , fNEvaluations(0)
 {
     // define subtests
     //   DefineSubtests();
@@ -60,6 +64,15 @@ std::string TypeToString(PerfTest::TestType type)
         case PerfTest::kFunction2D :
             return std::string("Function2D");
 
+        case PerfTest::kFunctionND :
+            return std::string("FunctionND");
+
+        case PerfTest::kMTF :
+            return std::string("MTF");
+
+        case PerfTest::kScaling :
+            return std::string("Scaling");
+
         default :
             return std::string("-");
     }
@@ -187,6 +200,33 @@ std::string PerfTest::GetCanvasDescription(int index)
     return fCanvasDescriptionContainer.at(index);
 }
 
+//______________________________________________________________________________
+double PerfTest::GetMinEffectiveSampleSize()
+{
+    if (fEffectiveSampleSize.empty())
+        return 0;
+
+    return *std::min_element(fEffectiveSampleSize.begin(), fEffectiveSampleSize.end());
+}
+
+//______________________________________________________________________________
+double PerfTest::GetEffectiveSamplesPerSecond()
+{
+    if (fRealTime <= 0)
+        return 0;
+
+    return GetMinEffectiveSampleSize() / fRealTime;
+}
+
+//______________________________________________________________________________
+double PerfTest::GetEffectiveSamplesPerEvaluation()
+{
+    if (fNEvaluations == 0)
+        return 0;
+
+    return GetMinEffectiveSampleSize() / fNEvaluations;
+}
+
 //______________________________________________________________________________
 int PerfTest::ReadResults()
 {
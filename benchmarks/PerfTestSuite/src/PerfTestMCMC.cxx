@@ -125,6 +125,8 @@ int PerfTestMCMC::PostTest()
         GetSubtest(Form("correlation par %i", i))->SetStatusOff(true);
     }
 
+    SetSamplerEfficiency();
+
     // no error
     return 1;
 }
@@ -135,6 +137,9 @@ int PerfTestMCMC::RunTest()
     // define error code
     int err = 1;
 
+    // samples after the lag are used for the effective sample size
+    fEffectiveSampleSizeEstimator.Init(GetNChains(), GetNParameters(), GetNIterationsRun() / GetNLag());
+
     // perform mcmc
     err *= MarginalizeAll(BCIntegrate::kMargMetropolis);
 
@@ -189,9 +194,19 @@ void PerfTestMCMC::PrecisionSettings(PerfTest::Precision precision)
     SetNIterationsRun(iter);
 }
 
+//______________________________________________________________________________
+void PerfTestMCMC::SetSamplerEfficiency()
+{
+    SetEffectiveSampleSize(fEffectiveSampleSizeEstimator.GetEffectiveSampleSize(),
+                           fEffectiveSampleSizeEstimator.GetRelativeUncertainty());
+    SetNEvaluations(GetProfile(BCEngineMCMC::kMainRun).n_evaluations);
+}
+
 //______________________________________________________________________________
 void PerfTestMCMC::MCMCUserIterationInterface()
 {
+    fEffectiveSampleSizeEstimator.Fill(fMCMCx);
+
     // copy over old point on first call
     if (fXOld.size() < fMCMCx.size()) {
         fXOld = fMCMCx;
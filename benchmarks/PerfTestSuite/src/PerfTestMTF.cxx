@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+#include "include/PerfTestMTF.h"
+
+#include <TH1D.h>
+
+#include <algorithm>
+#include <cmath>
+
+//______________________________________________________________________________
+PerfTestMTF::PerfTestMTF(const std::string& name, unsigned nchannels, unsigned nprocesses, unsigned nbins)
+    : PerfTest(name)
+    , BCMTF(name)
+{
+    // set test type
+    fTestType = PerfTest::kMTF;
+
+    // background and peaks
+    for (unsigned p = 0; p < nprocesses; ++p) {
+        fTrueNorm.push_back(p == 0 ? 1000. : 200.);
+        AddProcess(Form("process_%u", p), 0, 3 * fTrueNorm.back());
+    }
+
+    for (unsigned c = 0; c < nchannels; ++c) {
+        std::string channel = Form("channel_%u", c);
+        AddChannel(channel);
+
+        TH1D data(Form("%s_data_%u", name.data(), c), "", nbins, 0, 1);
+        data.SetDirectory(0);
+
+        for (unsigned p = 0; p < nprocesses; ++p) {
+            TH1D h(Form("%s_template_%u_%u", name.data(), c, p), "", nbins, 0, 1);
+            h.SetDirectory(0);
+            const double mean = (p + 0.5 * (c % 2)) / nprocesses;
+            for (unsigned b = 1; b <= nbins; ++b) {
+                const double x = h.GetBinCenter(b);
+                h.SetBinContent(b, p == 0 ? exp(-3 * x) : exp(-0.5 * (x - mean) * (x - mean) / 0.0025));
+            }
+            h.Scale(1. / h.Integral());
+
+            // the processes are shared equally by all channels
+            SetTemplate(channel, Form("process_%u", p), h, 1. / nchannels);
+            data.Add(&h, fTrueNorm[p] / nchannels);
+        }
+
+        SetData(channel, data);
+    }
+
+    // 2D histograms grow quadratically with the number of processes
+    GetParameters().FillH2(false);
+
+    DefineSubtests();
+}
+
+//______________________________________________________________________________
+PerfTestMTF::~PerfTestMTF()
+{
+}
+
+//______________________________________________________________________________
+int PerfTestMTF::RunTest()
+{
+    // samples after the lag are used for the effective sample size
+    fEffectiveSampleSizeEstimator.Init(GetNChains(), GetNParameters(), GetNIterationsRun() / GetNLag());
+
+    // perform mcmc
+    return MarginalizeAll(BCIntegrate::kMargMetropolis);
+}
+
+//______________________________________________________________________________
+int PerfTestMTF::PostTest()
+{
+    const BCEngineMCMC::Statistics& s = GetStatistics();
+
+    // largest deviation of a normalization from the true value in units of its uncertainty
+    double pull = 0;
+    for (unsigned p = 0; p < fTrueNorm.size(); ++p)
+        pull = std::max(pull, fabs(s.mean[p] - fTrueNorm[p]) / sqrt(s.variance[p]));
+    GetSubtest("pull")->SetTestValue(pull);
+
+    SetEffectiveSampleSize(fEffectiveSampleSizeEstimator.GetEffectiveSampleSize(), fEffectiveSampleSizeEstimator.GetRelativeUncertainty());
+    SetNEvaluations(GetProfile(BCEngineMCMC::kMainRun).n_evaluations);
+
+    // no error
+    return 1;
+}
+
+//______________________________________________________________________________
+void PerfTestMTF::DefineSubtests()
+{
+    PerfSubTest* subtest = new PerfSubTest("pull");
+    subtest->SetDescription("Largest deviation of the posterior mean of a process normalization from the true value, in units of the posterior standard deviation. <br> Tolerance good: 0.2, acceptable: 0.4, bad: 0.6.");
+    subtest->SetTargetValue(0);
+    subtest->SetStatusRegion(PerfSubTest::kGood, 0.2);
+    subtest->SetStatusRegion(PerfSubTest::kAcceptable, 0.4);
+    subtest->SetStatusRegion(PerfSubTest::kBad, 0.6);
+    AddSubtest(subtest);
+}
+
+//______________________________________________________________________________
+int PerfTestMTF::WriteResults()
+{
+    PerfTest::WriteResults();
+
+    PrintSummary();
+
+    return 1;
+}
+
+//______________________________________________________________________________
+void PerfTestMTF::PrecisionSettings(PerfTest::Precision precision)
+{
+    if (precision == PerfTest::kCoarse)
+        BCEngineMCMC::SetPrecision(BCEngineMCMC::kLow);
+    else
+        BCEngineMCMC::SetPrecision(BCEngineMCMC::kMedium);
+}
+
+//______________________________________________________________________________
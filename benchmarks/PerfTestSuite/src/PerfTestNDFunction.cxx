@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+#include "include/PerfTestNDFunction.h"
+
+#include <BAT/BCParameter.h>
+
+#include <TMath.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+//______________________________________________________________________________
+PerfTestNDFunction::PerfTestNDFunction(const std::string& name, PerfTestNDFunction::Shape shape, unsigned ndim, double rho)
+    : PerfTestMCMC(name)
+    , fShape(shape)
+    , fRho(rho)
+{
+    // set test type
+    fTestType = PerfTest::kFunctionND;
+
+    if (ndim < 2)
+        throw std::invalid_argument(name + ": need at least two dimensions");
+
+    // add parameters
+    for (unsigned i = 0; i < ndim; ++i) {
+        switch (fShape) {
+            case kGaussian:
+                fSigma.push_back(1. + double(i) / (ndim - 1));
+                AddParameter(Form("x%u", i), -6 * fSigma.back(), 6 * fSigma.back());
+                break;
+            case kRosenbrock:
+                AddParameter(Form("x%u", i), -5, 10);
+                break;
+            case kFunnel:
+                // v is cut at two standard deviations, so the x_i with
+                // standard deviation up to exp(3) are not cut
+                if (i == 0)
+                    AddParameter("v", -6, 6);
+                else
+                    AddParameter(Form("x%u", i), -100, 100);
+                break;
+        }
+    }
+
+    // 2D histograms grow quadratically with the number of parameters
+    GetParameters().FillH2(false);
+
+    DefineSubtests();
+}
+
+//______________________________________________________________________________
+PerfTestNDFunction::~PerfTestNDFunction()
+{
+}
+
+//______________________________________________________________________________
+double PerfTestNDFunction::LogLikelihood(const std::vector<double>& pars)
+{
+    const unsigned n = pars.size();
+    double logl = 0;
+
+    switch (fShape) {
+        case kGaussian: {
+            // inverse of the equicorrelation matrix:
+            // (I - rho / (1 + (n-1) rho) 1 1^T) / (1 - rho)
+            double sum = 0;
+            double sum2 = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                const double z = pars[i] / fSigma[i];
+                sum += z;
+                sum2 += z * z;
+            }
+            logl = -0.5 / (1 - fRho) * (sum2 - fRho / (1 + (n - 1) * fRho) * sum * sum);
+            break;
+        }
+        case kRosenbrock:
+            for (unsigned i = 0; i + 1 < n; ++i) {
+                const double a = 1 - pars[i];
+                const double b = pars[i + 1] - pars[i] * pars[i];
+                logl -= (a * a + 100 * b * b) / 20;
+            }
+            break;
+        case kFunnel: {
+            const double v = pars[0];
+            const double precision = exp(-v);
+            logl = -v * v / 18 - 0.5 * (n - 1) * v;
+            for (unsigned i = 1; i < n; ++i)
+                logl -= 0.5 * pars[i] * pars[i] * precision;
+            break;
+        }
+    }
+
+    return logl;
+}
+
+//______________________________________________________________________________
+int PerfTestNDFunction::PostTest()
+{
+    const BCEngineMCMC::Statistics& s = GetStatistics();
+    const unsigned n = GetNParameters();
+
+    switch (fShape) {
+        case kGaussian: {
+            // largest deviations of means and variances in units of the true values
+            double mean = 0;
+            double variance = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                mean = std::max(mean, fabs(s.mean[i]) / fSigma[i]);
+                variance = std::max(variance, fabs(s.variance[i] / (fSigma[i] * fSigma[i]) - 1));
+            }
+            GetSubtest("mean")->SetTestValue(mean);
+            GetSubtest("variance")->SetTestValue(variance);
+            break;
+        }
+        case kRosenbrock: {
+            double mode = 0;
+            for (unsigned i = 0; i < n; ++i)
+                mode = std::max(mode, fabs(GetBestFitParameters()[i] - 1));
+            GetSubtest("mode")->SetTestValue(mode);
+            break;
+        }
+        case kFunnel: {
+            // v is a Gaussian of standard deviation 3, truncated at +-2 standard deviations
+            const double phi = exp(-2.) / sqrt(2 * TMath::Pi());
+            const double sigma = 3 * sqrt(1 - 4 * phi / TMath::Erf(2 / sqrt(2.)));
+            GetSubtest("mean")->SetTestValue(s.mean[0] / sigma);
+            GetSubtest("variance")->SetTestValue(s.variance[0] / (sigma * sigma) - 1);
+            break;
+        }
+    }
+
+    SetSamplerEfficiency();
+
+    // no error
+    return 1;
+}
+
+//______________________________________________________________________________
+void PerfTestNDFunction::DefineSubtests()
+{
+    if (fShape == kRosenbrock) {
+        PerfSubTest* subtest = new PerfSubTest("mode");
+        subtest->SetDescription("Largest deviation of the mode found by the MCMC from the true mode at (1, ..., 1). <br> The mode is hard to find in many dimensions, so the status is not evaluated.");
+        subtest->SetTargetValue(0);
+        subtest->SetStatusRegion(PerfSubTest::kGood, 0.1);
+        subtest->SetStatusRegion(PerfSubTest::kAcceptable, 0.2);
+        subtest->SetStatusRegion(PerfSubTest::kBad, 0.5);
+        subtest->SetStatusOff(true);
+        AddSubtest(subtest);
+        return;
+    }
+
+    PerfSubTest* mean = new PerfSubTest("mean");
+    PerfSubTest* variance = new PerfSubTest("variance");
+    if (fShape == kGaussian) {
+        mean->SetDescription("Largest deviation of the mean of a parameter from zero, in units of its standard deviation. <br> Tolerance good: 0.1, acceptable: 0.2, bad: 0.3.");
+        variance->SetDescription("Largest relative deviation of the variance of a parameter from the true value. <br> Tolerance good: 0.1, acceptable: 0.2, bad: 0.3.");
+    } else {
+        mean->SetDescription("Deviation of the mean of v from zero, in units of its standard deviation. <br> Tolerance good: 0.1, acceptable: 0.2, bad: 0.3.");
+        variance->SetDescription("Relative deviation of the variance of v from the true value. The neck of the funnel is hard to sample. <br> Tolerance good: 0.1, acceptable: 0.2, bad: 0.3.");
+    }
+
+    PerfSubTest* subtests[2] = { mean, variance };
+    for (unsigned i = 0; i < 2; ++i) {
+        subtests[i]->SetTargetValue(0);
+        subtests[i]->SetStatusRegion(PerfSubTest::kGood, 0.1);
+        subtests[i]->SetStatusRegion(PerfSubTest::kAcceptable, 0.2);
+        subtests[i]->SetStatusRegion(PerfSubTest::kBad, 0.3);
+        AddSubtest(subtests[i]);
+    }
+}
+
+//______________________________________________________________________________
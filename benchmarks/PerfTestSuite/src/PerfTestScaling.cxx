@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+#include "include/PerfTestScaling.h"
+#include "include/PerfTestNDFunction.h"
+
+#include <TCanvas.h>
+#include <TGraph.h>
+#include <TH2D.h>
+#include <TStopwatch.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//______________________________________________________________________________
+PerfTestScaling::PerfTestScaling(const std::string& name, const std::vector<unsigned>& threads,
+                                 const std::vector<unsigned>& chains, const std::vector<unsigned>& dims)
+    : PerfTest(name)
+    , fThreads(threads)
+    , fChains(chains)
+    , fDims(dims)
+    , fNIterations(10000)
+    , fMultivariate(true)
+    , fDof(1)
+{
+    // set test type
+    fTestType = PerfTest::kScaling;
+
+    // the speed-up at the largest number of threads, for information only
+    for (unsigned c = 0; c < fChains.size(); ++c)
+        for (unsigned d = 0; d < fDims.size(); ++d) {
+            PerfSubTest* subtest = new PerfSubTest(Form("speed-up %u chains %u dims", fChains[c], fDims[d]));
+            subtest->SetDescription(Form("Wall time with %u thread(s) divided by the wall time with %u threads, for %u chains of a Gaussian in %u dimensions. The target value is the ideal speed-up. <br> The speed-up depends on the machine, so the status is not evaluated.",
+                                         fThreads.front(), fThreads.back(), fChains[c], fDims[d]));
+            subtest->SetTargetValue(double(fThreads.back()) / fThreads.front());
+            subtest->SetStatusOff(true);
+            AddSubtest(subtest);
+        }
+}
+
+//______________________________________________________________________________
+PerfTestScaling::~PerfTestScaling()
+{
+}
+
+//______________________________________________________________________________
+int PerfTestScaling::RunTest()
+{
+    fPoints.clear();
+
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+#else
+    std::cout << " " << GetName() << ": compiled without OpenMP, the number of threads is not set." << std::endl;
+#endif
+
+    for (unsigned c = 0; c < fChains.size(); ++c)
+        for (unsigned d = 0; d < fDims.size(); ++d) {
+            PerfTestNDFunction test(Form("%s_%u_%u", GetName().data(), fChains[c], fDims[d]), PerfTestNDFunction::kGaussian, fDims[d]);
+            test.SetProposal(fMultivariate, fDof);
+            test.SetNChains(fChains[c]);
+            test.SetNIterationsPreRunMin(fNIterations);
+            test.SetNIterationsPreRunMax(fNIterations);
+            test.SetNIterationsRun(fNIterations);
+            test.SetRandomSeed(1234);
+
+            for (unsigned t = 0; t < fThreads.size(); ++t) {
+#ifdef _OPENMP
+                omp_set_num_threads(fThreads[t]);
+#endif
+                TStopwatch sw;
+                sw.Start();
+                test.MarginalizeAll(BCIntegrate::kMargMetropolis);
+                sw.Stop();
+
+                Point p;
+                p.threads = fThreads[t];
+                p.chains = fChains[c];
+                p.dims = fDims[d];
+                p.real_time = sw.RealTime();
+                p.cpu_time = sw.CpuTime();
+                // relative to the first number of threads of this combination
+                const Point& ref = t == 0 ? p : fPoints[fPoints.size() - t];
+                p.speedup = p.real_time > 0 ? ref.real_time / p.real_time : 0;
+                p.efficiency = p.speedup * ref.threads / p.threads;
+                fPoints.push_back(p);
+            }
+
+            GetSubtest(Form("speed-up %u chains %u dims", fChains[c], fDims[d]))->SetTestValue(fPoints.back().speedup);
+        }
+
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+
+    // no error
+    return 1;
+}
+
+//______________________________________________________________________________
+int PerfTestScaling::PostTest()
+{
+    // table on screen
+    std::cout << std::endl
+              << " " << GetName() << ": " << fNIterations << " iterations in the pre-run and the run" << std::endl
+              << "  threads  chains    dims  wall time [s]  CPU time [s]  speed-up  efficiency" << std::endl;
+    for (unsigned i = 0; i < fPoints.size(); ++i)
+        std::cout << std::setw(9) << fPoints[i].threads
+                  << std::setw(8) << fPoints[i].chains
+                  << std::setw(8) << fPoints[i].dims
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(15) << fPoints[i].real_time
+                  << std::setw(14) << fPoints[i].cpu_time
+                  << std::setprecision(2)
+                  << std::setw(10) << fPoints[i].speedup
+                  << std::setw(12) << fPoints[i].efficiency
+                  << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6) << std::endl;
+
+    // speed-up curves
+    const unsigned nthreads = fThreads.size();
+    for (unsigned i = 0; i + nthreads <= fPoints.size(); i += nthreads) {
+        TCanvas* c = new TCanvas();
+        c->cd();
+
+        TGraph* ideal = new TGraph(nthreads);
+        TGraph* speedup = new TGraph(nthreads);
+        for (unsigned t = 0; t < nthreads; ++t) {
+            ideal->SetPoint(t, fThreads[t], double(fThreads[t]) / fThreads.front());
+            speedup->SetPoint(t, fThreads[t], fPoints[i + t].speedup);
+        }
+
+        TH2D* hist = new TH2D("", Form("%u chains, %u dimensions;threads;speed-up", fPoints[i].chains, fPoints[i].dims),
+                              1, 0, fThreads.back() + 1,
+                              1, 0, 1.1 * double(fThreads.back()) / fThreads.front());
+        hist->SetStats(kFALSE);
+        hist->Draw();
+        ideal->SetLineStyle(2);
+        ideal->Draw("L");
+        speedup->SetMarkerStyle(20);
+        speedup->Draw("PL");
+        AddCanvas(c);
+        AddCanvasDescription(Form("Speed-up as a function of the number of threads for %u chains of a Gaussian in %u dimensions. Dashed: ideal speed-up.",
+                                  fPoints[i].chains, fPoints[i].dims));
+    }
+
+    // no error
+    return 1;
+}
+
+//______________________________________________________________________________
+int PerfTestScaling::WriteResults()
+{
+    PerfTest::WriteResults();
+
+    std::ofstream file((GetName() + ".csv").data());
+    file << "threads,chains,dims,real_time,cpu_time,speedup,efficiency" << std::endl;
+    for (unsigned i = 0; i < fPoints.size(); ++i)
+        file << fPoints[i].threads << ","
+             << fPoints[i].chains << ","
+             << fPoints[i].dims << ","
+             << fPoints[i].real_time << ","
+             << fPoints[i].cpu_time << ","
+             << fPoints[i].speedup << ","
+             << fPoints[i].efficiency << std::endl;
+
+    return 1;
+}
+
+//______________________________________________________________________________
+void PerfTestScaling::PrecisionSettings(PerfTest::Precision precision)
+{
+    if (precision == PerfTest::kCoarse)
+        fNIterations = 1000;
+    else if (precision == PerfTest::kMedium)
+        fNIterations = 10000;
+    else
+        fNIterations = 100000;
+}
+
+//______________________________________________________________________________
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2009, Daniel Kollar and Kevin Kroeninger.
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ */
+
+
+#include "include/ScalingTestSuite.h"
+#include <include/PerfTestMTF.h>
+#include <include/PerfTestNDFunction.h>
+#include <include/PerfTestScaling.h>
+
+#include <vector>
+
+//______________________________________________________________________________
+ScalingTestSuite::ScalingTestSuite(bool multivariate, double dof):
+    TestSuite(multivariate, dof)
+{
+}
+
+//______________________________________________________________________________
+int ScalingTestSuite::PrepareTests()
+{
+    /* N dimensions */
+#if 1
+    const unsigned dims[3] = { 10, 100, 500 };
+    for (unsigned i = 0; i < 3; ++i) {
+        AddTest(new PerfTestNDFunction(Form("%ud_gaus", dims[i]), PerfTestNDFunction::kGaussian, dims[i]));
+        AddTest(new PerfTestNDFunction(Form("%ud_rosenbrock", dims[i]), PerfTestNDFunction::kRosenbrock, dims[i]));
+        AddTest(new PerfTestNDFunction(Form("%ud_funnel", dims[i]), PerfTestNDFunction::kFunnel, dims[i]));
+    }
+#endif
+
+    /* template fits */
+#if 1
+    // one channel, background and two peaks
+    AddTest(new PerfTestMTF("mtf_1_3", 1, 3, 50));
+
+    // many channels and processes
+    AddTest(new PerfTestMTF("mtf_10_10", 10, 10, 100));
+#endif
+
+    /* threads x chains x dimensions */
+#if 1
+    std::vector<unsigned> threads;
+    for (unsigned n = 1; n <= 16; n *= 2)
+        threads.push_back(n);
+
+    std::vector<unsigned> chains;
+    chains.push_back(4);
+    chains.push_back(16);
+
+    std::vector<unsigned> sweep_dims;
+    sweep_dims.push_back(10);
+    sweep_dims.push_back(100);
+
+    AddTest(new PerfTestScaling("scaling", threads, chains, sweep_dims));
+#endif
+
+    // proposal for all MCMC  tests
+    for (unsigned i = 0; i < GetNTests(); ++i)
+        GetTest(i)->SetProposal(fMultivariate, fDof);
+
+    // no error
+    return 1;
+}
+
+//______________________________________________________________________________
@@ -10,9 +10,11 @@
 
 #include <TStopwatch.h>
 
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 
 //______________________________________________________________________________
 TestSuite::TestSuite(bool multivariate, double dof):
@@ -25,7 +27,9 @@ TestSuite::TestSuite(bool multivariate, double dof):
     fIncludeHtmlFooter(true),
     fLinkPrefix(""),
     fFileLinkPrefix(""),
-    fHtmlFileExtension(".html")
+    fHtmlFileExtension(".html"),
+    fRegressionThreshold(3.),
+    fTimingNoise(0.05)
 {
     DefineTests();
 }
@@ -87,6 +91,43 @@ PerfTest* TestSuite::GetTest(const std::string& name)
     return 0;
 }
 
+//______________________________________________________________________________
+int TestSuite::GetNRegressions()
+{
+    int counter = 0;
+
+    for (unsigned i = 0; i < GetNTests(); ++i)
+        if (IsRegression(GetTest(i)))
+            counter++;
+
+    return counter;
+}
+
+//______________________________________________________________________________
+double TestSuite::GetRegressionSignificance(PerfTest* test)
+{
+    std::map<std::string, Baseline>::const_iterator it = fBaseline.find(test->GetName());
+    if (it == fBaseline.end() || test->GetRealTime() <= 0 || it->second.real_time <= 0)
+        return 0;
+    const Baseline& base = it->second;
+
+    // the real time fluctuates in both runs
+    double variance = 2 * fTimingNoise * fTimingNoise;
+    double ratio;
+
+    if (test->GetEffectiveSamplesPerSecond() > 0 && base.ess_per_second > 0) {
+        ratio = test->GetEffectiveSamplesPerSecond() / base.ess_per_second;
+        variance += test->GetEffectiveSampleSizeUncertainty() * test->GetEffectiveSampleSizeUncertainty()
+                    + base.ess_uncertainty * base.ess_uncertainty;
+    } else
+        ratio = base.real_time / test->GetRealTime();
+
+    if (variance <= 0)
+        return 0;
+
+    return log(ratio) / sqrt(variance);
+}
+
 //______________________________________________________________________________
 int TestSuite::AddTest(PerfTest* test)
 {
@@ -122,6 +163,62 @@ int TestSuite::RunTests()
     return err;
 }
 
+//______________________________________________________________________________
+int TestSuite::WriteBaseline(const std::string& filename)
+{
+    std::ofstream file(filename.c_str());
+
+    if (!file.is_open()) {
+        std::cout << "Could not open file " << filename << "." << std::endl;
+        return 0;
+    }
+
+    file << "# test real_time cpu_time ess ess_per_second ess_per_evaluation ess_uncertainty" << std::endl;
+    for (unsigned i = 0; i < GetNTests(); ++i)
+        file << GetTest(i)->GetName() << " "
+             << GetTest(i)->GetRealTime() << " "
+             << GetTest(i)->GetCpuTime() << " "
+             << GetTest(i)->GetMinEffectiveSampleSize() << " "
+             << GetTest(i)->GetEffectiveSamplesPerSecond() << " "
+             << GetTest(i)->GetEffectiveSamplesPerEvaluation() << " "
+             << GetTest(i)->GetEffectiveSampleSizeUncertainty() << std::endl;
+
+    // no error
+    return 1;
+}
+
+//______________________________________________________________________________
+int TestSuite::ReadBaseline(const std::string& filename)
+{
+    std::ifstream file(filename.c_str());
+
+    if (!file.is_open()) {
+        std::cout << "Could not open file " << filename << "." << std::endl;
+        return 0;
+    }
+
+    fBaseline.clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        std::string name;
+        Baseline base;
+        if (!(stream >> name >> base.real_time >> base.cpu_time >> base.ess
+              >> base.ess_per_second >> base.ess_per_evaluation >> base.ess_uncertainty)) {
+            std::cout << "Could not read line \"" << line << "\" of file " << filename << "." << std::endl;
+            return 0;
+        }
+        fBaseline[name] = base;
+    }
+
+    // no error
+    return 1;
+}
+
 //______________________________________________________________________________
 void TestSuite::PrintResultsScreen()
 {
@@ -135,6 +232,8 @@ void TestSuite::PrintResultsScreen()
     std::cout << " Number of bad tests           : " << GetNTests(PerfSubTest::kBad) << std::endl;
     std::cout << " Number of fatal tests         : " << GetNTests(PerfSubTest::kFatal) << std::endl;
     std::cout << " Number of tests unkown status : " << GetNTests(PerfSubTest::kUnknown) << std::endl;
+    if (!fBaseline.empty())
+        std::cout << " Number of regressions         : " << GetNRegressions() << std::endl;
     std::cout << std::endl;
 
     // loop over tests
@@ -143,6 +242,18 @@ void TestSuite::PrintResultsScreen()
     for (int i = 0; i < n; ++i) {
         std::cout << " Test \"" << (GetTest(i)->GetName()).data() << "\" : " << GetTest(i)->GetStatusString().data() << std::endl;
 
+        // sampler efficiency and comparison with the baseline
+        std::cout << "  Real time " << std::setprecision(4) << GetTest(i)->GetRealTime() << " s";
+        if (!GetTest(i)->GetEffectiveSampleSize().empty())
+            std::cout << ", min. ESS " << GetTest(i)->GetMinEffectiveSampleSize()
+                      << ", ESS/s " << GetTest(i)->GetEffectiveSamplesPerSecond()
+                      << ", ESS/evaluation " << GetTest(i)->GetEffectiveSamplesPerEvaluation();
+        std::cout << std::endl;
+        if (fBaseline.find(GetTest(i)->GetName()) != fBaseline.end())
+            std::cout << "  Change w.r.t. baseline : " << std::setprecision(3) << GetRegressionSignificance(GetTest(i)) << " sigma"
+                      << (IsRegression(GetTest(i)) ? "  REGRESSION" : "") << std::endl;
+        std::cout << std::setprecision(6);
+
         // loop over subtests
         int nsub = GetTest(i)->GetNSubtests();
         for (int j = 0; j < nsub; ++j)
@@ -175,6 +286,8 @@ void TestSuite::PrintResultsHTML(const std::string& filename)
     file_main << " <tr> <td align=\"left\"> Number of bad tests </td> <td>" << GetNTests(PerfSubTest::kBad) << " </td> </tr>" << std::endl;
     file_main << " <tr> <td align=\"left\"> Number of fatal tests </td> <td>" << GetNTests(PerfSubTest::kFatal) << " </td> </tr>" << std::endl;
     file_main << " <tr> <td align=\"left\"> Number of tests unkown status </td> <td>" << GetNTests(PerfSubTest::kUnknown) << " </td> </tr>" << std::endl;
+    if (!fBaseline.empty())
+        file_main << " <tr> <td align=\"left\"> Number of regressions </td> <td>" << GetNRegressions() << " </td> </tr>" << std::endl;
     file_main << " <tr> <td align=\"left\">" << (fMultivariate ? "Multivariate" : "Factorized") <<  " proposal</td> <td>" << (fMultivariate ? Form("%g degrees of freedom", fDof) : "") << "</td> </tr>" << std::endl;
     file_main << "</table>" << std::endl;
     file_main << std::endl;
@@ -260,6 +373,50 @@ void TestSuite::PrintResultsHTML(const std::string& filename)
     }
     file_main << "</table>" << std::endl;
 
+    file_main << "<h3>Performance</h3>" << std::endl << std::endl;
+    file_main << "<table border=\"0\"  width=\"70\">" << std::endl;
+    file_main << "<tr>" << std::endl;
+    file_main << "  <th align=\"left\" width=\"15%\"> Test </th>" << std::endl;
+    file_main << "  <th align=\"left\"> Real time [s] </th>" << std::endl;
+    file_main << "  <th align=\"left\"> CPU time [s] </th>" << std::endl;
+    file_main << "  <th align=\"left\"> Min. ESS </th>" << std::endl;
+    file_main << "  <th align=\"left\"> ESS/s </th>" << std::endl;
+    file_main << "  <th align=\"left\"> ESS/evaluation </th>" << std::endl;
+    if (!fBaseline.empty()) {
+        file_main << "  <th align=\"left\"> Baseline real time [s] </th>" << std::endl;
+        file_main << "  <th align=\"left\"> Baseline ESS/s </th>" << std::endl;
+        file_main << "  <th align=\"left\"> Change [sigma] </th>" << std::endl;
+    }
+    file_main << "</tr>" << std::endl;
+    for (unsigned i = 0; i < GetNTests(); ++i) {
+        PerfTest* test = GetTest(i);
+        const bool mcmc = !test->GetEffectiveSampleSize().empty();
+        file_main << " <tr>";
+        file_main << " <td align=\"left\"><a href=\"" << fLinkPrefix << (test->GetName()).c_str() << fHtmlFileExtension.c_str() << "\">" << (test->GetName()).c_str() << "</a> </td>" << std::endl;
+        file_main << " <td align=\"left\">" << std::setprecision(4) << test->GetRealTime() << "</td>" << std::endl;
+        file_main << " <td align=\"left\">" << std::setprecision(4) << test->GetCpuTime() << "</td>" << std::endl;
+        if (mcmc) {
+            file_main << " <td align=\"left\">" << std::setprecision(4) << test->GetMinEffectiveSampleSize() << "</td>" << std::endl;
+            file_main << " <td align=\"left\">" << std::setprecision(4) << test->GetEffectiveSamplesPerSecond() << "</td>" << std::endl;
+            file_main << " <td align=\"left\">" << std::setprecision(4) << test->GetEffectiveSamplesPerEvaluation() << "</td>" << std::endl;
+        } else
+            file_main << " <td align=\"left\"> - </td> <td align=\"left\"> - </td> <td align=\"left\"> - </td>" << std::endl;
+        if (!fBaseline.empty()) {
+            std::map<std::string, Baseline>::const_iterator it = fBaseline.find(test->GetName());
+            if (it != fBaseline.end()) {
+                file_main << " <td align=\"left\">" << std::setprecision(4) << it->second.real_time << "</td>" << std::endl;
+                file_main << " <td align=\"left\">" << std::setprecision(4) << it->second.ess_per_second << "</td>" << std::endl;
+                if (IsRegression(test))
+                    file_main << " <td align=\"left\"><font color=\"#FF0000\">" << std::setprecision(3) << GetRegressionSignificance(test) << " (regression)</font></td>" << std::endl;
+                else
+                    file_main << " <td align=\"left\">" << std::setprecision(3) << GetRegressionSignificance(test) << "</td>" << std::endl;
+            } else
+                file_main << " <td align=\"left\"> - </td> <td align=\"left\"> - </td> <td align=\"left\"> - </td>" << std::endl;
+        }
+        file_main << "</tr>" << std::endl;
+    }
+    file_main << "</table>" << std::endl;
+
     // loop over tests
     for (unsigned i = 0; i < GetNTests(); ++i) {
 
@@ -286,6 +443,13 @@ void TestSuite::PrintResultsHTML(const std::string& filename)
         file << " <tr> <td>Status</td> <td>" << GetTest(i)->GetStatusStringHTML().data() << " </td> </tr>" << std::endl;
         file << " <tr> <td>CPU time</td> <td>" << std::setprecision(4) << GetTest(i)->GetCpuTime() << " s </td></tr>" << std::endl;
         file << " <tr> <td>Real time</td> <td>" << std::setprecision(4) << GetTest(i)->GetRealTime() << " s </td></tr>" << std::endl;
+        if (!GetTest(i)->GetEffectiveSampleSize().empty()) {
+            file << " <tr> <td>Evaluations (main run)</td> <td>" << GetTest(i)->GetNEvaluations() << " </td></tr>" << std::endl;
+            file << " <tr> <td>Min. ESS</td> <td>" << std::setprecision(4) << GetTest(i)->GetMinEffectiveSampleSize()
+                 << " &plusmn; " << std::setprecision(2) << 100 * GetTest(i)->GetEffectiveSampleSizeUncertainty() << " % </td></tr>" << std::endl;
+            file << " <tr> <td>ESS/s</td> <td>" << std::setprecision(4) << GetTest(i)->GetEffectiveSamplesPerSecond() << " </td></tr>" << std::endl;
+            file << " <tr> <td>ESS/evaluation</td> <td>" << std::setprecision(4) << GetTest(i)->GetEffectiveSamplesPerEvaluation() << " </td></tr>" << std::endl;
+        }
         file << " <tr> <td>Plots</td> <td>" << "<a href=\"" << fFileLinkPrefix << GetTest(i)->GetName().data() << ".pdf" << "\">" << GetTest(i)->GetName().data() << ".pdf</a>" << " </td> </tr>" << std::endl;
         file << " <tr> <td>Log</td> <td>" << "<a href=\"" << fFileLinkPrefix << GetTest(i)->GetName().data() << ".log" << "\">" << GetTest(i)->GetName().data() << ".log</a>" << " </td> </tr>" << std::endl;
         file << "</table>" << std::endl;
@@ -310,6 +474,27 @@ void TestSuite::PrintResultsHTML(const std::string& filename)
             file << "</br>" << std::endl;
         }
 
+        // effective sample size per parameter
+        const std::vector<double>& ess = GetTest(i)->GetEffectiveSampleSize();
+        if (!ess.empty()) {
+            file << "<table border=\"0\" width=\"30%\">" << std::endl;
+            file << "<tr>";
+            file << "  <th align=\"left\">Parameter</th>" << std::endl;
+            file << "  <th align=\"left\">ESS</th>" << std::endl;
+            file << "  <th align=\"left\">ESS/s</th>" << std::endl;
+            file << "</tr>" << std::endl;
+            for (unsigned j = 0; j < ess.size(); ++j) {
+                file << " <tr> <td>" << j << "</td> <td>" << std::setprecision(4) << ess[j] << "</td> <td>";
+                if (GetTest(i)->GetRealTime() > 0)
+                    file << std::setprecision(4) << ess[j] / GetTest(i)->GetRealTime();
+                else
+                    file << "-";
+                file << " </td></tr>" << std::endl;
+            }
+            file << "</table>" << std::endl;
+            file << "</br>" << std::endl;
+        }
+
         // plots
         file << "<b>Plots</b>" << std::endl;
         int nplots = GetTest(i)->GetNCanvases();
@@ -40,10 +40,11 @@ double PolAsymm::LogLikelihood(const std::vector<double>& par)
     // loop over the data points
     for (unsigned i = 0 ; i < GetNDataPoints(); i++) {
         // get data point
-        std::vector<double>& x = GetDataSet()->GetDataPoint(i).GetValues();
+        BCDataSet::ConstRow x = GetDataSet()->GetDataPoint(i);
 
         // calculate the value of the function at this point
-        double y_func = FitFunction(&x[0], parRoot);
+        double x0 = x[0];
+        double y_func = FitFunction(&x0, parRoot);
 
         // Likelihood *= asymmetric Gaussian evaluated at y_func given
         // mode from the data point (x[1]) and standard deviation
@@ -26,11 +26,16 @@
 #include <TRandom3.h>
 #include <TString.h>
 
+#include <cmath>
+#include <limits>
+
 // ---------------------------------------------------------
 BCEfficiencyFitter::BCEfficiencyFitter(const TH1& trials, const TH1& successes, const TF1& func, const std::string& name)
     : BCFitter(func, name),
       fHistogramBinomial("hist_binomial", "", 1000, 0., 1.),
-      fDataPointType(kDataPointSmallestInterval)
+      fDataPointType(kDataPointSmallestInterval),
+      fLogBinomFactorSum(0),
+      fLogEfficiencies(1)
 {
     // check compatibility of both histograms : number of bins
     if (trials.GetNbinsX() != successes.GetNbinsX())
@@ -64,6 +69,15 @@ BCEfficiencyFitter::BCEfficiencyFitter(const TH1& trials, const TH1& successes,
     for (int i = 0; i < fTrials.GetNbinsX(); ++i)
         fFitterDataSet.AddDataPoint(BCDataPoint(2));
 
+    // cache the counts and the constant binomial factors for the likelihood
+    for (int i = 1; i <= fTrials.GetNbinsX(); ++i) {
+        const int n = int(fTrials.GetBinContent(i));
+        const int k = int(fSuccesses.GetBinContent(i));
+        fBinTrials.push_back(n);
+        fBinSuccesses.push_back(k);
+        fLogBinomFactorSum += BCMath::LogBinomFactor(n, k);
+    }
+
     // set the data boundaries for x and y values.
     GetDataSet()->SetBounds(0, fTrials.GetXaxis()->GetXmin(), fTrials.GetXaxis()->GetXmax());
     GetDataSet()->SetBounds(1, 0.0, 1.0);
@@ -72,6 +86,7 @@ BCEfficiencyFitter::BCEfficiencyFitter(const TH1& trials, const TH1& successes,
     SetFitFunctionIndices(0, 1);
 
     fFlagIntegration = false;
+    SetIntegrationBins(*fTrials.GetXaxis());
 
     // set MCMC for marginalization
     SetMarginalizationMethod(BCIntegrate::kMargMetropolis);
@@ -83,43 +98,54 @@ BCEfficiencyFitter::~BCEfficiencyFitter() {}
 // ---------------------------------------------------------
 double BCEfficiencyFitter::LogLikelihood(const std::vector<double>& params)
 {
-    TF1& f = GetFitFunction();
-
-    // initialize probability
-    double loglikelihood = 0;
-
-    // set the parameters of the function
-    // passing the pointer to first element of the vector is
-    // not completely safe as there might be an implementation where
-    // the vector elements are not stored consecutively in memory.
-    // however it is much faster than copying the contents, especially
-    // for large number of parameters
-    f.SetParameters(&params[0]);
-
-    // get the number of bins
-    int nbins = fTrials.GetNbinsX();
-
-    // loop over all bins
-    for (int ibin = 1; ibin <= nbins; ++ibin) {
-        // get n
-        int n = int(fTrials.GetBinContent(ibin));
-
-        // get k
-        int k = int(fSuccesses.GetBinContent(ibin));
-
-        // get bin edges
-        const double xmin = fTrials.GetXaxis()->GetBinLowEdge(ibin);
-        const double xmax = fTrials.GetXaxis()->GetBinUpEdge(ibin);
-
-        const double eff = Integral(params, xmin, xmax);
-
-        // get the value of the Binomial distribution
-        loglikelihood += BCMath::LogApproxBinomial(n, k, eff);
+    // the binomial factors don't depend on the parameters
+    double loglikelihood = fLogBinomFactorSum;
+
+    // integrate over all bins for the efficiencies
+    const std::vector<double>& efficiencies = IntegrateBins(params);
+
+    const unsigned nbins = fBinTrials.size();
+    if (nbins == 0)
+        return loglikelihood;
+    const double* eff = &efficiencies[0];
+    const double* trials = &fBinTrials[0];
+    const double* successes = &fBinSuccesses[0];
+
+    // efficiency out of range, checked in a separate pass to keep the loops below branch-free
+    double effmin = eff[0];
+    double effmax = eff[0];
+    for (unsigned i = 1; i < nbins; ++i) {
+        effmin = eff[i] < effmin ? eff[i] : effmin;
+        effmax = eff[i] > effmax ? eff[i] : effmax;
+    }
+    if (effmin < 0 or effmax > 1)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    // log(eff) and log(1 - eff) of all bins at once; terms that vanish
+    // take the log of one to avoid 0 * log(0)
+    std::vector<double>& logs = fLogEfficiencies.at(GetCurrentChain());
+    logs.resize(2 * nbins);
+    double* logeff = &logs[0];
+    double* log1meff = logeff + nbins;
+    for (unsigned i = 0; i < nbins; ++i) {
+        logeff[i] = successes[i] > 0 ? eff[i] : 1;
+        log1meff[i] = trials[i] > successes[i] ? 1 - eff[i] : 1;
     }
+    BCMath::Log(2 * nbins, logeff, logeff);
+
+    for (unsigned i = 0; i < nbins; ++i)
+        loglikelihood += successes[i] * logeff[i] + (trials[i] - successes[i]) * log1meff[i];
 
     return loglikelihood;
 }
 
+// ---------------------------------------------------------
+void BCEfficiencyFitter::MCMCUserInitialize()
+{
+    BCFitter::MCMCUserInitialize();
+    fLogEfficiencies.resize(fMCMCNChains);
+}
+
 // ---------------------------------------------------------
 void BCEfficiencyFitter::Fit()
 {
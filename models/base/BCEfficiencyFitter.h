@@ -91,12 +91,14 @@ public:
     /* @{ */
 
     /**
-     * @return The histogram with the number of trials */
+     * @return The histogram with the number of trials
+     * @note The likelihood uses the numbers cached at construction. */
     TH1& GetTrials()
     { return fTrials; };
 
     /**
-     * @return The histogram with the number of successes. */
+     * @return The histogram with the number of successes.
+     * @note The likelihood uses the numbers cached at construction. */
     TH1& GetSuccesses()
     { return fSuccesses; };
 
@@ -133,6 +135,10 @@ public:
      * @param parameters A vector of doubles containing the parameter values. */
     virtual double LogLikelihood(const std::vector<double>& parameters);
 
+    /**
+     * Create enough buffers for thread safety. Overloaded from BCFitter. */
+    virtual void MCMCUserInitialize();
+
     /**
      * Performs the fit.
      * @return Success of action. */
@@ -184,6 +190,22 @@ private:
 
     /** Type of point to plot for efficiency data */
     DataPointType fDataPointType;
+
+    /**
+     * Number of trials in each bin, cached for the likelihood. */
+    std::vector<double> fBinTrials;
+
+    /**
+     * Number of successes in each bin, cached for the likelihood. */
+    std::vector<double> fBinSuccesses;
+
+    /**
+     * Sum of the log binomial factors of all bins, the constant part of the likelihood. */
+    double fLogBinomFactorSum;
+
+    /**
+     * Logs of the efficiencies and their complements in all bins (one vector per chain). */
+    std::vector<std::vector<double> > fLogEfficiencies;
 };
 
 // ---------------------------------------------------------
@@ -15,26 +15,42 @@
 #include <BAT/BCDataSet.h>
 #include <BAT/BCH1D.h>
 #include <BAT/BCLog.h>
+#include <BAT/BCMath.h>
 #include <BAT/BCModel.h>
 
+#include <TAxis.h>
 #include <TF1.h>
 #include <TFile.h>
 #include <TGraph.h>
 #include <TH1D.h>
 #include <TH2D.h>
 
+#include <cmath>
 #include <stdexcept>
 
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
+
 // ---------------------------------------------------------
 BCFitter::BCFitter(const TF1& f, const std::string& name)
     : BCModel(name),
       fFitFunction(1, f),
+      fBinIntegrationPrepared(false),
+      fBinIntegrationValues(1),
+      fBinIntegrals(1),
+      fErrorBandNEntries(0),
+      fErrorBandSketch(false),
+      fErrorBandSketchCompression(50),
       fFlagFillErrorBand(true),
       fFitFunctionIndexX(-1),
       fFitFunctionIndexY(-1),
       fErrorBandContinuous(true),
       fErrorBandNbinsX(100),
       fErrorBandNbinsY(500),
+      fFlagIntegration(false),
+      fIntegrationOrder(0),
+      fIntegrationTolerance(-1),
       fErrorBandExtensionLowEdgeX(0),
       fErrorBandExtensionUpEdgeX(0),
       fErrorBandExtensionLowEdgeY(0),
@@ -76,6 +92,12 @@ void BCFitter::MCMCUserInitialize()
 {
     // add or remove copies
     fFitFunction.resize(fMCMCNChains, fFitFunction.front());
+
+    // prepare bin integration outside of the parallel region
+    if (!fBinIntegrationPrepared)
+        PrepareBinIntegration();
+    fBinIntegrationValues.resize(fMCMCNChains);
+    fBinIntegrals.resize(fMCMCNChains);
 }
 
 // ---------------------------------------------------------
@@ -126,6 +148,52 @@ void BCFitter::MarginalizePreprocess()
                 fErrorBandXY.SetBinContent(ix, iy, 0.);
     }
 
+    // discard counts of a previous run
+    PrepareErrorBand();
+}
+
+// ---------------------------------------------------------
+void BCFitter::MarginalizePostprocess()
+{
+    MergeErrorBand();
+}
+
+// ---------------------------------------------------------
+void BCFitter::Remarginalize(bool autorange)
+{
+    BCModel::Remarginalize(autorange);
+    MergeErrorBand();
+}
+
+// ---------------------------------------------------------
+void BCFitter::PrepareErrorBand()
+{
+    fErrorBandGridX.clear();
+    fErrorBandGridBinX.clear();
+
+    // evaluate at all bin centers ...
+    if (fErrorBandContinuous) {
+        for (int ix = 1; ix <= fErrorBandXY.GetNbinsX(); ++ix) {
+            fErrorBandGridX.push_back(fErrorBandXY.GetXaxis()->GetBinCenter(ix));
+            fErrorBandGridBinX.push_back(ix);
+        }
+    }
+    // ... or at the data point x-values
+    else {
+        for (unsigned i = 0; i < fErrorBandX.size(); ++i) {
+            fErrorBandGridX.push_back(fErrorBandX[i]);
+            fErrorBandGridBinX.push_back(fErrorBandXY.GetXaxis()->FindFixBin(fErrorBandX[i]));
+        }
+    }
+
+    // one buffer per chain so chains can be filled in parallel
+    const unsigned nbins = fErrorBandSketch ? 0 : (fErrorBandXY.GetNbinsX() + 2) * (fErrorBandXY.GetNbinsY() + 2);
+    const unsigned nsketches = fErrorBandSketch ? fErrorBandGridX.size() : 0;
+    fErrorBandGridY.assign(GetNChains(), std::vector<double>(fErrorBandGridX.size()));
+    fErrorBandCounts.assign(GetNChains(), std::vector<double>(nbins, 0.));
+    fErrorBandChainSketches.assign(GetNChains(), std::vector<BCQuantileSketch>(nsketches, BCQuantileSketch(fErrorBandSketchCompression)));
+    fErrorBandSketches.assign(nsketches, BCQuantileSketch(fErrorBandSketchCompression));
+    fErrorBandNEntries = 0;
 }
 
 // ---------------------------------------------------------
@@ -135,54 +203,80 @@ void BCFitter::FillErrorBand()
     if (fFitFunctionIndexX < 0)
         return;
 
-    // loop over all possible x values ...
-    if (fErrorBandContinuous) {
-        double x = 0;
-        for (unsigned ix = 1; ix <= fErrorBandNbinsX; ++ix) {
-            // calculate x
-            x = fErrorBandXY.GetXaxis()->GetBinCenter(ix);
-
-            // calculate y
-            std::vector<double> xvec;
-            xvec.push_back(x);
-
-            // loop over all chains
-            for (unsigned ichain = 0; ichain < GetNChains(); ++ichain) {
-                // calculate y
-                double y = FitFunction(xvec, Getx(ichain));
-
-                // fill histogram
-                fErrorBandXY.Fill(x, y);
-            }
-
-            xvec.clear();
+    // set up the accumulators if the number of chains or bins changed
+    const unsigned nbins = fErrorBandSketch ? 0 : (fErrorBandXY.GetNbinsX() + 2) * (fErrorBandXY.GetNbinsY() + 2);
+    if (fErrorBandCounts.size() != GetNChains() or fErrorBandCounts.front().size() != nbins
+            or fErrorBandChainSketches.front().size() != (fErrorBandSketch ? fErrorBandGridX.size() : 0))
+        PrepareErrorBand();
+
+    const TAxis* yaxis = fErrorBandXY.GetYaxis();
+    const int nx = fErrorBandXY.GetNbinsX() + 2;
+
+    // define threading scheme with openMP
+    unsigned chunk = 1;
+    (void) chunk;
+    unsigned ichain;
+    (void) ichain;
+
+    // loop over all chains
+    #pragma omp parallel for shared(chunk) private(ichain) schedule(static, chunk)
+    for (unsigned ichain = 0; ichain < fMCMCNChains; ++ichain) {
+        UpdateChainIndex(ichain);
+
+        // calculate y at all x values at once
+        std::vector<double>& y = fErrorBandGridY[ichain];
+        EvaluateFitFunction(Getx(ichain), fErrorBandGridX, y);
+
+        // add to the chain's own sketches ...
+        if (fErrorBandSketch) {
+            std::vector<BCQuantileSketch>& sketches = fErrorBandChainSketches[ichain];
+            for (unsigned i = 0; i < y.size(); ++i)
+                sketches[i].Add(y[i]);
+        }
+        // ... or count in the chain's own accumulator
+        else {
+            std::vector<double>& counts = fErrorBandCounts[ichain];
+            for (unsigned i = 0; i < y.size(); ++i)
+                counts[fErrorBandGridBinX[i] + nx * yaxis->FindFixBin(y[i])] += 1.;
         }
     }
-    // ... or evaluate at the data point x-values
-    else {
-        unsigned ndatapoints = fErrorBandX.size();
-        double x = 0;
-
-        for (unsigned ix = 0; ix < ndatapoints; ++ix) {
-            // calculate x
-            x = fErrorBandX.at(ix);
 
-            // calculate y
-            std::vector<double> xvec;
-            xvec.push_back(x);
+    fErrorBandNEntries += double(fMCMCNChains) * fErrorBandGridX.size();
+}
 
-            // loop over all chains
-            for (unsigned ichain = 0; ichain < GetNChains(); ++ichain) {
-                // calculate y
-                double y = FitFunction(xvec, Getx(ichain));
+// ---------------------------------------------------------
+void BCFitter::MergeErrorBand()
+{
+    if (fErrorBandNEntries == 0)
+        return;
 
-                // fill histogram
-                fErrorBandXY.Fill(x, y);
+    if (fErrorBandSketch) {
+        for (unsigned c = 0; c < fErrorBandChainSketches.size(); ++c)
+            for (unsigned i = 0; i < fErrorBandChainSketches[c].size(); ++i) {
+                fErrorBandSketches[i].Merge(fErrorBandChainSketches[c][i]);
+                fErrorBandChainSketches[c][i].Reset();
             }
+        fErrorBandNEntries = 0;
+        return;
+    }
 
-            xvec.clear();
+    TArrayD* sumw2 = fErrorBandXY.GetSumw2N() > 0 ? fErrorBandXY.GetSumw2() : NULL;
+
+    for (unsigned c = 0; c < fErrorBandCounts.size(); ++c) {
+        std::vector<double>& counts = fErrorBandCounts[c];
+        for (unsigned bin = 0; bin < counts.size(); ++bin) {
+            if (counts[bin] == 0)
+                continue;
+            // unit weights: sum of weights squared equals the counts
+            fErrorBandXY.AddBinContent(bin, counts[bin]);
+            if (sumw2)
+                (*sumw2)[bin] += counts[bin];
+            counts[bin] = 0;
         }
     }
+
+    fErrorBandXY.SetEntries(fErrorBandXY.GetEntries() + fErrorBandNEntries);
+    fErrorBandNEntries = 0;
 }
 
 // ---------------------------------------------------------
@@ -194,6 +288,19 @@ double BCFitter::FitFunction(const std::vector<double>& x, const std::vector<dou
     return f.Eval(x[0]);
 }
 
+// ---------------------------------------------------------
+void BCFitter::EvaluateFitFunction(const std::vector<double>& params, const std::vector<double>& x, std::vector<double>& y)
+{
+    // update parameters only once for all points
+    TF1& f = GetFitFunction();
+    f.SetParameters(&params[0]);
+
+    y.resize(x.size());
+    for (unsigned i = 0; i < x.size(); ++i)
+        y[i] = f.Eval(x[i]);
+}
+
+// ---------------------------------------------------------
 double BCFitter::Integral(const std::vector<double>& params, const double xmin, const double xmax)
 {
     TF1& f = GetFitFunction();
@@ -215,6 +322,120 @@ double BCFitter::Integral(const std::vector<double>& params, const double xmin,
     }
 }
 
+// ---------------------------------------------------------
+void BCFitter::SetIntegrationBins(const TAxis& axis)
+{
+    // store all bin edges, including the upper edge of the last bin
+    fBinIntegrationEdges.resize(axis.GetNbins() + 1);
+    for (int i = 0; i <= axis.GetNbins(); ++i)
+        fBinIntegrationEdges[i] = axis.GetBinLowEdge(i + 1);
+
+    fBinIntegrationPrepared = false;
+}
+
+// ---------------------------------------------------------
+void BCFitter::PrepareBinIntegration()
+{
+    fBinIntegrationNodes.clear();
+    fBinIntegrationWeights.clear();
+    fBinIntegrationPrepared = true;
+
+    const unsigned nbins = fBinIntegrationEdges.empty() ? 0 : fBinIntegrationEdges.size() - 1;
+
+    // linear interpolation needs the function at the bin edges only
+    if (!fFlagIntegration) {
+        fBinIntegrationNodes = fBinIntegrationEdges;
+        return;
+    }
+
+    // adaptive integration doesn't use nodes
+    if (fIntegrationOrder == 0)
+        return;
+
+    // the high-order rule, and the low-order rule for the error estimate
+    std::vector<unsigned> orders(1, fIntegrationOrder);
+    if (fIntegrationTolerance > 0 && fIntegrationOrder >= 2)
+        orders.push_back(fIntegrationOrder / 2);
+
+    for (unsigned k = 0; k < orders.size(); ++k) {
+        std::vector<double> t, w;
+        BCMath::GaussLegendre(orders[k], t, w);
+
+        // map nodes from [-1, 1] onto each bin
+        for (unsigned i = 0; i < nbins; ++i) {
+            const double center = 0.5 * (fBinIntegrationEdges[i + 1] + fBinIntegrationEdges[i]);
+            const double halfwidth = 0.5 * (fBinIntegrationEdges[i + 1] - fBinIntegrationEdges[i]);
+            for (unsigned j = 0; j < t.size(); ++j) {
+                fBinIntegrationNodes.push_back(center + halfwidth * t[j]);
+                fBinIntegrationWeights.push_back(halfwidth * w[j]);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------
+const std::vector<double>& BCFitter::IntegrateBins(const std::vector<double>& params)
+{
+    // only happens outside of the MCMC, see MCMCUserInitialize()
+    if (!fBinIntegrationPrepared)
+        PrepareBinIntegration();
+
+    const unsigned nbins = fBinIntegrationEdges.empty() ? 0 : fBinIntegrationEdges.size() - 1;
+    const std::vector<double>& edges = fBinIntegrationEdges;
+
+    std::vector<double>& integrals = fBinIntegrals.at(GetCurrentChain());
+    integrals.resize(nbins);
+    if (nbins == 0)
+        return integrals;
+
+    // use ROOT's adaptive integration for each bin
+    if (fFlagIntegration && fIntegrationOrder == 0) {
+        for (unsigned i = 0; i < nbins; ++i)
+            integrals[i] = Integral(params, edges[i], edges[i + 1]);
+        return integrals;
+    }
+
+    // evaluate the fit function at all nodes at once
+    std::vector<double>& y = fBinIntegrationValues.at(GetCurrentChain());
+    EvaluateFitFunction(params, fBinIntegrationNodes, y);
+
+    // use linear interpolation
+    if (!fFlagIntegration) {
+        for (unsigned i = 0; i < nbins; ++i)
+            integrals[i] = (y[i] + y[i + 1]) * (edges[i + 1] - edges[i]) / 2.;
+        return integrals;
+    }
+
+    // weighted sum over the nodes of each bin
+    const unsigned n = fIntegrationOrder;
+    const double* w = &fBinIntegrationWeights[0];
+    const double* f = &y[0];
+    for (unsigned i = 0; i < nbins; ++i) {
+        double sum = 0;
+        for (unsigned j = 0; j < n; ++j)
+            sum += w[i * n + j] * f[i * n + j];
+        integrals[i] = sum;
+    }
+
+    // no error control requested
+    if (fBinIntegrationNodes.size() == nbins * n)
+        return integrals;
+
+    // compare to the low-order rule and integrate adaptively where they disagree
+    const unsigned m = n / 2;
+    w += nbins * n;
+    f += nbins * n;
+    for (unsigned i = 0; i < nbins; ++i) {
+        double sum = 0;
+        for (unsigned j = 0; j < m; ++j)
+            sum += w[i * m + j] * f[i * m + j];
+        if (fabs(sum - integrals[i]) > fIntegrationTolerance * fabs(integrals[i]))
+            integrals[i] = Integral(params, edges[i], edges[i + 1]);
+    }
+
+    return integrals;
+}
+
 // ---------------------------------------------------------
 void BCFitter::PrintShortFitSummary()
 {
@@ -231,6 +452,13 @@ std::vector<double> BCFitter::GetErrorBand(double level) const
 {
     std::vector<double> errorband;
 
+    // read off quantiles directly
+    if (fErrorBandSketch) {
+        for (unsigned i = 0; i < fErrorBandSketches.size(); ++i)
+            errorband.push_back(fErrorBandSketches[i].GetQuantile(level));
+        return errorband;
+    }
+
     int nx = fErrorBandXY.GetNbinsX();
     errorband.assign(nx, 0.);
 
@@ -255,20 +483,25 @@ std::vector<double> BCFitter::GetErrorBand(double level) const
 // ---------------------------------------------------------
 TGraph* BCFitter::GetErrorBandGraph(double level1, double level2) const
 {
+    // get error bands
+    std::vector<double> ymin = GetErrorBand(level1);
+    std::vector<double> ymax = GetErrorBand(level2);
+
     // define new graph
-    int nx = fErrorBandXY.GetNbinsX();
+    int nx = ymin.size();
 
     TGraph* graph = new TGraph(2 * nx);
     graph->SetFillStyle(1001);
     graph->SetFillColor(kYellow);
 
-    // get error bands
-    std::vector<double> ymin = GetErrorBand(level1);
-    std::vector<double> ymax = GetErrorBand(level2);
+    // the sketches are kept at the x values of the error band
+    std::vector<double> x(nx);
+    for (int i = 0; i < nx; i++)
+        x[i] = fErrorBandSketch ? fErrorBandGridX[i] : fErrorBandXY.GetXaxis()->GetBinCenter(i + 1);
 
     for (int i = 0; i < nx; i++) {
-        graph->SetPoint(i, fErrorBandXY.GetXaxis()->GetBinCenter(i + 1), ymin[i]);
-        graph->SetPoint(nx + i, fErrorBandXY.GetXaxis()->GetBinCenter(nx - i), ymax[nx - i - 1]);
+        graph->SetPoint(i, x[i], ymin[i]);
+        graph->SetPoint(nx + i, x[nx - i - 1], ymax[nx - i - 1]);
     }
 
     return graph;
@@ -285,6 +518,23 @@ TH2* BCFitter::GetGraphicalErrorBandXY(double level, int nsmooth, bool overcover
     hist_tempxy->Reset();
     hist_tempxy->SetFillColor(kYellow);
 
+    // mark the smallest interval from each sketch; no smoothing needed
+    if (fErrorBandSketch) {
+        const TAxis* yaxis = fErrorBandXY.GetYaxis();
+        for (unsigned i = 0; i < fErrorBandSketches.size(); ++i) {
+            std::pair<double, double> bound = fErrorBandSketches[i].GetSmallestInterval(level);
+            for (int iy = 1; iy <= ny; ++iy) {
+                // include bins overlapping with the interval, or only bins with their center inside
+                const bool inside = overcoverage ?
+                                    (yaxis->GetBinUpEdge(iy) > bound.first and yaxis->GetBinLowEdge(iy) < bound.second) :
+                                    (yaxis->GetBinCenter(iy) >= bound.first and yaxis->GetBinCenter(iy) <= bound.second);
+                if (inside)
+                    hist_tempxy->SetBinContent(fErrorBandGridBinX[i], iy, 1);
+            }
+        }
+        return hist_tempxy;
+    }
+
     // loop over x bins
     for (int ix = 1; ix < nx; ix++) {
         BCH1D hist_temp(fErrorBandXY.ProjectionY("temphist", ix, ix));
@@ -20,11 +20,16 @@
 #include "../../BAT/BCAux.h"
 #include "../../BAT/BCDataSet.h"
 #include "../../BAT/BCModel.h"
+#include "../../BAT/BCQuantileSketch.h"
 
 #include <TF1.h>
 #include <TH2D.h>
 
 #include <string>
+#include <vector>
+
+// ROOT classes
+class TAxis;
 
 // ---------------------------------------------------------
 
@@ -76,6 +81,14 @@ public:
      * @return vector of y-values */
     std::vector<double> GetErrorBand(double level) const;
 
+    /**
+     * @return The quantile sketches of the fit function at each x value of the error band,
+     * if enabled with SetErrorBandQuantileSketch(). */
+    const std::vector<BCQuantileSketch>& GetErrorBandQuantileSketches() const
+    {
+        return fErrorBandSketches;
+    }
+
     TGraph* GetErrorBandGraph(double level1, double level2) const;
 
     TGraph* GetFitFunctionGraph(const std::vector<double>& parameters);
@@ -132,6 +145,20 @@ public:
     {
         fErrorBandExtensionUpEdgeY = extension;
     }
+    /**
+     * Use a streaming quantile sketch for each x value of the error band
+     * instead of the error band histogram. Arbitrary quantiles are then
+     * available without binning in y, with much less memory. The
+     * error band histogram only defines the x values and the binning
+     * of GetGraphicalErrorBandXY(), and stays empty.
+     * @param flag set to true to use the quantile sketches
+     * @param compression Accuracy parameter of the sketches, see BCQuantileSketch. */
+    void SetErrorBandQuantileSketch(bool flag = true, double compression = 50)
+    {
+        fErrorBandSketch = flag;
+        fErrorBandSketchCompression = compression;
+    }
+
     /**
      * Turn on or off the filling of the error band during the MCMC run.
      * @param flag set to true for turning on the filling */
@@ -176,13 +203,38 @@ public:
 
     /**
      * Sets the flag for integration. \n
-     * true: use ROOT's TF1::Integrate() \n
+     * true: integrate the fit function over each bin, see SetIntegrationOrder() \n
      * false: use linear interpolation */
     void SetFlagIntegration(bool flag)
     {
         fFlagIntegration = flag;
+        fBinIntegrationPrepared = false;
     };
 
+    /**
+     * Set the order of the fixed Gauss-Legendre rule used to integrate
+     * the fit function over bins if integration is turned on. The fixed
+     * rule is much faster but unchecked unless SetIntegrationTolerance()
+     * is used; it is not accurate for functions peaked within a bin.
+     * @param order Number of nodes per bin; 0 (default) to use ROOT's adaptive TF1::Integral(). */
+    void SetIntegrationOrder(unsigned order)
+    {
+        fIntegrationOrder = order;
+        fBinIntegrationPrepared = false;
+    }
+
+    /**
+     * Set the relative tolerance for the error-controlled fallback of the bin integration.
+     * Each bin is additionally integrated with a rule of half the order,
+     * and bins in which both results differ by more than the tolerance
+     * are integrated with ROOT's adaptive TF1::Integral().
+     * @param tolerance Relative tolerance; a non-positive value disables the fallback. */
+    void SetIntegrationTolerance(double tolerance)
+    {
+        fIntegrationTolerance = tolerance;
+        fBinIntegrationPrepared = false;
+    }
+
     /**
      * Defines a fit function.
      * @param parameters A set of parameter values
@@ -190,6 +242,15 @@ public:
      * @return The value of the fit function at the x-values given a set of parameters */
     virtual double FitFunction(const std::vector<double>& x, const std::vector<double>& parameters);
 
+    /**
+     * Evaluates the fit function at many points at once. The
+     * parameters are set only once for all points.  Overload this
+     * method together with FitFunction(), if the latter is overloaded.
+     * @param parameters A set of parameter values
+     * @param x The x-values
+     * @param y Filled with the values of the fit function at the x-values */
+    virtual void EvaluateFitFunction(const std::vector<double>& parameters, const std::vector<double>& x, std::vector<double>& y);
+
     /**
      * Compute the integral of the fit function between xmin and xmax.
      *
@@ -198,6 +259,16 @@ public:
      */
     double Integral(const std::vector<double>& parameters, double xmin, double xmax);
 
+    /**
+     * Compute the integrals of the fit function over all bins set with SetIntegrationBins().
+     * With integration turned on and a nonzero integration order, the
+     * fit function is evaluated once at the precomputed Gauss-Legendre
+     * nodes of all bins. Else the result is the same as calling
+     * Integral() for each bin.
+     * @param parameters A set of parameter values
+     * @return The integrals over each bin; valid until the next call in the same chain. */
+    const std::vector<double>& IntegrateBins(const std::vector<double>& parameters);
+
 
     /* @} */
     /** \name Member functions (miscellaneous methods) */
@@ -219,9 +290,25 @@ public:
     virtual void MarginalizePreprocess();
 
     /**
-     * Fill error band histogram for current iteration. This method is called from MCMCUserIterationInterface() */
+     * Overloaded from BCIntegrate. Merges the error band of all chains. */
+    virtual void MarginalizePostprocess();
+
+    /**
+     * Overloaded from BCEngineMCMC. Merges the error band of all chains. */
+    virtual void Remarginalize(bool autorange = true);
+
+    /**
+     * Fill error band for current iteration. This method is called from MCMCUserIterationInterface().
+     * The chains are evaluated in parallel and counted in separate
+     * accumulators, which are merged into the error band histogram or
+     * quantile sketches by MergeErrorBand(). */
     void FillErrorBand();
 
+    /**
+     * Add the values accumulated by FillErrorBand() to the error band histogram or quantile sketches.
+     * This method is called automatically at the end of the marginalization. */
+    void MergeErrorBand();
+
     /**
      * Prints a short summary of the fit results on the screen. */
     void PrintShortFitSummary();
@@ -236,6 +323,60 @@ private:
     /** Fit function (as vector for thread safety) */
     std::vector<TF1> fFitFunction;
 
+    /**
+     * Precompute the nodes and weights for integrating over the bins. */
+    void PrepareBinIntegration();
+
+    /** Flag whether the integration nodes are up to date. */
+    bool fBinIntegrationPrepared;
+
+    /** Edges of the bins to integrate over. */
+    std::vector<double> fBinIntegrationEdges;
+
+    /** Integration nodes of all bins, stored consecutively per bin.
+     * If the fallback is enabled, the nodes of the low-order rule follow after those of all bins. */
+    std::vector<double> fBinIntegrationNodes;
+
+    /** Integration weights matching fBinIntegrationNodes, including the bin half width. */
+    std::vector<double> fBinIntegrationWeights;
+
+    /** Function values at the integration nodes (one vector per chain). */
+    std::vector<std::vector<double> > fBinIntegrationValues;
+
+    /** Integrals over all bins (one vector per chain). */
+    std::vector<std::vector<double> > fBinIntegrals;
+
+    /**
+     * Set up the x values and the accumulators for filling the error band. */
+    void PrepareErrorBand();
+
+    /** x values at which the error band is evaluated. */
+    std::vector<double> fErrorBandGridX;
+
+    /** Bin index in x of the error band histogram for each x value. */
+    std::vector<int> fErrorBandGridBinX;
+
+    /** Fit function values at the x values (one vector per chain). */
+    std::vector<std::vector<double> > fErrorBandGridY;
+
+    /** Error band counts not yet merged into the histogram, indexed by global bin (one vector per chain). */
+    std::vector<std::vector<double> > fErrorBandCounts;
+
+    /** Number of entries not yet merged into the histogram; a double like the entries of a TH1, so it can't overflow. */
+    double fErrorBandNEntries;
+
+    /** Flag for using quantile sketches instead of the error band histogram. */
+    bool fErrorBandSketch;
+
+    /** Compression parameter of the quantile sketches. */
+    double fErrorBandSketchCompression;
+
+    /** Quantile sketches not yet merged, one per x value (one vector per chain). */
+    std::vector<std::vector<BCQuantileSketch> > fErrorBandChainSketches;
+
+    /** Quantile sketches of all chains, one per x value. */
+    std::vector<BCQuantileSketch> fErrorBandSketches;
+
 protected:
     /**
      * Copy over the most important properties of a 1D histogram.
@@ -244,6 +385,11 @@ protected:
      */
     static void CopyHist(const TH1& source, TH1D& destination);
 
+    /**
+     * Set the bins to integrate over in IntegrateBins().
+     * @param axis The axis defining the bins. */
+    void SetIntegrationBins(const TAxis& axis);
+
     /**
      * Flag whether or not to fill the error band */
     bool fFlagFillErrorBand;
@@ -278,10 +424,18 @@ protected:
     BCDataSet fFitterDataSet;
 
     /**
-     * Flag for using the ROOT TH1::Integral method (true), or linear
+     * Flag for integrating the fit function over bins (true), or linear
      * interpolation (false) */
     bool fFlagIntegration;
 
+    /**
+     * Order of the Gauss-Legendre rule for bin integration; 0 for ROOT's TF1::Integral() */
+    unsigned fIntegrationOrder;
+
+    /**
+     * Relative tolerance for falling back to TF1::Integral(); disabled if non-positive */
+    double fIntegrationTolerance;
+
     /** Storage for plot objects with proper clean-up */
     mutable BCAux::BCTrash<TObject> fObjectTrash;
 
@@ -0,0 +1,171 @@
+#ifndef __BCFUNCTORFITTER__H
+#define __BCFUNCTORFITTER__H
+
+/*!
+ * \class BCFunctorFitter
+ * \brief A fitter evaluating a compiled function object instead of a TF1
+ * \detail BCFunctorFitter derives from one of the fitters,
+ * e.g. BCHistogramFitter, BCGraphFitter or BCEfficiencyFitter, and
+ * replaces the evaluation of the TF1 in the likelihood by direct calls
+ * of a function object. The type of the function object is a template
+ * parameter, so the calls can be inlined and the loops over the data
+ * points vectorized by the compiler. The function object is called as
+ *
+ *     double f(double x, const double* parameters) const
+ *
+ * from several chains at once, so it must not modify any state.
+ *
+ * The fitter still needs a TF1 for the names and ranges of the
+ * parameters and for adaptive integration and drawing. Use
+ * BCFunctorTF1Adapter to build it from the same function object, so
+ * the likelihood, error band and plots all use the same function:
+ *
+ *     MyFunction f;
+ *     TF1 tf1("f", BCFunctorTF1Adapter<MyFunction>(f), xmin, xmax, npar);
+ *     BCFunctorFitter<BCHistogramFitter, MyFunction> fitter(hist, tf1, f);
+ */
+
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include "BCFitter.h"
+
+#include <string>
+#include <vector>
+
+// ROOT classes
+class TF1;
+
+// ---------------------------------------------------------
+
+/**
+ * Wrap a function object f(x, parameters) in the signature ROOT
+ * expects for constructing a TF1 from a function object. */
+template <class Function>
+class BCFunctorTF1Adapter
+{
+public:
+
+    /**
+     * Constructor
+     * @param f The function object; copied. */
+    BCFunctorTF1Adapter(const Function& f)
+        : fFunction(f)
+    {}
+
+    /**
+     * Evaluate the function object.
+     * @param x The x value
+     * @param parameters The parameter values
+     * @return The function value */
+    double operator()(double* x, double* parameters) const
+    { return fFunction(x[0], parameters); }
+
+private:
+
+    /** The function object. */
+    Function fFunction;
+};
+
+// ---------------------------------------------------------
+
+template <class Fitter, class Function>
+class BCFunctorFitter : public Fitter
+{
+public:
+
+    /** \name Constructors and destructors */
+    /* @{ */
+
+    /**
+     * Constructor for fitters of a single data object, e.g. BCHistogramFitter and BCGraphFitter.
+     * @param data The data passed on to the fitter
+     * @param tf1 TF1 defining the parameters, used for integration and drawing
+     * @param f The function object evaluated in the likelihood; copied.
+     * @param name name of the model */
+    template <class Data>
+    BCFunctorFitter(const Data& data, const TF1& tf1, const Function& f, const std::string& name = "functor_fitter_model")
+        : Fitter(data, tf1, name),
+          fFunction(f)
+    {}
+
+    /**
+     * Constructor for fitters of two data objects, e.g. BCEfficiencyFitter.
+     * @param data1 The first data object passed on to the fitter
+     * @param data2 The second data object passed on to the fitter
+     * @param tf1 TF1 defining the parameters, used for integration and drawing
+     * @param f The function object evaluated in the likelihood; copied.
+     * @param name name of the model */
+    template <class Data1, class Data2>
+    BCFunctorFitter(const Data1& data1, const Data2& data2, const TF1& tf1, const Function& f, const std::string& name = "functor_fitter_model")
+        : Fitter(data1, data2, tf1, name),
+          fFunction(f)
+    {}
+
+    /**
+     * The default destructor. */
+    virtual ~BCFunctorFitter()
+    {}
+
+    /* @} */
+
+    /** \name Member functions (get) */
+    /* @{ */
+
+    /**
+     * @return The function object */
+    const Function& GetFunction() const
+    { return fFunction; }
+
+    /* @} */
+
+    /** \name Member functions (miscellaneous methods) */
+    /* @{ */
+
+    /**
+     * Evaluate the function object. Overloaded from BCFitter.
+     * @param x A vector of x-values
+     * @param parameters A set of parameter values
+     * @return The value of the function at the x-value */
+    virtual double FitFunction(const std::vector<double>& x, const std::vector<double>& parameters)
+    { return fFunction(x[0], &parameters[0]); }
+
+    /**
+     * Evaluate the function object at many points in one loop. Overloaded from BCFitter.
+     * @param parameters A set of parameter values
+     * @param x The x-values
+     * @param y Filled with the values of the function at the x-values */
+    virtual void EvaluateFitFunction(const std::vector<double>& parameters, const std::vector<double>& x, std::vector<double>& y)
+    {
+        y.resize(x.size());
+        if (x.empty())
+            return;
+
+        // plain pointers and a local reference let the compiler inline and vectorize
+        const Function& f = fFunction;
+        const double* p = &parameters[0];
+        const double* xx = &x[0];
+        double* yy = &y[0];
+        const unsigned n = x.size();
+        for (unsigned i = 0; i < n; ++i)
+            yy[i] = f(xx[i], p);
+    }
+
+    /* @} */
+
+private:
+
+    /** The function object. */
+    Function fFunction;
+};
+
+// ---------------------------------------------------------
+
+#endif
@@ -28,10 +28,14 @@
 #include <TPad.h>
 #include <TString.h>
 
+#include <cmath>
+
 // ---------------------------------------------------------
 BCGraphFitter::BCGraphFitter(const TGraphErrors& graph, const TF1& func, const std::string& name)
     : BCFitter(func, name),
-      fGraph(graph)
+      fGraph(graph),
+      fLogNormalization(0),
+      fFunctionValues(1)
 {
     // why not just one point?
     if (fGraph.GetN() <= 1) {
@@ -56,6 +60,14 @@ BCGraphFitter::BCGraphFitter(const TGraphErrors& graph, const TF1& func, const s
         GetDataSet()->Back()[2] = ex ? ex[i] : 0;
         GetDataSet()->Back()[3] = ey[i];
     }
+    // keep contiguous copies for the likelihood
+    fDataX.assign(x, x + fGraph.GetN());
+    fDataY.assign(y, y + fGraph.GetN());
+    for (int i = 0; i < fGraph.GetN(); ++i) {
+        fDataErrorY.push_back(ey[i]);
+        fLogNormalization -= log(ey[i] * sqrt(2 * M_PI));
+    }
+
     // adjust bounds for 1 sigma of the uncertainties
     GetDataSet()->AdjustBoundForUncertainties(0, 1, 2); // x +- 1*errx
     GetDataSet()->AdjustBoundForUncertainties(1, 1, 3); // y +- 1*erry
@@ -72,29 +84,76 @@ BCGraphFitter::~BCGraphFitter() {}
 // ---------------------------------------------------------
 double BCGraphFitter::LogLikelihood(const std::vector<double>& params)
 {
-    TF1& f = GetFitFunction();
-
-    // set the parameters of the function
-    // passing the pointer to first element of the vector is
-    // not completely safe as there might be an implementation where
-    // the vector elements are not stored consecutively in memory.
-    // however it is much faster than copying the contents, especially
-    // for large number of parameters
-    f.SetParameters(&params[0]);
-
-    // initialize probability
-    double logl = 0.;
-
-    // loop over all data points
-    for (unsigned i = 0; i < GetNDataPoints(); i++)
-        // calculate log of probability assuming
-        // a Gaussian distribution for each point
-        logl += BCMath::LogGaus(GetDataSet()->GetDataPoint(i)[1], // y value of point
-                                f.Eval(GetDataSet()->GetDataPoint(i)[0]), // f(x value of point)
-                                GetDataSet()->GetDataPoint(i)[3], // uncertainty on y value of point
-                                true); // include normalization factor
-
-    return logl;
+    // product of Gaussians for all data points
+    return fLogNormalization - 0.5 * SumSquaredResiduals(params);
+}
+
+// ---------------------------------------------------------
+void BCGraphFitter::MCMCUserInitialize()
+{
+    BCFitter::MCMCUserInitialize();
+    fFunctionValues.resize(fMCMCNChains);
+}
+
+// ---------------------------------------------------------
+unsigned BCGraphFitter::CompactData()
+{
+    // group identical (x, y, sigma_y)
+    BCDataSet points;
+    BCDataPoint point(3);
+    for (int i = 0; i < fGraph.GetN(); ++i) {
+        point[0] = fGraph.GetX()[i];
+        point[1] = fGraph.GetY()[i];
+        point[2] = fGraph.GetEY()[i];
+        points.AddDataPoint(point);
+    }
+    const unsigned n = points.Compact();
+
+    fDataX.assign(points.GetColumn(0), points.GetColumn(0) + n);
+    fDataY.assign(points.GetColumn(1), points.GetColumn(1) + n);
+    fDataErrorY.assign(points.GetColumn(2), points.GetColumn(2) + n);
+    fDataWeight.assign(points.GetWeights(), points.GetWeights() + n);
+    fLogNormalization = 0;
+    for (unsigned i = 0; i < n; ++i)
+        fLogNormalization -= fDataWeight[i] * log(fDataErrorY[i] * sqrt(2 * M_PI));
+
+    return n;
+}
+
+// ---------------------------------------------------------
+double BCGraphFitter::SumSquaredResiduals(const std::vector<double>& pars)
+{
+    // evaluate the fit function at all x values at once
+    std::vector<double>& f = fFunctionValues.at(GetCurrentChain());
+    EvaluateFitFunction(pars, fDataX, f);
+
+    const unsigned n = fDataX.size();
+    if (n == 0)
+        return 0;
+
+    // -2 times the sum of the unnormalized Gaussian log densities
+    if (fDataWeight.empty())
+        return -2 * BCMath::SumLogGaus(n, &fDataY[0], &f[0], &fDataErrorY[0]);
+
+    // weighted points after CompactData()
+    const double* y = &fDataY[0];
+    const double* s = &fDataErrorY[0];
+    const double* m = &fDataWeight[0];
+
+    // independent partial sums so the loop can be vectorized
+    double sum[4] = { 0, 0, 0, 0 };
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (unsigned j = 0; j < 4; ++j) {
+            const double chi = (y[i + j] - f[i + j]) / s[i + j];
+            sum[j] += m[i + j] * chi * chi;
+        }
+    for (; i < n; ++i) {
+        const double chi = (y[i] - f[i]) / s[i];
+        sum[0] += m[i] * chi * chi;
+    }
+
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
 }
 
 // ---------------------------------------------------------
@@ -168,18 +227,7 @@ void BCGraphFitter::DrawFit(const std::string& options, bool flaglegend)
 // ---------------------------------------------------------
 double BCGraphFitter::CalculateChi2(const std::vector<double>& pars)
 {
-    TF1& f = GetFitFunction();
-
-    // set pars into fit function
-    f.SetParameters(&pars[0]);
-
-    double chi, chi2 = 0;
-    for (unsigned i = 0; i < GetDataSet()->GetNDataPoints(); ++i) {
-        chi = (GetDataSet()->GetDataPoint(i)[1] - f.Eval(GetDataSet()->GetDataPoint(i)[0])) / GetDataSet()->GetDataPoint(i)[3];
-        chi2 += chi * chi;
-    }
-
-    return chi2;
+    return SumSquaredResiduals(pars);
 }
 
 // ---------------------------------------------------------
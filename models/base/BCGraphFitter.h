@@ -92,13 +92,54 @@ public:
      * @return p value if successful, negative is unsuccessful. */
     virtual double CalculatePValue(const std::vector<double>& pars, bool ndf = true);
 
+    /**
+     * Create enough buffers for thread safety. Overloaded from BCFitter. */
+    virtual void MCMCUserInitialize();
+
+    /**
+     * Evaluate the likelihood only once for identical points of the
+     * graph, weighted by their multiplicity. The likelihood and chi^2
+     * don't change; the data set and the number of degrees of freedom
+     * still count all points.
+     * @return The number of distinct points. */
+    unsigned CompactData();
+
     /* @} */
 
 private:
 
+    /**
+     * Calculate the sum of squared normalized residuals from the cached data.
+     * @param pars Parameter set to evaluate function values with. */
+    double SumSquaredResiduals(const std::vector<double>& pars);
+
     /**
      * The graph containing the data. */
     TGraphErrors fGraph;
+
+    /**
+     * The x values of the data points. */
+    std::vector<double> fDataX;
+
+    /**
+     * The y values of the data points. */
+    std::vector<double> fDataY;
+
+    /**
+     * The uncertainties on the y values. */
+    std::vector<double> fDataErrorY;
+
+    /**
+     * The multiplicities of the data points; empty if all are one. */
+    std::vector<double> fDataWeight;
+
+    /**
+     * Sum of -log(sigma_y * sqrt(2 pi)) of all data points, the constant part of the likelihood. */
+    double fLogNormalization;
+
+    /**
+     * Fit function values at the x values (one vector per chain). */
+    std::vector<std::vector<double> > fFunctionValues;
 };
 
 // ---------------------------------------------------------
@@ -63,6 +63,7 @@ BCHistogramFitter::BCHistogramFitter(const TH1& hist, const TF1& func, const std
     SetNIterationsRun(2000);
     SetFillErrorBand(true);
     fFlagIntegration = true;
+    SetIntegrationBins(*fHistogram.GetXaxis());
 
     // set MCMC for marginalization
     SetMarginalizationMethod(BCIntegrate::kMargMetropolis);
@@ -74,27 +75,14 @@ BCHistogramFitter::~BCHistogramFitter() {}
 // ---------------------------------------------------------
 double BCHistogramFitter::LogLikelihood(const std::vector<double>& params)
 {
-    // initialize probability
-    double loglikelihood = 0;
+    // integrate over all bins for expectation
+    const std::vector<double>& expected = IntegrateBins(params);
 
-    // get the number of bins
-    int nbins = fHistogram.GetNbinsX();
+    // observed numbers of events, skipping the underflow bin
+    const double* observed = fHistogram.GetArray() + 1;
 
-    // loop over all bins
-    for (int ibin = 1; ibin <= nbins; ++ibin) {
-        // get bin edges and integrate for expectation
-        const double xmin = fHistogram.GetXaxis()->GetBinLowEdge(ibin);
-        const double xmax = fHistogram.GetXaxis()->GetBinUpEdge(ibin);
-        double yexp = Integral(params, xmin, xmax);
-
-        // get the number of observed events
-        double y = fHistogram.GetBinContent(ibin);
-
-        // get the value of the Poisson distribution
-        loglikelihood += BCMath::LogPoisson(y, yexp);
-    }
-
-    return loglikelihood;
+    // sum of the Poisson terms of all bins
+    return BCMath::SumLogPoisson(fHistogram.GetNbinsX(), observed, &expected[0]);
 }
 
 // ---------------------------------------------------------
@@ -175,12 +163,10 @@ bool BCHistogramFitter::CalculatePValueFast(const std::vector<double>& pars, uns
 
     // copy observed and expected values
     std::vector<unsigned> observed(fHistogram.GetNbinsX());
-    std::vector<double> expected(observed.size());
+    std::vector<double> expected = IntegrateBins(pars);
 
-    for (int ibin = 0 ; ibin < fHistogram.GetNbinsX(); ++ibin) {
+    for (int ibin = 0 ; ibin < fHistogram.GetNbinsX(); ++ibin)
         observed[ibin] = (unsigned int) fHistogram.GetBinContent(ibin + 1);
-        expected[ibin] = Integral(pars, fHistogram.GetBinLowEdge(ibin + 1), fHistogram.GetBinLowEdge(ibin + 2));
-    }
 
     // create pseudo experiments
     fPValue = BCMath::FastPValue(observed, expected, nIterations, fRandom.GetSeed());
@@ -198,13 +184,15 @@ bool BCHistogramFitter::CalculatePValueLikelihood(const std::vector<double>& par
     // initialize test statistic -2*lambda
     double logLambda = 0.0;
 
+    // get the number of expected events
+    const std::vector<double>& expected = IntegrateBins(pars);
+
     for (int ibin = 1; ibin <= fHistogram.GetNbinsX(); ++ibin) {
 
         // get the number of observed events
         const double y = fHistogram.GetBinContent(ibin);
 
-        // get the number of expected events
-        const double yexp = Integral(pars, fHistogram.GetBinLowEdge(ibin), fHistogram.GetBinLowEdge(ibin + 1));
+        const double yexp = expected[ibin - 1];
 
         // get the contribution from this datapoint
         if (y == 0)
@@ -230,13 +218,15 @@ bool BCHistogramFitter::CalculatePValueLeastSquares(const std::vector<double>& p
     // initialize test statistic chi^2
     double chi2 = 0.0;
 
+    // get the number of expected events
+    const std::vector<double>& expected = IntegrateBins(pars);
+
     for (int ibin = 1; ibin <= fHistogram.GetNbinsX(); ++ibin) {
 
         // get the number of observed events
         double y = fHistogram.GetBinContent(ibin);
 
-        // get the number of expected events
-        const double yexp = Integral(pars, fHistogram.GetBinLowEdge(ibin), fHistogram.GetBinLowEdge(ibin + 1));
+        const double yexp = expected[ibin - 1];
 
         //convert 1/0.0 into 1 for weighted sum
         double weight;
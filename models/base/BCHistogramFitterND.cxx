@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include <config.h>
+
+#include "BCHistogramFitterND.h"
+
+#include <BAT/BCDataPoint.h>
+#include <BAT/BCLog.h>
+#include <BAT/BCMath.h>
+
+#include <TAxis.h>
+#include <TF1.h>
+#include <TH1.h>
+#include <TMath.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
+
+// ---------------------------------------------------------
+BCHistogramFitterND::BCHistogramFitterND(const TH1& hist, const TF1& func, const std::string& name)
+    : BCModel(name),
+      fHistogram(0),
+      fDimension(hist.GetDimension()),
+      fIntegrationOrder(2),
+      fExpectations(1),
+      fFlagFillErrorBand(false),
+      fPValue(-1),
+      fPValueNDoF(-1)
+{
+    if (fDimension != 2 and fDimension != 3)
+        throw std::invalid_argument("BCHistogramFitterND: Only 2D and 3D histograms supported");
+    if (func.GetNdim() != int(fDimension))
+        throw std::invalid_argument("BCHistogramFitterND: Dimensions of histogram and function don't match");
+
+    fHistogram = static_cast<TH1*>(hist.Clone());
+    fHistogram->SetDirectory(0);
+
+    fFunctions.push_back(static_cast<TF1*>(func.Clone()));
+
+    // fill parameter set
+    for (int i = 0; i < func.GetNpar(); ++i) {
+        double xmin;
+        double xmax;
+        func.GetParLimits(i, xmin, xmax);
+        AddParameter(func.GetParName(i), xmin, xmax);
+    }
+
+    // by default set all priors constant
+    fParameters.SetPriorConstantAll();
+
+    // collect all bins in range and create one data point per bin with
+    // the bin center and the bin content
+    const TAxis* axes[3] = { hist.GetXaxis(), hist.GetYaxis(), hist.GetZaxis() };
+    for (int iz = 1; iz <= (fDimension > 2 ? axes[2]->GetNbins() : 1); ++iz)
+        for (int iy = 1; iy <= axes[1]->GetNbins(); ++iy)
+            for (int ix = 1; ix <= axes[0]->GetNbins(); ++ix) {
+                const int bin = hist.GetBin(ix, iy, iz);
+                const int index[3] = { ix, iy, iz };
+                fBins.push_back(bin);
+                fCounts.push_back(hist.GetBinContent(bin));
+
+                fFitterDataSet.AddDataPoint(BCDataPoint(fDimension + 1));
+                for (unsigned d = 0; d < fDimension; ++d)
+                    fFitterDataSet.Back()[d] = axes[d]->GetBinCenter(index[d]);
+                fFitterDataSet.Back()[fDimension] = fCounts.back();
+            }
+    SetDataSet(&fFitterDataSet);
+
+    // function copies for evaluating bins in parallel outside of the MCMC
+#if THREAD_PARALLELIZATION
+    ResizeFunctions(omp_get_max_threads());
+#endif
+
+    PrepareNodes();
+
+    SetNIterationsRun(2000);
+
+    // set MCMC for marginalization
+    SetMarginalizationMethod(BCIntegrate::kMargMetropolis);
+}
+
+// ---------------------------------------------------------
+BCHistogramFitterND::~BCHistogramFitterND()
+{
+    for (unsigned i = 0; i < fFunctions.size(); ++i)
+        delete fFunctions[i];
+    delete fHistogram;
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::ResizeFunctions(unsigned n)
+{
+    while (fFunctions.size() < n)
+        fFunctions.push_back(static_cast<TF1*>(fFunctions.front()->Clone()));
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::SetIntegrationOrder(unsigned order)
+{
+    if (order == 0) {
+        BCLOG_WARNING("Integration order must be positive, using 1.");
+        order = 1;
+    }
+    fIntegrationOrder = order;
+    PrepareNodes();
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::PrepareNodes()
+{
+    std::vector<double> t, w;
+    BCMath::GaussLegendre(fIntegrationOrder, t, w);
+
+    // number of nodes per bin
+    unsigned nnodes = 1;
+    for (unsigned d = 0; d < fDimension; ++d)
+        nnodes *= fIntegrationOrder;
+
+    fNodes.clear();
+    fWeights.clear();
+    fNodes.reserve(fBins.size() * nnodes * fDimension);
+    fWeights.reserve(fBins.size() * nnodes);
+
+    const TAxis* axes[3] = { fHistogram->GetXaxis(), fHistogram->GetYaxis(), fHistogram->GetZaxis() };
+    for (unsigned i = 0; i < fBins.size(); ++i) {
+        int index[3] = { 0, 0, 0 };
+        fHistogram->GetBinXYZ(fBins[i], index[0], index[1], index[2]);
+
+        double center[3];
+        double halfwidth[3];
+        for (unsigned d = 0; d < fDimension; ++d) {
+            center[d] = axes[d]->GetBinCenter(index[d]);
+            halfwidth[d] = 0.5 * axes[d]->GetBinWidth(index[d]);
+        }
+
+        // tensor product of the 1D rule
+        for (unsigned k = 0; k < nnodes; ++k) {
+            double weight = 1;
+            for (unsigned d = 0, j = k; d < fDimension; ++d, j /= fIntegrationOrder) {
+                fNodes.push_back(center[d] + halfwidth[d] * t[j % fIntegrationOrder]);
+                weight *= halfwidth[d] * w[j % fIntegrationOrder];
+            }
+            fWeights.push_back(weight);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::MCMCUserInitialize()
+{
+    ResizeFunctions(fMCMCNChains);
+    fExpectations.resize(fMCMCNChains);
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::MarginalizePreprocess()
+{
+    fErrorBand.assign(fFlagFillErrorBand ? fBins.size() : 0, BCQuantileSketch());
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::MCMCUserIterationInterface()
+{
+    if (!fFlagFillErrorBand or fErrorBand.size() != fBins.size())
+        return;
+
+    // the bins are evaluated in parallel here
+    for (unsigned c = 0; c < GetNChains(); ++c) {
+        const std::vector<double>& expected = GetExpectations(Getx(c));
+        for (unsigned i = 0; i < expected.size(); ++i)
+            fErrorBand[i].Add(expected[i]);
+    }
+}
+
+// ---------------------------------------------------------
+namespace
+{
+/**
+ * Expected counts and Poisson log probabilities of blocks of bins. */
+class BinLogDensity : public BCModel::BlockLogDensity
+{
+public:
+    BinLogDensity(const std::vector<TF1*>& functions, const std::vector<double>& parameters,
+                  const std::vector<double>& nodes, const std::vector<double>& weights,
+                  const std::vector<double>& counts, unsigned dimension,
+                  std::vector<double>& expected, bool loglikelihood)
+        : fFunctions(functions),
+          fParameters(parameters),
+          fNodes(nodes),
+          fWeights(weights),
+          fCounts(counts),
+          fDimension(dimension),
+          fExpected(expected),
+          fLogLikelihood(loglikelihood)
+    {}
+
+    virtual void operator()(unsigned begin, unsigned end, unsigned slot, double* logdensity) const
+    {
+        // each thread or chain uses its own copy of the function
+        TF1& f = *fFunctions.at(slot);
+        f.SetParameters(&fParameters[0]);
+
+        const unsigned nnodes = fWeights.size() / fCounts.size();
+        for (unsigned i = begin; i < end; ++i) {
+            // integrate over the bin
+            double e = 0;
+            for (unsigned k = i * nnodes; k < (i + 1) * nnodes; ++k)
+                e += fWeights[k] * f.EvalPar(&fNodes[k * fDimension]);
+            fExpected[i] = e;
+
+            logdensity[i - begin] = fLogLikelihood ? BCMath::LogPoisson(fCounts[i], e) : 0;
+        }
+    }
+
+private:
+    const std::vector<TF1*>& fFunctions;
+    const std::vector<double>& fParameters;
+    const std::vector<double>& fNodes;
+    const std::vector<double>& fWeights;
+    const std::vector<double>& fCounts;
+    const unsigned fDimension;
+    std::vector<double>& fExpected;
+    const bool fLogLikelihood;
+};
+}
+
+// ---------------------------------------------------------
+double BCHistogramFitterND::Evaluate(const std::vector<double>& params, bool loglikelihood)
+{
+    std::vector<double>& expected = fExpectations.at(GetCurrentChain());
+    expected.resize(fBins.size());
+
+    const BinLogDensity f(fFunctions, params, fNodes, fWeights, fCounts, fDimension, expected, loglikelihood);
+    return SumLogDensities(fBins.size(), f, fFunctions.size());
+}
+
+// ---------------------------------------------------------
+const std::vector<double>& BCHistogramFitterND::GetExpectations(const std::vector<double>& params)
+{
+    Evaluate(params, false);
+    return fExpectations.at(GetCurrentChain());
+}
+
+// ---------------------------------------------------------
+double BCHistogramFitterND::LogLikelihood(const std::vector<double>& params)
+{
+    return Evaluate(params, true);
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::Fit()
+{
+    // perform marginalization
+    MarginalizeAll();
+
+    // maximize posterior probability, using the best-fit values close
+    // to the global maximum from the MCMC
+    BCIntegrate::BCOptimizationMethod method_temp = GetOptimizationMethod();
+    SetOptimizationMethod(BCIntegrate::kOptMinuit);
+    FindMode(GetBestFitParameters());
+    SetOptimizationMethod(method_temp);
+
+    // calculate the p-value using the fast MCMC algorithm
+    if (!CalculatePValueFast(GetBestFitParameters()))
+        BCLOG_WARNING("Could not use the fast p-value evaluation.");
+
+    // print summary to screen
+    PrintShortFitSummary();
+}
+
+// ---------------------------------------------------------
+TH1* BCHistogramFitterND::GetExpectationHistogram(const std::vector<double>& params)
+{
+    TH1* hist = static_cast<TH1*>(fHistogram->Clone(Form("%s_expected", fHistogram->GetName())));
+    hist->SetDirectory(0);
+    hist->Reset();
+
+    const std::vector<double>& expected = GetExpectations(params);
+    for (unsigned i = 0; i < fBins.size(); ++i)
+        hist->SetBinContent(fBins[i], expected[i]);
+
+    return hist;
+}
+
+// ---------------------------------------------------------
+TH1* BCHistogramFitterND::GetErrorBandHistogram(double level) const
+{
+    if (fErrorBand.size() != fBins.size()) {
+        BCLOG_ERROR("Error band not filled, see SetFillErrorBand().");
+        return 0;
+    }
+
+    TH1* hist = static_cast<TH1*>(fHistogram->Clone(Form("%s_band_%g", fHistogram->GetName(), level)));
+    hist->SetDirectory(0);
+    hist->Reset();
+
+    for (unsigned i = 0; i < fBins.size(); ++i)
+        hist->SetBinContent(fBins[i], fErrorBand[i].GetQuantile(level));
+
+    return hist;
+}
+
+// ---------------------------------------------------------
+bool BCHistogramFitterND::CalculatePValueFast(const std::vector<double>& pars, unsigned nIterations)
+{
+    // check size of parameter vector
+    if (pars.size() != GetNParameters()) {
+        BCLOG_ERROR("Number of parameters is inconsistent.");
+        return false;
+    }
+
+    // copy observed and expected values
+    std::vector<unsigned> observed(fCounts.size());
+    for (unsigned i = 0; i < fCounts.size(); ++i)
+        observed[i] = (unsigned) fCounts[i];
+    std::vector<double> expected = GetExpectations(pars);
+
+    // create pseudo experiments
+    fPValue = BCMath::FastPValue(observed, expected, nIterations, fRandom.GetSeed());
+
+    // correct for fitting bias
+    fPValueNDoF = BCMath::CorrectPValue(fPValue, GetNParameters(), fCounts.size());
+
+    // no error
+    return true;
+}
+
+// ---------------------------------------------------------
+bool BCHistogramFitterND::CalculatePValueLikelihood(const std::vector<double>& pars)
+{
+    // initialize test statistic -2*lambda
+    double logLambda = 0.0;
+
+    // get the number of expected events
+    const std::vector<double>& expected = GetExpectations(pars);
+
+    for (unsigned i = 0; i < fCounts.size(); ++i) {
+        const double y = fCounts[i];
+        const double yexp = expected[i];
+
+        // get the contribution from this datapoint
+        if (y == 0)
+            logLambda += yexp;
+        else
+            logLambda += yexp - y + y * log(y / yexp);
+    }
+
+    // rescale
+    logLambda *= 2.0;
+
+    //p value from chi^2 distribution, returns zero if logLambda < 0
+    fPValue = TMath::Prob(logLambda, GetNDataPoints());
+    fPValueNDoF = TMath::Prob(logLambda, GetNDoF());
+
+    // no error
+    return true;
+}
+
+// ---------------------------------------------------------
+bool BCHistogramFitterND::CalculatePValueLeastSquares(const std::vector<double>& pars, bool weightExpect)
+{
+    // initialize test statistic chi^2
+    double chi2 = 0.0;
+
+    // get the number of expected events
+    const std::vector<double>& expected = GetExpectations(pars);
+
+    for (unsigned i = 0; i < fCounts.size(); ++i) {
+        const double y = fCounts[i];
+        const double yexp = expected[i];
+
+        //convert 1/0.0 into 1 for weighted sum
+        double weight;
+        if (weightExpect)
+            weight = (yexp > 0) ? yexp : 1.0;
+        else
+            weight = (y > 0) ? y : 1.0;
+
+        // get the contribution from this datapoint
+        chi2 += (y - yexp) * (y - yexp) / weight;
+    }
+
+    // p value from chi^2 distribution
+    fPValue = TMath::Prob(chi2, GetNDataPoints());
+    fPValueNDoF = TMath::Prob(chi2, GetNDataPoints() - GetNParameters());
+
+    // no error
+    return true;
+}
+
+// ---------------------------------------------------------
+void BCHistogramFitterND::PrintShortFitSummary()
+{
+    BCModel::PrintShortFitSummary();
+    if (GetPValue() >= 0) {
+        BCLog::OutSummary("   Goodness-of-fit test:");
+        BCLog::OutSummary(Form("      p-value = %.3g", GetPValue()));
+        BCLog::OutSummary(Form("      p-value corrected for degrees of freedom = %.3g", GetPValueNDoF()));
+        BCLog::OutSummary("---------------------------------------------------");
+    }
+}
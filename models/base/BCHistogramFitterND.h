@@ -0,0 +1,248 @@
+#ifndef __BCHISTOGRAMFITTERND__H
+#define __BCHISTOGRAMFITTERND__H
+
+/*!
+ * \class BCHistogramFitterND
+ * \brief A class for fitting 2D and 3D histograms with functions
+ * \detail This class allows fitting of a TH2 or TH3 histogram using
+ * a TF2 or TF3 function. The expected number of counts in each bin is
+ * the integral of the function over the bin, computed with a
+ * tensor-product Gauss-Legendre rule on nodes cached at construction.
+ * The Poisson likelihood is summed with BCModel::SumLogDensities(),
+ * which evaluates blocks of bins in parallel if no chains are running
+ * in parallel.
+ */
+
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include "../../BAT/BCDataSet.h"
+#include "../../BAT/BCModel.h"
+#include "../../BAT/BCQuantileSketch.h"
+
+#include <string>
+#include <vector>
+
+// ROOT classes
+class TF1;
+class TH1;
+
+// ---------------------------------------------------------
+
+class BCHistogramFitterND : public BCModel
+{
+public:
+
+    /** \name Constructors and destructors */
+    /* @{ */
+
+    /**
+     * Constructor
+     * @param hist 2D or 3D histogram with observed number of counts.
+     * @param func fit function of the same dimension as the histogram
+     * @param name name of the model */
+    BCHistogramFitterND(const TH1& hist, const TF1& func, const std::string& name = "histogram_fitter_nd_model");
+
+    /**
+     * The default destructor. */
+    virtual ~BCHistogramFitterND();
+
+    /* @} */
+
+    /** \name Member functions (get) */
+    /* @{ */
+
+    /**
+     * @return The data histogram */
+    const TH1& GetHistogram() const
+    { return *fHistogram; }
+
+    /**
+     * @return The fit function */
+    const TF1& GetFitFunction() const
+    { return *fFunctions.front(); }
+
+    /**
+     * @return The dimension of the histogram */
+    unsigned GetDimension() const
+    { return fDimension; }
+
+    /**
+     * @return p value of the last goodness-of-fit test */
+    double GetPValue() const
+    { return fPValue; }
+
+    /**
+     * @return p Value accounting for degrees of freedom */
+    double GetPValueNDoF() const
+    { return fPValueNDoF; }
+
+    /**
+     * Compute the expected number of counts in each bin.
+     * @param parameters A set of parameter values
+     * @return The expected counts in the order of the bins in the data set;
+     * valid until the next call in the same chain. */
+    const std::vector<double>& GetExpectations(const std::vector<double>& parameters);
+
+    /**
+     * @param parameters A set of parameter values
+     * @return A new histogram with the binning of the data and the expected counts; owned by the caller. */
+    TH1* GetExpectationHistogram(const std::vector<double>& parameters);
+
+    /**
+     * @param level The level of probability
+     * @return A new histogram with the binning of the data and the
+     * quantile of the expected counts in each bin; owned by the caller.
+     * Requires SetFillErrorBand() before the MCMC run. */
+    TH1* GetErrorBandHistogram(double level) const;
+
+    /* @} */
+
+    /** \name Member functions (set) */
+    /* @{ */
+
+    /**
+     * Set the order of the Gauss-Legendre rule in each dimension;
+     * the function is evaluated order^dimension times per bin.
+     * Order 1 uses the value at the bin center times the bin volume.
+     * @param order The number of nodes per dimension */
+    void SetIntegrationOrder(unsigned order);
+
+    /**
+     * Turn on or off the filling of the error band during the MCMC run.
+     * The expected counts are evaluated for every chain in every
+     * iteration, which roughly doubles the run time.
+     * @param flag set to true for turning on the filling */
+    void SetFillErrorBand(bool flag = true)
+    { fFlagFillErrorBand = flag; }
+
+    /* @} */
+
+    /** \name Member functions (miscellaneous methods) */
+    /* @{ */
+
+    /**
+     * The log of the conditional probability. Overloaded from BCModel.
+     * @param parameters A vector of doubles containing the parameter values. */
+    virtual double LogLikelihood(const std::vector<double>& parameters);
+
+    /**
+     * Performs the fit. */
+    virtual void Fit();
+
+    /**
+     * Calculate the p-value using fast-MCMC and the likelihood as test statistic.
+     * @see BCMath::FastPValue
+     * @param par The parameter values for which expectations are computed
+     * @param nIterations number of pseudo experiments generated by the Markov chain
+     * @return Success of action. */
+    bool CalculatePValueFast(const std::vector<double>& par, unsigned nIterations = 100000);
+
+    /**
+     * Calculate the p-value using approximate chi^2 distribution of scaled likelihood.
+     * @see BCHistogramFitter::CalculatePValueLikelihood
+     * @param par The set of parameter values used in the model, usually the best fit parameters
+     * @return Success of action. */
+    bool CalculatePValueLikelihood(const std::vector<double>& par);
+
+    /**
+     * Calculate the p-value using approximate chi^2 distribution of squared difference.
+     * @see BCHistogramFitter::CalculatePValueLeastSquares
+     * @param par The set of parameter values used in the model, usually the best fit parameters
+     * @param weightExpect use the variance from the expected #counts (true) or the measured counts (false)
+     * @return Success of action. */
+    bool CalculatePValueLeastSquares(const std::vector<double>& par, bool weightExpect = true);
+
+    /**
+     * Prints a short summary of the fit results on the screen. */
+    void PrintShortFitSummary();
+
+    /**
+     * Create enough function copies and buffers for thread safety. Overloaded from BCEngineMCMC. */
+    virtual void MCMCUserInitialize();
+
+    /**
+     * Fill the error band. Overloaded from BCEngineMCMC. */
+    virtual void MCMCUserIterationInterface();
+
+    /**
+     * Reset the error band. Overloaded from BCIntegrate. */
+    virtual void MarginalizePreprocess();
+
+    /* @} */
+
+private:
+
+    /**
+     * Not copyable because of the owned function copies. */
+    BCHistogramFitterND(const BCHistogramFitterND& other);
+    BCHistogramFitterND& operator=(const BCHistogramFitterND& other);
+
+    /**
+     * Make sure there are at least n copies of the fit function. */
+    void ResizeFunctions(unsigned n);
+
+    /**
+     * Compute the integration nodes and weights of all bins. */
+    void PrepareNodes();
+
+    /**
+     * Compute the expected counts in all bins.
+     * @param parameters A set of parameter values
+     * @param loglikelihood Flag whether to sum up the log likelihood
+     * @return The log likelihood if requested, else 0. */
+    double Evaluate(const std::vector<double>& parameters, bool loglikelihood);
+
+    /** The histogram with observed number of counts. */
+    TH1* fHistogram;
+
+    /** Dimension of histogram and function. */
+    unsigned fDimension;
+
+    /** Fit function copies, one per chain or thread. */
+    std::vector<TF1*> fFunctions;
+
+    /** Global bin numbers of all bins in range. */
+    std::vector<int> fBins;
+
+    /** Observed counts in all bins. */
+    std::vector<double> fCounts;
+
+    /** Number of nodes per dimension. */
+    unsigned fIntegrationOrder;
+
+    /** Coordinates of the integration nodes, consecutively per node and per bin. */
+    std::vector<double> fNodes;
+
+    /** Integration weights of the nodes, including the bin volume. */
+    std::vector<double> fWeights;
+
+    /** Expected counts in all bins (one vector per chain). */
+    std::vector<std::vector<double> > fExpectations;
+
+    /** Flag whether or not to fill the error band. */
+    bool fFlagFillErrorBand;
+
+    /** Quantile sketches of the expected counts in each bin. */
+    std::vector<BCQuantileSketch> fErrorBand;
+
+    /** p value for goodness of fit */
+    double fPValue;
+
+    /** fPValue accounting for degrees of freedom. */
+    double fPValueNDoF;
+
+    /** Needed for the number of degrees of freedom. */
+    BCDataSet fFitterDataSet;
+};
+
+// ---------------------------------------------------------
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include <config.h>
+
+#include "BCSimultaneousFitter.h"
+
+#include <BAT/BCLog.h>
+#include <BAT/BCParameter.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
+
+// ---------------------------------------------------------
+BCSimultaneousFitter::BCSimultaneousFitter(const std::string& name)
+    : BCModel(name),
+      fFlagCacheLikelihoods(true),
+      fCachedParameters(1),
+      fCachedLogLikelihoods(1),
+      fNThreads(1)
+{
+#if THREAD_PARALLELIZATION
+    fNThreads = omp_get_max_threads();
+#endif
+
+    // set MCMC for marginalization
+    SetMarginalizationMethod(BCIntegrate::kMargMetropolis);
+}
+
+// ---------------------------------------------------------
+BCSimultaneousFitter::~BCSimultaneousFitter()
+{
+}
+
+// ---------------------------------------------------------
+unsigned BCSimultaneousFitter::AddModel(BCModel& model)
+{
+    std::vector<unsigned> indices;
+    for (unsigned i = 0; i < model.GetNParameters(); ++i) {
+        const BCParameter& par = model.GetParameter(i);
+
+        // find parameter of same name
+        unsigned j = 0;
+        while (j < fParameters.Size() and !fParameters[j].IsNamed(par.GetName()))
+            ++j;
+
+        if (j == fParameters.Size() and !fParameters.Add(par))
+            throw std::invalid_argument("BCSimultaneousFitter::AddModel: Cannot add parameter " + par.GetName());
+
+        indices.push_back(j);
+    }
+
+    return AddModel(model, indices);
+}
+
+// ---------------------------------------------------------
+unsigned BCSimultaneousFitter::AddModel(BCModel& model, const std::vector<unsigned>& indices)
+{
+    if (&model == this)
+        throw std::invalid_argument("BCSimultaneousFitter::AddModel: Cannot add model to itself");
+    if (std::find(fModels.begin(), fModels.end(), &model) != fModels.end())
+        throw std::invalid_argument("BCSimultaneousFitter::AddModel: Model " + model.GetName() + " added twice");
+    if (indices.size() != model.GetNParameters())
+        throw std::invalid_argument("BCSimultaneousFitter::AddModel: Need one index per parameter of " + model.GetName());
+    for (unsigned i = 0; i < indices.size(); ++i)
+        if (indices[i] >= GetNParameters())
+            throw std::invalid_argument("BCSimultaneousFitter::AddModel: Parameter index out of range for " + model.GetName());
+
+    fModels.push_back(&model);
+    fParameterIndices.push_back(indices);
+    fSubModelChains.push_back(std::vector<int>(fNThreads, -1));
+
+    // invalidate caches
+    for (unsigned c = 0; c < fCachedParameters.size(); ++c) {
+        fCachedParameters[c].assign(fModels.size(), std::vector<double>());
+        fCachedLogLikelihoods[c].assign(fModels.size(), 0);
+    }
+
+    return fModels.size() - 1;
+}
+
+// ---------------------------------------------------------
+void BCSimultaneousFitter::MCMCUserInitialize()
+{
+    fCachedParameters.assign(fMCMCNChains, std::vector<std::vector<double> >(fModels.size()));
+    fCachedLogLikelihoods.assign(fMCMCNChains, std::vector<double>(fModels.size(), 0));
+
+#if THREAD_PARALLELIZATION
+    fNThreads = omp_get_max_threads();
+#endif
+
+    // sub-models allocate their per-chain objects; their chain indices are set anew
+    for (unsigned i = 0; i < fModels.size(); ++i) {
+        fModels[i]->SetNChains(fMCMCNChains);
+        fModels[i]->MCMCUserInitialize();
+        fSubModelChains[i].assign(fNThreads, -1);
+    }
+}
+
+// ---------------------------------------------------------
+void BCSimultaneousFitter::SetSubModelChain(unsigned index, unsigned chain)
+{
+    unsigned thread = 0;
+#if THREAD_PARALLELIZATION
+    thread = omp_get_thread_num();
+#endif
+
+    // only this thread writes its entry, so no lock is needed to skip the update
+    std::vector<int>& chains = fSubModelChains[index];
+    if (thread < chains.size() and chains[thread] == int(chain))
+        return;
+
+    fModels[index]->UpdateChainIndex(chain);
+    if (thread < chains.size())
+        chains[thread] = chain;
+}
+
+// ---------------------------------------------------------
+double BCSimultaneousFitter::SubLogLikelihood(unsigned index, unsigned chain, const std::vector<double>& params)
+{
+    const std::vector<unsigned>& indices = fParameterIndices[index];
+    std::vector<double>& cached = fCachedParameters[chain][index];
+
+    // reuse cached value if no parameter of sub-model changed
+    bool changed = !fFlagCacheLikelihoods or cached.size() != indices.size();
+    for (unsigned i = 0; !changed and i < indices.size(); ++i)
+        changed = cached[i] != params[indices[i]];
+    if (!changed)
+        return fCachedLogLikelihoods[chain][index];
+
+    cached.resize(indices.size());
+    for (unsigned i = 0; i < indices.size(); ++i)
+        cached[i] = params[indices[i]];
+
+    // sub-model uses its objects for the same chain
+    SetSubModelChain(index, chain);
+    fCachedLogLikelihoods[chain][index] = fModels[index]->LogLikelihood(cached);
+
+    return fCachedLogLikelihoods[chain][index];
+}
+
+// ---------------------------------------------------------
+double BCSimultaneousFitter::LogLikelihood(const std::vector<double>& params)
+{
+    const unsigned chain = GetCurrentChain();
+    const unsigned nmodels = fModels.size();
+
+    std::vector<double> logl(nmodels, 0);
+
+    // parallelize over sub-models only if the chains don't run in parallel already
+    bool parallel = false;
+    (void) parallel;
+#if THREAD_PARALLELIZATION
+    parallel = !omp_in_parallel() and nmodels > 1;
+#endif
+
+    if (parallel) {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < int(nmodels); ++i)
+            logl[i] = SubLogLikelihood(i, chain, params);
+    } else {
+        // no team of one thread, which would renumber the calling thread
+        for (unsigned i = 0; i < nmodels; ++i)
+            logl[i] = SubLogLikelihood(i, chain, params);
+    }
+
+    // sum up in fixed order for reproducible results
+    double sum = 0;
+    for (unsigned i = 0; i < nmodels; ++i)
+        sum += logl[i];
+
+    return sum;
+}
@@ -0,0 +1,173 @@
+#ifndef __BCSIMULTANEOUSFITTER__H
+#define __BCSIMULTANEOUSFITTER__H
+
+/*!
+ * \class BCSimultaneousFitter
+ * \brief A class for fitting several data sets with shared parameters
+ * \detail The likelihood of this model is the product of the
+ * likelihoods of several sub-models, for example BCHistogramFitter
+ * and BCGraphFitter objects fitting different data sets. Each
+ * sub-model is added with a map from its parameters to the parameters
+ * of this model; parameters with the same name are shared by default.
+ * Only the likelihoods of the sub-models are used; the priors are
+ * those of the parameters of this model.
+ *
+ * If the chains don't run in parallel, the sub-likelihoods are
+ * evaluated in parallel. The value of each sub-likelihood is cached
+ * per chain, and only recomputed if one of its parameters changed,
+ * which saves most evaluations when parameters are updated one at a
+ * time.
+ *
+ * The fitter reconfigures its sub-models: MCMCUserInitialize() sets
+ * their number of chains to its own and calls their
+ * MCMCUserInitialize(), and the likelihood sets their chain index
+ * for the calling thread. A model can be added only once, and it
+ * shouldn't be run by itself while the fitter is in use.
+ */
+
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include "../../BAT/BCModel.h"
+
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------
+
+class BCSimultaneousFitter : public BCModel
+{
+public:
+
+    /** \name Constructors and destructors */
+    /* @{ */
+
+    /**
+     * Constructor
+     * @param name name of the model */
+    BCSimultaneousFitter(const std::string& name = "simultaneous_fitter_model");
+
+    /**
+     * The default destructor. */
+    virtual ~BCSimultaneousFitter();
+
+    /* @} */
+
+    /** \name Member functions (get) */
+    /* @{ */
+
+    /**
+     * @return The number of sub-models */
+    unsigned GetNModels() const
+    { return fModels.size(); }
+
+    /**
+     * @param index Index of the sub-model
+     * @return The sub-model */
+    BCModel& GetModel(unsigned index)
+    { return *fModels.at(index); }
+
+    /**
+     * @param index Index of the sub-model
+     * @return For each parameter of the sub-model, the index of the parameter of this model */
+    const std::vector<unsigned>& GetParameterIndices(unsigned index) const
+    { return fParameterIndices.at(index); }
+
+    /**
+     * @return Whether cached sub-likelihoods are reused for unchanged parameters */
+    bool GetFlagCacheLikelihoods() const
+    { return fFlagCacheLikelihoods; }
+
+    /* @} */
+
+    /** \name Member functions (set) */
+    /* @{ */
+
+    /**
+     * Add a sub-model. It is reconfigured by the fitter, see the class
+     * description. Its parameters are mapped onto the parameters of
+     * this model with the same name; missing parameters are added as
+     * copies, including their priors.
+     * @param model The sub-model; not owned, has to outlive this model.
+     * @return The index of the sub-model */
+    unsigned AddModel(BCModel& model);
+
+    /**
+     * Add a sub-model with an explicit parameter map.
+     * @param model The sub-model; not owned, has to outlive this model, and not added before.
+     * @param indices For each parameter of the sub-model, the index of the parameter of this model
+     * @return The index of the sub-model */
+    unsigned AddModel(BCModel& model, const std::vector<unsigned>& indices);
+
+    /**
+     * Turn on or off reusing the cached sub-likelihoods. Turn off if a
+     * sub-likelihood depends on anything but its parameters.
+     * @param flag true to reuse the cached values */
+    void SetFlagCacheLikelihoods(bool flag = true)
+    { fFlagCacheLikelihoods = flag; }
+
+    /* @} */
+
+    /** \name Member functions (miscellaneous methods) */
+    /* @{ */
+
+    /**
+     * The log of the conditional probability, the sum of the
+     * sub-likelihoods. Overloaded from BCModel.
+     * @param parameters A vector of doubles containing the parameter values. */
+    virtual double LogLikelihood(const std::vector<double>& parameters);
+
+    /**
+     * Prepare the sub-models and caches for the number of chains. Overloaded from BCEngineMCMC. */
+    virtual void MCMCUserInitialize();
+
+    /* @} */
+
+private:
+
+    /**
+     * Evaluate one sub-likelihood, or take it from the cache.
+     * @param index Index of the sub-model
+     * @param chain Index of the chain
+     * @param parameters The parameters of this model */
+    double SubLogLikelihood(unsigned index, unsigned chain, const std::vector<double>& parameters);
+
+    /**
+     * Set the chain index of a sub-model for the calling thread, unless
+     * already set by a previous call.
+     * @param index Index of the sub-model
+     * @param chain Index of the chain */
+    void SetSubModelChain(unsigned index, unsigned chain);
+
+    /** The sub-models. */
+    std::vector<BCModel*> fModels;
+
+    /** Parameter maps of the sub-models. */
+    std::vector<std::vector<unsigned> > fParameterIndices;
+
+    /** Flag whether to reuse cached sub-likelihoods. */
+    bool fFlagCacheLikelihoods;
+
+    /** Parameters of the last evaluation, per chain and sub-model. */
+    std::vector<std::vector<std::vector<double> > > fCachedParameters;
+
+    /** Sub-likelihoods of the last evaluation, per chain and sub-model. */
+    std::vector<std::vector<double> > fCachedLogLikelihoods;
+
+    /** Chain index last set in each sub-model, per sub-model and thread; -1 if not set. */
+    std::vector<std::vector<int> > fSubModelChains;
+
+    /** Number of threads with a tracked chain index. */
+    unsigned fNThreads;
+};
+
+// ---------------------------------------------------------
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include <config.h>
+
+#include "BCUnbinnedFitter.h"
+
+#include <BAT/BCDataPoint.h>
+#include <BAT/BCLog.h>
+#include <BAT/BCMath.h>
+
+#include <TF1.h>
+#include <TF2.h>
+#include <TF3.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
+
+// ---------------------------------------------------------
+BCUnbinnedFitter::BCUnbinnedFitter(const TF1& pdf, const BCDataSet& data, const std::string& name)
+    : BCModel(name),
+      fColumns(pdf.GetNdim()),
+      fTotalWeight(data.GetTotalWeight()),
+      fExtended(false),
+      fFlagNormalized(false),
+      fNormalizationParameters(1),
+      fNormalization(1, 0),
+      fFitterDataSet(data)
+{
+    if (pdf.GetNdim() < 1 or pdf.GetNdim() > 3)
+        throw std::invalid_argument("BCUnbinnedFitter: Only 1D, 2D and 3D densities supported");
+    if (data.GetNDataPoints() > 0 and data.GetNValuesPerPoint() < fColumns.size())
+        throw std::invalid_argument("BCUnbinnedFitter: Data points have fewer values than the density has dimensions");
+
+    fFunctions.push_back(static_cast<TF1*>(pdf.Clone()));
+
+    // fill parameter set
+    for (int i = 0; i < pdf.GetNpar(); ++i) {
+        double xmin;
+        double xmax;
+        pdf.GetParLimits(i, xmin, xmax);
+        AddParameter(pdf.GetParName(i), xmin, xmax);
+    }
+
+    // by default set all priors constant
+    fParameters.SetPriorConstantAll();
+
+    // columnar copy of the events
+    if (data.GetNDataPoints() > 0) {
+        for (unsigned d = 0; d < fColumns.size(); ++d)
+            fColumns[d].assign(data.GetColumn(d), data.GetColumn(d) + data.GetNDataPoints());
+        if (data.HasWeights())
+            fWeights.assign(data.GetWeights(), data.GetWeights() + data.GetNDataPoints());
+    }
+
+    SetDataSet(&fFitterDataSet);
+
+    // function copies for evaluating events in parallel outside of the MCMC
+#if THREAD_PARALLELIZATION
+    ResizeFunctions(omp_get_max_threads());
+#endif
+
+    // set MCMC for marginalization
+    SetMarginalizationMethod(BCIntegrate::kMargMetropolis);
+}
+
+// ---------------------------------------------------------
+BCUnbinnedFitter::~BCUnbinnedFitter()
+{
+    for (unsigned i = 0; i < fFunctions.size(); ++i)
+        delete fFunctions[i];
+}
+
+// ---------------------------------------------------------
+void BCUnbinnedFitter::ResizeFunctions(unsigned n)
+{
+    while (fFunctions.size() < n)
+        fFunctions.push_back(static_cast<TF1*>(fFunctions.front()->Clone()));
+}
+
+// ---------------------------------------------------------
+void BCUnbinnedFitter::MCMCUserInitialize()
+{
+    ResizeFunctions(fMCMCNChains);
+    fNormalizationParameters.resize(fMCMCNChains);
+    fNormalization.resize(fMCMCNChains, 0);
+}
+
+// ---------------------------------------------------------
+void BCUnbinnedFitter::EvaluateDensity(TF1& f, const std::vector<double>&, unsigned begin, unsigned end, double* density)
+{
+    const unsigned ndim = fColumns.size();
+
+    // 1D: read directly from the column
+    if (ndim == 1) {
+        const double* x = &fColumns.front()[0];
+        for (unsigned i = begin; i < end; ++i)
+            density[i - begin] = f.EvalPar(&x[i]);
+        return;
+    }
+
+    // gather the coordinates of each event
+    double x[3];
+    for (unsigned i = begin; i < end; ++i) {
+        for (unsigned d = 0; d < ndim; ++d)
+            x[d] = fColumns[d][i];
+        density[i - begin] = f.EvalPar(x);
+    }
+}
+
+// ---------------------------------------------------------
+double BCUnbinnedFitter::CalculateNormalization(TF1& f, const std::vector<double>&)
+{
+    // the domain of the density is the range of the function ...
+    double lower[3] = {0, 0, 0};
+    double upper[3] = {0, 0, 0};
+    switch (fColumns.size()) {
+        case 1:
+            f.GetRange(lower[0], upper[0]);
+            break;
+        case 2:
+            static_cast<TF2&>(f).GetRange(lower[0], lower[1], upper[0], upper[1]);
+            break;
+        case 3:
+            static_cast<TF3&>(f).GetRange(lower[0], lower[1], lower[2], upper[0], upper[1], upper[2]);
+            break;
+        default:
+            return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // ... unless bounds were set on the data set; the observed
+    // minimum and maximum of the events are not the domain
+    const BCDataPoint& user_lower = fFitterDataSet.GetUserLowerBounds();
+    const BCDataPoint& user_upper = fFitterDataSet.GetUserUpperBounds();
+    for (unsigned d = 0; d < fColumns.size(); ++d) {
+        if (d < user_lower.GetNValues() and std::isfinite(user_lower[d]))
+            lower[d] = user_lower[d];
+        if (d < user_upper.GetNValues() and std::isfinite(user_upper[d]))
+            upper[d] = user_upper[d];
+    }
+
+    switch (fColumns.size()) {
+        case 1:
+            return f.Integral(lower[0], upper[0]);
+        case 2:
+            return static_cast<TF2&>(f).Integral(lower[0], upper[0], lower[1], upper[1]);
+        default:
+            return static_cast<TF3&>(f).Integral(lower[0], upper[0], lower[1], upper[1], lower[2], upper[2]);
+    }
+}
+
+// ---------------------------------------------------------
+double BCUnbinnedFitter::GetNormalization(const std::vector<double>& params)
+{
+    const unsigned chain = GetCurrentChain();
+
+    // only recompute if the parameters changed
+    if (fNormalizationParameters.at(chain) != params) {
+        TF1& f = *fFunctions.at(chain);
+        f.SetParameters(&params[0]);
+        fNormalization.at(chain) = CalculateNormalization(f, params);
+        fNormalizationParameters.at(chain) = params;
+    }
+
+    return fNormalization.at(chain);
+}
+
+// ---------------------------------------------------------
+namespace
+{
+/**
+ * Log densities of blocks of events. */
+class EventLogDensity : public BCModel::BlockLogDensity
+{
+public:
+    EventLogDensity(BCUnbinnedFitter& fitter, const std::vector<TF1*>& functions, const std::vector<double>& parameters)
+        : fFitter(fitter),
+          fFunctions(functions),
+          fParameters(parameters)
+    {}
+
+    virtual void operator()(unsigned begin, unsigned end, unsigned slot, double* logdensity) const
+    {
+        // each thread or chain uses its own copy of the function
+        TF1& f = *fFunctions.at(slot);
+        f.SetParameters(&fParameters[0]);
+
+        fFitter.EvaluateDensity(f, fParameters, begin, end, logdensity);
+        BCMath::Log(end - begin, logdensity, logdensity);
+    }
+
+private:
+    BCUnbinnedFitter& fFitter;
+    const std::vector<TF1*>& fFunctions;
+    const std::vector<double>& fParameters;
+};
+}
+
+// ---------------------------------------------------------
+double BCUnbinnedFitter::LogLikelihood(const std::vector<double>& params)
+{
+    const EventLogDensity f(*this, fFunctions, params);
+    const double logl = SumLogDensities(GetNEvents(), f, fFunctions.size(), fWeights.empty() ? 0 : &fWeights[0]);
+
+    // extended: Poisson term for the number of events
+    if (fExtended)
+        return logl - GetNormalization(params) - BCMath::ApproxLogFact(fTotalWeight);
+
+    if (fFlagNormalized)
+        return logl;
+
+    return logl - fTotalWeight * log(GetNormalization(params));
+}
+
+// ---------------------------------------------------------
+void BCUnbinnedFitter::Fit()
+{
+    // perform marginalization
+    MarginalizeAll();
+
+    // maximize posterior probability, using the best-fit values close
+    // to the global maximum from the MCMC
+    BCIntegrate::BCOptimizationMethod method_temp = GetOptimizationMethod();
+    SetOptimizationMethod(BCIntegrate::kOptMinuit);
+    FindMode(GetBestFitParameters());
+    SetOptimizationMethod(method_temp);
+
+    // print summary to screen
+    PrintShortFitSummary();
+}
@@ -0,0 +1,204 @@
+#ifndef __BCUNBINNEDFITTER__H
+#define __BCUNBINNEDFITTER__H
+
+/*!
+ * \class BCUnbinnedFitter
+ * \brief A class for unbinned maximum-likelihood fits of a density to events
+ * \detail This class fits a 1D, 2D or 3D function, interpreted as a
+ * probability density, to the events of a data set. The density is
+ * normalized to its integral over the range of the function, or over
+ * the bounds set with BCDataSet::SetBounds() where given, which is
+ * computed once per parameter point and chain. In the extended
+ * likelihood, the integral is the expected number of events.
+ *
+ * The events are copied into one contiguous array per dimension. The
+ * sum of the log densities is evaluated by BCModel::SumLogDensities()
+ * in blocks of events, in parallel if thread parallelization is enabled
+ * and no chains are running in parallel.
+ *
+ * Weighted events, e.g. from BCDataSet::Compact(), contribute their
+ * log density times their weight, so compacting a data set with many
+ * identical events gives the same likelihood for fewer evaluations.
+ *
+ * To use a density other than a TF1, overload EvaluateDensity() and,
+ * if needed, CalculateNormalization().
+ */
+
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include "../../BAT/BCDataSet.h"
+#include "../../BAT/BCModel.h"
+
+#include <string>
+#include <vector>
+
+// ROOT classes
+class TF1;
+
+// ---------------------------------------------------------
+
+class BCUnbinnedFitter : public BCModel
+{
+public:
+
+    /** \name Constructors and destructors */
+    /* @{ */
+
+    /**
+     * Constructor
+     * @param pdf The density; its dimension determines how many values of each data point are used.
+     * @param data The events; copied into the fitter.
+     * @param name name of the model */
+    BCUnbinnedFitter(const TF1& pdf, const BCDataSet& data, const std::string& name = "unbinned_fitter_model");
+
+    /**
+     * The default destructor. */
+    virtual ~BCUnbinnedFitter();
+
+    /* @} */
+
+    /** \name Member functions (get) */
+    /* @{ */
+
+    /**
+     * @return The density */
+    const TF1& GetPDF() const
+    { return *fFunctions.front(); }
+
+    /**
+     * @return The dimension of the density */
+    unsigned GetDimension() const
+    { return fColumns.size(); }
+
+    /**
+     * @return The number of distinct events */
+    unsigned GetNEvents() const
+    { return fColumns.empty() ? 0 : fColumns.front().size(); }
+
+    /**
+     * @return The sum of the event weights, i.e. the number of events before compaction */
+    double GetTotalWeight() const
+    { return fTotalWeight; }
+
+    /**
+     * @return The values of one dimension for all events. */
+    const std::vector<double>& GetColumn(unsigned dimension) const
+    { return fColumns.at(dimension); }
+
+    /**
+     * @return Whether the extended likelihood is used */
+    bool GetExtended() const
+    { return fExtended; }
+
+    /**
+     * Get the integral of the density over its domain, see CalculateNormalization(),
+     * cached for the last parameter point in each chain.
+     * @param parameters A set of parameter values */
+    double GetNormalization(const std::vector<double>& parameters);
+
+    /* @} */
+
+    /** \name Member functions (set) */
+    /* @{ */
+
+    /**
+     * Use the extended likelihood. The integral of the density over
+     * its domain is then the expected number of events.
+     * @param flag true for the extended likelihood */
+    void SetExtended(bool flag = true)
+    { fExtended = flag; }
+
+    /**
+     * Declare the density as normalized for all parameter values, so
+     * no integral is computed. Ignored for the extended likelihood.
+     * @param flag true if the density is normalized */
+    void SetFlagNormalized(bool flag = true)
+    { fFlagNormalized = flag; }
+
+    /* @} */
+
+    /** \name Member functions (miscellaneous methods) */
+    /* @{ */
+
+    /**
+     * The log of the conditional probability. Overloaded from BCModel.
+     * @param parameters A vector of doubles containing the parameter values. */
+    virtual double LogLikelihood(const std::vector<double>& parameters);
+
+    /**
+     * Evaluate the unnormalized density for a range of events.
+     * @param f Copy of the density function for the current chain or thread; parameters are set.
+     * @param parameters A set of parameter values
+     * @param begin Index of the first event
+     * @param end Index after the last event
+     * @param density Filled with the values for events begin, ..., end-1; may be called from several threads at once. */
+    virtual void EvaluateDensity(TF1& f, const std::vector<double>& parameters, unsigned begin, unsigned end, double* density);
+
+    /**
+     * Calculate the integral of the density over its domain: the range
+     * of the function, except in dimensions with bounds set by the user
+     * on the data set. The minimum and maximum of the events are not used.
+     * @param f Copy of the density function for the current chain; parameters are set.
+     * @param parameters A set of parameter values */
+    virtual double CalculateNormalization(TF1& f, const std::vector<double>& parameters);
+
+    /**
+     * Performs the fit. */
+    virtual void Fit();
+
+    /**
+     * Create enough function copies and buffers for thread safety. Overloaded from BCEngineMCMC. */
+    virtual void MCMCUserInitialize();
+
+    /* @} */
+
+private:
+
+    /**
+     * Not copyable because of the owned function copies. */
+    BCUnbinnedFitter(const BCUnbinnedFitter& other);
+    BCUnbinnedFitter& operator=(const BCUnbinnedFitter& other);
+
+    /**
+     * Make sure there are at least n copies of the density. */
+    void ResizeFunctions(unsigned n);
+
+    /** Density copies, one per chain or thread. */
+    std::vector<TF1*> fFunctions;
+
+    /** Values of the events, one vector per dimension. */
+    std::vector<std::vector<double> > fColumns;
+
+    /** Weights of the events; empty if all weights are one. */
+    std::vector<double> fWeights;
+
+    /** Sum of the event weights. */
+    double fTotalWeight;
+
+    /** Flag for the extended likelihood. */
+    bool fExtended;
+
+    /** Flag for a density that is normalized for all parameter values. */
+    bool fFlagNormalized;
+
+    /** Parameters of the cached normalization (one vector per chain). */
+    std::vector<std::vector<double> > fNormalizationParameters;
+
+    /** Cached normalization (one value per chain). */
+    std::vector<double> fNormalization;
+
+    /** Copy of the data set. */
+    BCDataSet fFitterDataSet;
+};
+
+// ---------------------------------------------------------
+
+#endif
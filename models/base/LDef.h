@@ -13,6 +13,9 @@
 #pragma link C++ class BCGraphFitter-;
 #pragma link C++ class BCEfficiencyFitter-;
 #pragma link C++ class BCHistogramFitter-;
+#pragma link C++ class BCHistogramFitterND-;
+#pragma link C++ class BCSimultaneousFitter-;
+#pragma link C++ class BCUnbinnedFitter-;
 
 
 #endif
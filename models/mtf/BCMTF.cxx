@@ -38,6 +38,7 @@ BCMTF::BCMTF(const std::string& name)
     , fNProcesses(0)
     , fNSystematics(0)
     , fFlagEfficiencyConstraint(false)
+    , fExpectations(1)
 {}
 
 // ---------------------------------------------------------
@@ -1117,6 +1118,9 @@ double BCMTF::LogLikelihood(const std::vector<double>& parameters)
 {
     double logprob = 0.;
 
+    // expectation values of the bins of one channel
+    std::vector<double>& expectation = fExpectations.at(GetCurrentChain());
+
     // loop over all channels
     for (int ichannel = 0; ichannel < fNChannels; ++ichannel) {
 
@@ -1140,23 +1144,26 @@ double BCMTF::LogLikelihood(const std::vector<double>& parameters)
         // get number of bins in data
         int nbins = data->GetNBins();
 
-        // loop over all bins
-        for (int ibin = 1; ibin <= nbins; ++ibin) {
-
-            // get expectation value
-            double expectation = Expectation(ichannel, ibin, parameters);
-
-            // get observation
-            double observation = hist->GetBinContent(ibin);
+        // get expectation values
+        expectation.resize(nbins);
+        for (int ibin = 1; ibin <= nbins; ++ibin)
+            expectation[ibin - 1] = Expectation(ichannel, ibin, parameters);
 
-            // add Poisson term
-            logprob += BCMath::LogPoisson(observation, expectation);
-        }
+        // add Poisson terms of all bins, observations skip the underflow bin
+        if (nbins > 0)
+            logprob += BCMath::SumLogPoisson(nbins, hist->GetArray() + 1, &expectation[0]);
     }
 
     return logprob;
 }
 
+// ---------------------------------------------------------
+void BCMTF::MCMCUserInitialize()
+{
+    BCModel::MCMCUserInitialize();
+    fExpectations.resize(fMCMCNChains);
+}
+
 // ---------------------------------------------------------
 void BCMTF::MCMCUserIterationInterface()
 {
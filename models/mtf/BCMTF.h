@@ -388,6 +388,10 @@ public:
      * provided via overloading in the derived class*/
     void MCMCUserIterationInterface();
 
+    /**
+     * Create enough buffers for thread safety. Overloaded from BCEngineMCMC. */
+    virtual void MCMCUserInitialize();
+
     /** @} */
 
 private:
@@ -442,6 +446,10 @@ private:
      * P value accounting for degrees of freedom. */
     double fPValueNDoF;
 
+    /**
+     * Expectation values of the bins of one channel (one vector per chain). */
+    std::vector<std::vector<double> > fExpectations;
+
 };
 // ---------------------------------------------------------
 
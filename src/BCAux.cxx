@@ -26,9 +26,15 @@
 #include <TStyle.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <limits>
+#include <locale>
+#include <sstream>
 
 // ---------------------------------------------------------
 
@@ -215,6 +221,126 @@ bool BCAux::AllowedCharacter(char c)
     return false;
 }
 
+// ---------------------------------------------------------
+bool BCAux::ParseNumber(const char* begin, const char* end, double& value)
+{
+    // exactly representable powers of ten
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                                   };
+
+    const char* p = begin;
+    bool negative = false;
+    if (p < end and (*p == '+' or *p == '-'))
+        negative = (*p++ == '-');
+
+    // collect up to 19 significant digits, which fit into 64 bits, as
+    // a number and as text
+    unsigned long long mantissa = 0;
+    char significant[20];
+    int ndigits = 0;
+    int exponent = 0;
+    bool digits = false;
+    bool exact = true;
+    for (; p < end and *p >= '0' and *p <= '9'; ++p) {
+        digits = true;
+        if (ndigits < 19) {
+            mantissa = 10 * mantissa + (*p - '0');
+            if (mantissa > 0)
+                significant[ndigits++] = *p;
+        } else {
+            ++exponent;
+            exact &= (*p == '0');
+        }
+    }
+    if (p < end and *p == '.')
+        for (++p; p < end and *p >= '0' and *p <= '9'; ++p) {
+            digits = true;
+            if (ndigits < 19) {
+                mantissa = 10 * mantissa + (*p - '0');
+                --exponent;
+                if (mantissa > 0)
+                    significant[ndigits++] = *p;
+            } else
+                exact &= (*p == '0');
+        }
+
+    if (digits and p < end and (*p == 'e' or *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end and (*q == '+' or *q == '-'))
+            negativeExponent = (*q++ == '-');
+        int e = 0;
+        const char* first = q;
+        for (; q < end and *q >= '0' and *q <= '9'; ++q)
+            if (e < 100000)
+                e = 10 * e + (*q - '0');
+        if (q > first) {
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    if (digits and p == end and exact) {
+        // both mantissa and power of ten exact: a single rounding
+        if (mantissa <= (1ULL << 53) and exponent >= -22 and exponent <= 22) {
+            value = static_cast<double>(mantissa);
+            if (exponent < 0)
+                value /= pow10[-exponent];
+            else
+                value *= pow10[exponent];
+            if (negative)
+                value = -value;
+            return true;
+        }
+
+        // larger mantissas and exponents: the digits as an integer with an
+        // exponent, without a decimal point, are independent of the locale
+        if (ndigits == 0)
+            value = 0;
+        else {
+            char buffer[40];
+            std::memcpy(buffer, significant, ndigits);
+            std::sprintf(buffer + ndigits, "e%d", exponent);
+            errno = 0;
+            value = std::strtod(buffer, 0);
+            if (errno == ERANGE and value == HUGE_VAL)
+                return false;
+        }
+        if (negative)
+            value = -value;
+        return true;
+    }
+
+    // all other cases, including invalid input
+    std::istringstream stream(std::string(begin, end));
+    stream.imbue(std::locale::classic());
+    stream >> value;
+    return !stream.fail() and stream.peek() == std::char_traits<char>::eof();
+}
+
+// ---------------------------------------------------------
+bool BCAux::ParseNumbers(const char* begin, const char* end, std::vector<double>& values)
+{
+    const char* p = begin;
+    while (true) {
+        // skip white space
+        while (p < end and (*p == ' ' or *p == '\t' or *p == '\n' or *p == '\r' or *p == '\v' or *p == '\f'))
+            ++p;
+        if (p == end)
+            return true;
+
+        const char* token = p;
+        while (p < end and !(*p == ' ' or *p == '\t' or *p == '\n' or *p == '\r' or *p == '\v' or *p == '\f'))
+            ++p;
+
+        double value;
+        if (!ParseNumber(token, p, value))
+            return false;
+        values.push_back(value);
+    }
+}
+
 // ---------------------------------------------------------
 void BCAux::SetKnowledgeUpdateDrawingStyle(BCH1D& prior, BCH1D& posterior, BCAux::BCKnowledgeUpdateDrawingStyle style)
 {
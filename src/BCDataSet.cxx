@@ -8,11 +8,15 @@
 
 // ---------------------------------------------------------
 
+#include <config.h>
+
 #include "BCDataSet.h"
 
+#include "BCAux.h"
 #include "BCDataPoint.h"
 #include "BCLog.h"
 
+#include <TBranch.h>
 #include <TFile.h>
 #include <TGraph.h>
 #include <TGraphErrors.h>
@@ -21,33 +25,254 @@
 #include <TString.h>
 #include <TTree.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+
+#if HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+/** Identifies binary data set files and the version of the format. */
+const char BinaryMagic[8] = { 'B', 'A', 'T', 'D', 'A', 'T', 'A', '2' };
+
+/** Written after the magic word to detect files from machines with another byte order. */
+const uint64_t BinaryByteOrder = 0x0102030405060708ULL;
+
+/** Byte order word as read on a machine with the opposite byte order. */
+const uint64_t BinaryByteOrderSwapped = 0x0807060504030201ULL;
+
+/** Number of bounds and flags stored per component. */
+const unsigned BinaryNBounds = 5;
+
+/** White space separating the values in text files. */
+inline bool IsSpace(char c)
+{
+    return c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == '\v' or c == '\f';
+}
+
+/**
+ * Count the tokens separated by white space in a range of text. */
+size_t CountTokens(const char* begin, const char* end)
+{
+    size_t n = 0;
+    for (const char* p = begin; p < end; ++n) {
+        while (p < end and IsSpace(*p))
+            ++p;
+        if (p == end)
+            break;
+        while (p < end and !IsSpace(*p))
+            ++p;
+    }
+    return n;
+}
+
+/**
+ * Parse the tokens of a range of text into interleaved columns.
+ * @param index Index of the first value in the interleaved order
+ * @return The number of tokens parsed before the first one that is not a number */
+size_t ParseTokens(const char* begin, const char* end, size_t index, std::vector<std::vector<double> >& columns)
+{
+    const size_t n = columns.size();
+    size_t nparsed = 0;
+    const char* p = begin;
+    while (true) {
+        while (p < end and IsSpace(*p))
+            ++p;
+        if (p == end)
+            return nparsed;
+
+        const char* token = p;
+        while (p < end and !IsSpace(*p))
+            ++p;
+
+        const size_t i = index + nparsed;
+        if (!BCAux::ParseNumber(token, p, columns[i % n][i / n]))
+            return nparsed;
+        ++nparsed;
+    }
+}
+
+/**
+ * Orders rows of a data set by the bit patterns of their values, and
+ * by index for identical rows. Comparing bits keeps the order strict
+ * for NaN values and only groups values that are exactly identical. */
+class RowLess
+{
+public:
+    RowLess(const std::vector<double*>& columns)
+        : fColumns(columns)
+    {}
+
+    bool operator()(unsigned a, unsigned b) const
+    {
+        for (unsigned j = 0; j < fColumns.size(); ++j) {
+            uint64_t x;
+            uint64_t y;
+            std::memcpy(&x, &fColumns[j][a], sizeof(x));
+            std::memcpy(&y, &fColumns[j][b], sizeof(y));
+            if (x != y)
+                return x < y;
+        }
+        return a < b;
+    }
+
+    bool Equal(unsigned a, unsigned b) const
+    {
+        for (unsigned j = 0; j < fColumns.size(); ++j)
+            if (std::memcmp(&fColumns[j][a], &fColumns[j][b], sizeof(double)) != 0)
+                return false;
+        return true;
+    }
+
+private:
+    const std::vector<double*>& fColumns;
+};
+}
+
+// ---------------------------------------------------------
+std::vector<double> BCDataSet::Row::GetValues() const
+{
+    std::vector<double> values(fColumns->size());
+    for (unsigned i = 0; i < values.size(); ++i)
+        values[i] = (*fColumns)[i][fRow];
+    return values;
+}
+
+// ---------------------------------------------------------
+std::vector<double> BCDataSet::ConstRow::GetValues() const
+{
+    std::vector<double> values(fColumns->size());
+    for (unsigned i = 0; i < values.size(); ++i)
+        values[i] = (*fColumns)[i][fRow];
+    return values;
+}
 
 // ---------------------------------------------------------
 BCDataSet::BCDataSet(unsigned n)
+    : fMapping(0),
+      fMappingSize(0),
+      fNDataPoints(0)
 {
     SetNValuesPerPoint(n);
 }
 
 // ---------------------------------------------------------
-std::vector<double> BCDataSet::GetDataComponents(unsigned index) const
+BCDataSet::BCDataSet(const BCDataSet& other)
+    : fColumns(other.fColumns),
+      fMapping(0),
+      fMappingSize(0),
+      fComponentNames(other.fComponentNames),
+      fWeights(other.fWeights),
+      fNDataPoints(other.fNDataPoints),
+      fNValuesPerPoint(other.fNValuesPerPoint),
+      fLowerBounds(other.fLowerBounds),
+      fUpperBounds(other.fUpperBounds),
+      fUserLowerBounds(other.fUserLowerBounds),
+      fUserUpperBounds(other.fUserUpperBounds),
+      fFixed(other.fFixed)
 {
-    std::vector<double> components;
+    // copy mapped values into memory
+    if (other.fMapping)
+        for (unsigned i = 0; i < fColumns.size(); ++i)
+            fColumns[i].assign(other.fColumnData[i], other.fColumnData[i] + fNDataPoints);
 
-    if (index >= fNValuesPerPoint)
-        return components;
+    UpdateColumnData();
+}
 
-    // reserve space
-    components.reserve(fDataVector.size());
+// ---------------------------------------------------------
+BCDataSet::~BCDataSet()
+{
+    Unmap();
+}
 
-    // loop over data points
-    for (unsigned i = 0; i < fDataVector.size(); ++i)
-        components.push_back(fDataVector[i][index]);
+// ---------------------------------------------------------
+BCDataSet& BCDataSet::operator=(const BCDataSet& other)
+{
+    // copy and swap; the copy releases the old mapping
+    BCDataSet copy(other);
+    std::swap(fColumns, copy.fColumns);
+    std::swap(fColumnData, copy.fColumnData);
+    std::swap(fMapping, copy.fMapping);
+    std::swap(fMappingSize, copy.fMappingSize);
+    std::swap(fComponentNames, copy.fComponentNames);
+    std::swap(fWeights, copy.fWeights);
+    std::swap(fNDataPoints, copy.fNDataPoints);
+    std::swap(fNValuesPerPoint, copy.fNValuesPerPoint);
+    std::swap(fLowerBounds, copy.fLowerBounds);
+    std::swap(fUpperBounds, copy.fUpperBounds);
+    std::swap(fUserLowerBounds, copy.fUserLowerBounds);
+    std::swap(fUserUpperBounds, copy.fUserUpperBounds);
+    std::swap(fFixed, copy.fFixed);
+    return *this;
+}
 
-    return components;
+// ---------------------------------------------------------
+void BCDataSet::UpdateColumnData()
+{
+    if (fMapping)
+        return;
+    fColumnData.resize(fColumns.size());
+    for (unsigned i = 0; i < fColumns.size(); ++i)
+        fColumnData[i] = fColumns[i].empty() ? 0 : &fColumns[i][0];
+}
+
+// ---------------------------------------------------------
+void BCDataSet::Materialize()
+{
+    if (!fMapping)
+        return;
+    for (unsigned i = 0; i < fColumns.size(); ++i)
+        fColumns[i].assign(fColumnData[i], fColumnData[i] + fNDataPoints);
+    Unmap();
+    UpdateColumnData();
+}
+
+// ---------------------------------------------------------
+void BCDataSet::Unmap()
+{
+#if HAVE_SYS_MMAN_H
+    if (fMapping)
+        munmap(fMapping, fMappingSize);
+#endif
+    fMapping = 0;
+    fMappingSize = 0;
+}
+
+// ---------------------------------------------------------
+void BCDataSet::Reset()
+{
+    Unmap();
+    fColumns.clear();
+    fWeights.clear();
+    fNDataPoints = 0;
+    SetNValuesPerPoint(0);
+}
+
+// ---------------------------------------------------------
+unsigned BCDataSet::CheckIndex(unsigned index) const
+{
+    if (index >= fNDataPoints)
+        throw std::out_of_range(Form("BCDataSet: data point index %u out of range", index));
+    return index;
+}
+
+// ---------------------------------------------------------
+std::vector<double> BCDataSet::GetDataComponents(unsigned index) const
+{
+    if (index >= fNValuesPerPoint)
+        return std::vector<double>();
+
+    return std::vector<double>(fColumnData[index], fColumnData[index] + fNDataPoints);
 }
 
 // ---------------------------------------------------------
@@ -116,7 +341,7 @@ bool BCDataSet::ReadDataFromFileTree(const std::string& filename, const std::str
     }
 
     // if data set contains data, clear data object container ...
-    if (!fDataVector.empty()) {
+    if (fNDataPoints > 0) {
         Reset();
         BCLog::OutDetail("BCDataSet::ReadDataFromFileTree : Overwrite existing data.");
     }
@@ -130,19 +355,56 @@ bool BCDataSet::ReadDataFromFileTree(const std::string& filename, const std::str
         if (!branchname.empty())
             branches.push_back(branchname);
 
-    // create temporary vector with data and assign some zeros.
-    std::vector<double> data(branches.size(), 0);
+    if (fNValuesPerPoint == 0)
+        SetNValuesPerPoint(branches.size());
+    if (fNValuesPerPoint != branches.size()) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileTree : Number of branches doesn't match number of values per point.");
+        file->Close();
+        delete file;
+        return false;
+    }
 
-    // set the branch address.
-    for (unsigned i = 0; i < branches.size(); ++i)
-        tree->SetBranchAddress(branches[i].data(), &data[i]);
+    std::vector<TBranch*> tbranches(branches.size(), 0);
+    for (unsigned i = 0; i < branches.size(); ++i) {
+        tbranches[i] = tree->GetBranch(branches[i].data());
+        if (!tbranches[i]) {
+            BCLog::OutError("BCDataSet::ReadDataFromFileTree : Could not find branch " + branches[i] + ".");
+            file->Close();
+            delete file;
+            return false;
+        }
+        SetComponentName(i, branches[i]);
+    }
 
-    // loop over entries
-    for (long ientry = 0; ientry < nentries; ++ientry) {
-        tree->GetEntry(ientry);
-        AddDataPoint(BCDataPoint(data));
+    // read one branch after the other straight into its column, so the
+    // baskets of each branch are decompressed in sequence and no
+    // temporary data points are created
+    for (unsigned i = 0; i < branches.size(); ++i) {
+        double value = 0;
+        tbranches[i]->SetAddress(&value);
+
+        std::vector<double>& column = fColumns[i];
+        column.resize(nentries);
+        double low = fLowerBounds[i];
+        double high = fUpperBounds[i];
+        for (long ientry = 0; ientry < nentries; ++ientry) {
+            tbranches[i]->GetEntry(ientry);
+            column[ientry] = value;
+            // bounds in the same pass
+            if (value < low)
+                low = value;
+            if (value > high)
+                high = value;
+        }
+        fLowerBounds[i] = low;
+        fUpperBounds[i] = high;
+
+        tbranches[i]->ResetAddress();
     }
 
+    fNDataPoints = nentries;
+    UpdateColumnData();
+
     file->Close();
 
     // remove file pointer.
@@ -156,8 +418,7 @@ bool BCDataSet::ReadDataFromFileTree(const std::string& filename, const std::str
 bool BCDataSet::ReadDataFromFileTxt(const std::string& filename, int nbranches)
 {
     // open text file.
-    std::fstream file;
-    file.open(filename.data(), std::fstream::in);
+    std::ifstream file(filename.data(), std::ios::in | std::ios::binary);
 
     // check if file is open and warn if not.
     if (!file.is_open()) {
@@ -165,68 +426,420 @@ bool BCDataSet::ReadDataFromFileTxt(const std::string& filename, int nbranches)
         return false;
     }
 
+    if (nbranches <= 0) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileText : Number of variables must be positive.");
+        return false;
+    }
+
     // if data set contains data, clear data object container ...
-    if (!fDataVector.empty()) {
+    if (fNDataPoints > 0) {
         Reset();
         BCLog::OutDetail("BCDataSet::ReadDataFromFileTxt : Overwrite existing data.");
     }
 
-    // create temporary vector with data and assign some zeros.
-    std::vector<double> data(nbranches, 0);
+    if (fNValuesPerPoint == 0)
+        SetNValuesPerPoint(nbranches);
+    if (fNValuesPerPoint != unsigned(nbranches)) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileText : Number of variables doesn't match number of values per point.");
+        return false;
+    }
 
-    // reset counter
-    int nentries = 0;
+    // map the file, or read it into memory if mapping is not possible
+    file.seekg(0, std::ios::end);
+    const size_t size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    const char* text = 0;
+    std::vector<char> buffer;
+#if HAVE_SYS_MMAN_H
+    void* mapping = MAP_FAILED;
+    if (size > 0) {
+        int fd = open(filename.data(), O_RDONLY);
+        if (fd >= 0) {
+            mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+        }
+    }
+    if (mapping != MAP_FAILED)
+        text = static_cast<const char*>(mapping);
+#endif
+    if (!text and size > 0) {
+        buffer.resize(size);
+        file.read(&buffer[0], size);
+        text = &buffer[0];
+    }
+    file.close();
 
-    // read data and create data points.
-    while (!file.eof()) {
+    // split into chunks ending at line breaks
+    static const size_t chunksize = 1 << 20;
+    std::vector<size_t> chunks(1, 0);
+    while (chunks.back() < size) {
+        size_t next = std::min(chunks.back() + chunksize, size);
+        while (next < size and text[next - 1] != '\n')
+            ++next;
+        chunks.push_back(next);
+    }
+    const unsigned nchunks = chunks.size() - 1;
+
+    // count the tokens of each chunk to know where its values go
+    std::vector<size_t> offsets(nchunks + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < int(nchunks); ++c)
+        offsets[c + 1] = CountTokens(text + chunks[c], text + chunks[c + 1]);
+    for (unsigned c = 0; c < nchunks; ++c)
+        offsets[c + 1] += offsets[c];
+
+    // parse directly into the columns; values of a data point may span several lines
+    const unsigned n = nbranches;
+    for (unsigned j = 0; j < n; ++j)
+        fColumns[j].resize((offsets.back() + n - 1) / n);
+    std::vector<size_t> nparsed(nchunks);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < int(nchunks); ++c)
+        nparsed[c] = ParseTokens(text + chunks[c], text + chunks[c + 1], offsets[c], fColumns);
+
+#if HAVE_SYS_MMAN_H
+    if (mapping != MAP_FAILED)
+        munmap(mapping, size);
+#endif
+    std::vector<char>().swap(buffer);
+
+    // stop at the first token that is not a number
+    size_t nvalues = offsets.back();
+    for (unsigned c = 0; c < nchunks; ++c)
+        if (nparsed[c] < offsets[c + 1] - offsets[c]) {
+            BCLog::OutWarning("BCDataSet::ReadDataFromFileText : Stopped reading " + filename + " at a token that is not a number.");
+            nvalues = offsets[c] + nparsed[c];
+            break;
+        }
 
-        // read data from file
-        int i = 0;
-        while (file >> data[i]) {
-            if (i == nbranches - 1)
-                break;
-            i++;
+    // incomplete last data point is ignored
+    const size_t nentries = nvalues / n;
+
+    // issue error if no entries were loaded
+    if (nentries == 0) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileText : No events in the file " + filename + ".");
+        for (unsigned j = 0; j < n; ++j)
+            std::vector<double>().swap(fColumns[j]);
+        return false;
+    }
+
+    // bounds of each column
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int j = 0; j < int(n); ++j) {
+        fColumns[j].resize(nentries);
+        const std::vector<double>& column = fColumns[j];
+        for (size_t i = 0; i < nentries; ++i) {
+            if (column[i] < fLowerBounds[j])
+                fLowerBounds[j] = column[i];
+            if (column[i] > fUpperBounds[j])
+                fUpperBounds[j] = column[i];
         }
+    }
+
+    fNDataPoints = nentries;
+    UpdateColumnData();
+
+    return true;
+}
 
-        // create data point.
-        if (i == nbranches - 1) {
-            AddDataPoint(BCDataPoint(data));
-            ++nentries;
+// ---------------------------------------------------------
+bool BCDataSet::ReadDataFromFileBinary(const std::string& filename)
+{
+    std::ifstream file(filename.data(), std::ios::in | std::ios::binary);
+
+    // check if file is open and warn if not.
+    if (!file.is_open()) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileBinary : Could not open file " + filename + ".");
+        return false;
+    }
+
+    // size of the file, to check all counts before allocating
+    file.seekg(0, std::ios::end);
+    const uint64_t size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    // read header
+    char magic[sizeof(BinaryMagic)];
+    uint64_t byteorder = 0;
+    uint64_t ncomponents = 0;
+    uint64_t npoints = 0;
+    uint64_t offset = 0;
+    uint64_t weighted = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&byteorder), sizeof(byteorder));
+    if (file and std::memcmp(magic, BinaryMagic, sizeof(magic)) == 0 and byteorder == BinaryByteOrderSwapped) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileBinary : " + filename + " was written on a machine with a different byte order.");
+        return false;
+    }
+    file.read(reinterpret_cast<char*>(&ncomponents), sizeof(ncomponents));
+    file.read(reinterpret_cast<char*>(&npoints), sizeof(npoints));
+    file.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+    file.read(reinterpret_cast<char*>(&weighted), sizeof(weighted));
+    if (!file or std::memcmp(magic, BinaryMagic, sizeof(magic)) != 0 or byteorder != BinaryByteOrder) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileBinary : " + filename + " is not a binary data set file.");
+        return false;
+    }
+
+    // each component needs at least the length of its name and its
+    // bounds, and the values have to fit between offset and end of file
+    const uint64_t header = file.tellg();
+    const uint64_t ncolumns = ncomponents + (weighted ? 1 : 0);
+    const uint64_t maxunsigned = std::numeric_limits<unsigned>::max();
+    const uint64_t componentsize = sizeof(uint64_t) + BinaryNBounds * sizeof(double);
+    if (ncomponents > maxunsigned or npoints > maxunsigned
+            or ncomponents > (size - header) / componentsize
+            or offset < header + ncomponents * componentsize or offset > size or offset % sizeof(double) != 0
+            or (ncolumns > 0 and npoints > (size - offset) / sizeof(double) / ncolumns)) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileBinary : File " + filename + " is corrupt or truncated.");
+        return false;
+    }
+
+    std::vector<std::string> names(ncomponents);
+    for (unsigned i = 0; i < names.size() and file; ++i) {
+        uint64_t length = 0;
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        const uint64_t position = file.tellg();
+        if (!file or position > offset or length > offset - position) {
+            file.setstate(std::ios::failbit);
+            break;
         }
+        names[i].resize(length);
+        if (length > 0)
+            file.read(&names[i][0], length);
     }
 
-    // issue error if no entries were loaded
-    if (nentries <= 0)
-        BCLog::OutError("BCDataSet::ReadDataFromFileText : No events in the file " + filename + ".");
+    // the names are shorter than offset, so the sum can't overflow
+    std::vector<double> bounds(ncomponents * BinaryNBounds);
+    if (file and uint64_t(file.tellg()) + bounds.size() * sizeof(double) > offset)
+        file.setstate(std::ios::failbit);
+    if (file and !bounds.empty())
+        file.read(reinterpret_cast<char*>(&bounds[0]), bounds.size() * sizeof(double));
 
-    file.close();
+    if (!file) {
+        BCLog::OutError("BCDataSet::ReadDataFromFileBinary : File " + filename + " is corrupt or truncated.");
+        return false;
+    }
+
+    // if data set contains data, clear data object container ...
+    if (fNDataPoints > 0)
+        BCLog::OutDetail("BCDataSet::ReadDataFromFileBinary : Overwrite existing data.");
+    Reset();
+    SetNValuesPerPoint(ncomponents);
+
+    for (unsigned i = 0; i < ncomponents; ++i) {
+        fComponentNames[i] = names[i];
+        fLowerBounds[i] = bounds[i * BinaryNBounds];
+        fUpperBounds[i] = bounds[i * BinaryNBounds + 1];
+        fUserLowerBounds[i] = bounds[i * BinaryNBounds + 2];
+        fUserUpperBounds[i] = bounds[i * BinaryNBounds + 3];
+        fFixed[i] = bounds[i * BinaryNBounds + 4] != 0;
+    }
+
+#if HAVE_SYS_MMAN_H
+    // map file, private copy on write
+    int fd = open(filename.data(), O_RDONLY);
+    if (fd >= 0) {
+        void* mapping = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping != MAP_FAILED) {
+            fMapping = mapping;
+            fMappingSize = size;
+            fColumns.assign(ncomponents, std::vector<double>());
+            double* values = reinterpret_cast<double*>(static_cast<char*>(fMapping) + offset);
+            for (unsigned i = 0; i < ncomponents; ++i)
+                fColumnData[i] = values + i * npoints;
+        }
+    }
+#endif
+
+    // read into memory if mapping is not possible
+    if (!fMapping) {
+        file.clear();
+        file.seekg(offset);
+        for (unsigned i = 0; i < ncomponents; ++i) {
+            fColumns[i].resize(npoints);
+            if (npoints > 0)
+                file.read(reinterpret_cast<char*>(&fColumns[i][0]), npoints * sizeof(double));
+        }
+        if (!file) {
+            BCLog::OutError("BCDataSet::ReadDataFromFileBinary : Could not read values from " + filename + ".");
+            Reset();
+            return false;
+        }
+        UpdateColumnData();
+    }
+
+    // weights are stored after the values
+    if (weighted) {
+        file.clear();
+        file.seekg(offset + ncomponents * npoints * sizeof(double));
+        fWeights.resize(npoints);
+        if (npoints > 0)
+            file.read(reinterpret_cast<char*>(&fWeights[0]), npoints * sizeof(double));
+        if (!file) {
+            BCLog::OutError("BCDataSet::ReadDataFromFileBinary : Could not read weights from " + filename + ".");
+            Reset();
+            return false;
+        }
+    }
+
+    fNDataPoints = npoints;
 
-    return (nentries > 0);
+    return true;
 }
 
 // ---------------------------------------------------------
-bool BCDataSet::AddDataPoint(const BCDataPoint& datapoint)
+bool BCDataSet::WriteDataToFileBinary(const std::string& filename) const
 {
-    if (fNValuesPerPoint == 0 and fDataVector.empty())
+    std::ofstream file(filename.data(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        BCLog::OutError("BCDataSet::WriteDataToFileBinary : Could not open file " + filename + ".");
+        return false;
+    }
+
+    const uint64_t ncomponents = fNValuesPerPoint;
+    const uint64_t npoints = fNDataPoints;
+    const uint64_t weighted = fWeights.empty() ? 0 : 1;
+
+    // values start after the header, aligned to doubles
+    uint64_t offset = sizeof(BinaryMagic) + 5 * sizeof(uint64_t) + ncomponents * BinaryNBounds * sizeof(double);
+    for (unsigned i = 0; i < ncomponents; ++i)
+        offset += sizeof(uint64_t) + fComponentNames[i].size();
+    const unsigned padding = (sizeof(double) - offset % sizeof(double)) % sizeof(double);
+    offset += padding;
+
+    file.write(BinaryMagic, sizeof(BinaryMagic));
+    file.write(reinterpret_cast<const char*>(&BinaryByteOrder), sizeof(BinaryByteOrder));
+    file.write(reinterpret_cast<const char*>(&ncomponents), sizeof(ncomponents));
+    file.write(reinterpret_cast<const char*>(&npoints), sizeof(npoints));
+    file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    file.write(reinterpret_cast<const char*>(&weighted), sizeof(weighted));
+
+    for (unsigned i = 0; i < ncomponents; ++i) {
+        const uint64_t length = fComponentNames[i].size();
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(fComponentNames[i].data(), length);
+    }
+
+    for (unsigned i = 0; i < ncomponents; ++i) {
+        const double bounds[BinaryNBounds] = { fLowerBounds[i], fUpperBounds[i], fUserLowerBounds[i], fUserUpperBounds[i], fFixed[i] ? 1. : 0. };
+        file.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+    }
+
+    const char zeros[sizeof(double)] = { 0 };
+    file.write(zeros, padding);
+
+    // column-major values
+    for (unsigned i = 0; i < ncomponents; ++i)
+        if (npoints > 0)
+            file.write(reinterpret_cast<const char*>(fColumnData[i]), npoints * sizeof(double));
+    if (weighted and npoints > 0)
+        file.write(reinterpret_cast<const char*>(&fWeights[0]), npoints * sizeof(double));
+
+    if (!file) {
+        BCLog::OutError("BCDataSet::WriteDataToFileBinary : Could not write to file " + filename + ".");
+        return false;
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------
+bool BCDataSet::AddDataPoint(const BCDataPoint& datapoint, double weight)
+{
+    if (fNValuesPerPoint == 0 and fNDataPoints == 0)
         SetNValuesPerPoint(datapoint.GetNValues());
 
     if (datapoint.GetNValues() != GetNValuesPerPoint())
         return false;
 
-    fDataVector.push_back(datapoint);
+    Materialize();
 
     for (unsigned i = 0; i < GetNValuesPerPoint(); ++i) {
+        fColumns[i].push_back(datapoint[i]);
         // check lower bound
-        if (fDataVector.back()[i] < fLowerBounds[i])
-            fLowerBounds[i] = fDataVector.back()[i];
+        if (datapoint[i] < fLowerBounds[i])
+            fLowerBounds[i] = datapoint[i];
         // check upper bound
-        if (fDataVector.back()[i] > fUpperBounds[i])
-            fUpperBounds[i] = fDataVector.back()[i];
+        if (datapoint[i] > fUpperBounds[i])
+            fUpperBounds[i] = datapoint[i];
     }
+    // store weights only once one differs from one
+    if (weight != 1 and fWeights.empty())
+        fWeights.assign(fNDataPoints, 1);
+    if (!fWeights.empty())
+        fWeights.push_back(weight);
+
+    ++fNDataPoints;
+
+    // columns may have been reallocated
+    UpdateColumnData();
 
     return true;
 }
 
+// ---------------------------------------------------------
+double BCDataSet::GetTotalWeight() const
+{
+    if (fWeights.empty())
+        return fNDataPoints;
+
+    double sum = 0;
+    for (unsigned i = 0; i < fWeights.size(); ++i)
+        sum += fWeights[i];
+    return sum;
+}
+
+// ---------------------------------------------------------
+unsigned BCDataSet::Compact()
+{
+    Materialize();
+
+    // sort rows, identical rows end up next to each other ordered by index
+    std::vector<unsigned> order(fNDataPoints);
+    for (unsigned i = 0; i < fNDataPoints; ++i)
+        order[i] = i;
+    RowLess less(fColumnData);
+    std::sort(order.begin(), order.end(), less);
+
+    // first occurrence and summed weight of each distinct row
+    std::vector<std::pair<unsigned, double> > groups;
+    for (unsigned k = 0; k < order.size(); ++k) {
+        if (k == 0 or !less.Equal(order[k - 1], order[k]))
+            groups.push_back(std::make_pair(order[k], 0.));
+        groups.back().second += GetWeight(order[k]);
+    }
+
+    // keep original order
+    std::sort(groups.begin(), groups.end());
+
+    for (unsigned j = 0; j < fColumns.size(); ++j) {
+        std::vector<double> column(groups.size());
+        for (unsigned g = 0; g < groups.size(); ++g)
+            column[g] = fColumns[j][groups[g].first];
+        fColumns[j].swap(column);
+    }
+
+    fWeights.resize(groups.size());
+    for (unsigned g = 0; g < groups.size(); ++g)
+        fWeights[g] = groups[g].second;
+
+    fNDataPoints = groups.size();
+    UpdateColumnData();
+
+    return fNDataPoints;
+}
+
+// ---------------------------------------------------------
+void BCDataSet::Reserve(unsigned n)
+{
+    Materialize();
+    for (unsigned i = 0; i < fColumns.size(); ++i)
+        fColumns[i].reserve(n);
+    UpdateColumnData();
+}
+
 // ---------------------------------------------------------
 void BCDataSet::AdjustBoundForUncertainties(unsigned i, double nSigma, unsigned i_err1, int i_err2)
 {
@@ -238,23 +851,31 @@ void BCDataSet::AdjustBoundForUncertainties(unsigned i, double nSigma, unsigned
     if (i_err2 < 0)
         i_err2 = i_err1;
 
+    const double* x = fColumnData[i];
+    const double* err1 = fColumnData[i_err1];
+    const double* err2 = fColumnData[i_err2];
+
     // recalculate bounds accounting for uncertainty
-    for (unsigned j = 0; j < fDataVector.size(); ++j) {
+    for (unsigned j = 0; j < fNDataPoints; ++j) {
 
         // check lower bound
-        if (fDataVector[j][i] - nSigma * fDataVector[j][i_err1] < fLowerBounds[i])
-            fLowerBounds[i] = fDataVector[j][i] - nSigma * fDataVector[j][i_err1];
+        if (x[j] - nSigma * err1[j] < fLowerBounds[i])
+            fLowerBounds[i] = x[j] - nSigma * err1[j];
 
         // check upper bound
-        if (fDataVector[j][i] + nSigma * fDataVector[j][i_err2] > fUpperBounds[i])
-            fUpperBounds[i] = fDataVector[j][i] + nSigma * fDataVector[j][i_err2];
+        if (x[j] + nSigma * err2[j] > fUpperBounds[i])
+            fUpperBounds[i] = x[j] + nSigma * err2[j];
     }
 }
 
 // ---------------------------------------------------------
 void BCDataSet::SetNValuesPerPoint(unsigned n)
 {
+    Materialize();
     fNValuesPerPoint = n;
+    fColumns.resize(n, std::vector<double>(fNDataPoints, 0));
+    fComponentNames.resize(n);
+    UpdateColumnData();
     fLowerBounds.SetNValues(n, std::numeric_limits<double>::infinity());
     fUpperBounds.SetNValues(n, -std::numeric_limits<double>::infinity());
     fUserLowerBounds.SetNValues(n, std::numeric_limits<double>::infinity());
@@ -284,9 +905,9 @@ void BCDataSet::PrintSummary(void (*output)(const std::string&)) const
     output("Data set summary:");
     output(Form("Number of points           : %u", GetNDataPoints()));
     output(Form("Number of values per point : %u", GetNValuesPerPoint()));
-    for (unsigned i = 0; i < fDataVector.size(); ++i) {
+    for (unsigned i = 0; i < fNDataPoints; ++i) {
         output(Form("Data point %5u", i));
-        fDataVector[i].PrintSummary(output);
+        (*this)[i].PrintSummary(output);
     }
 }
 
@@ -299,8 +920,8 @@ TGraph* BCDataSet::GetGraph(unsigned x, unsigned y) const
     TGraph* G = new TGraph();
 
     // fill graph
-    for (unsigned i = 0; i < fDataVector.size(); ++i)
-        G->SetPoint(i, fDataVector[i][x], fDataVector[i][y]);
+    for (unsigned i = 0; i < fNDataPoints; ++i)
+        G->SetPoint(i, fColumnData[x][i], fColumnData[y][i]);
 
     return G;
 }
@@ -315,10 +936,10 @@ TGraphErrors* BCDataSet::GetGraph(unsigned x, unsigned y, int ex, int ey) const
     TGraphErrors* G = new TGraphErrors();
 
     // fill graph
-    for (unsigned i = 0; i < fDataVector.size(); ++i) {
-        G->SetPoint(i, fDataVector[i][x], fDataVector[i][y]);
-        double EX = (ex >= 0) ? fDataVector[i][ex] : 0;
-        double EY = (ey >= 0) ? fDataVector[i][ey] : 0;
+    for (unsigned i = 0; i < fNDataPoints; ++i) {
+        G->SetPoint(i, fColumnData[x][i], fColumnData[y][i]);
+        double EX = (ex >= 0) ? fColumnData[ex][i] : 0;
+        double EY = (ey >= 0) ? fColumnData[ey][i] : 0;
         G->SetPointError(i, EX, EY);
     }
 
@@ -336,12 +957,12 @@ TGraphAsymmErrors* BCDataSet::GetGraph(unsigned x, unsigned y, int ex_below, int
     TGraphAsymmErrors* G = new TGraphAsymmErrors();
 
     // fill graph
-    for (unsigned i = 0; i < fDataVector.size(); ++i) {
-        G->SetPoint(i, fDataVector[i][x], fDataVector[i][y]);
-        double EXb = (ex_below >= 0) ? fDataVector[i][ex_below] : 0;
-        double EXa = (ex_above >= 0) ? fDataVector[i][ex_above] : 0;
-        double EYb = (ey_below >= 0) ? fDataVector[i][ey_below] : 0;
-        double EYa = (ey_above >= 0) ? fDataVector[i][ey_above] : 0;
+    for (unsigned i = 0; i < fNDataPoints; ++i) {
+        G->SetPoint(i, fColumnData[x][i], fColumnData[y][i]);
+        double EXb = (ex_below >= 0) ? fColumnData[ex_below][i] : 0;
+        double EXa = (ex_above >= 0) ? fColumnData[ex_above][i] : 0;
+        double EYb = (ey_below >= 0) ? fColumnData[ey_below][i] : 0;
+        double EYa = (ey_above >= 0) ? fColumnData[ey_above][i] : 0;
         G->SetPointError(i, EXb, EXa, EYb, EYa);
     }
 
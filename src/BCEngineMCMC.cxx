@@ -46,10 +46,61 @@
 
 #include <cmath>
 
+#if PROFILING
+#include <time.h>
+#ifndef CLOCK_MONOTONIC
+#include <sys/time.h>
+#endif
+#endif
+
 #if THREAD_PARALLELIZATION
 #include <omp.h>
 #endif
 
+namespace
+{
+/**
+ * Adds the wall-clock time of its lifetime to an accumulator, if not
+ * NULL. Without profiling support, it does nothing and costs nothing. */
+class ProfileTimer
+{
+public:
+#if PROFILING
+    ProfileTimer(double* time)
+        : fTime(time),
+          fStart(time ? Now() : 0)
+    {}
+
+    ~ProfileTimer()
+    {
+        if (fTime)
+            *fTime += Now() - fStart;
+    }
+
+private:
+    /** @return monotonic time in seconds. */
+    static double Now()
+    {
+#ifdef CLOCK_MONOTONIC
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return t.tv_sec + 1e-9 * t.tv_nsec;
+#else
+        timeval t;
+        gettimeofday(&t, 0);
+        return t.tv_sec + 1e-6 * t.tv_usec;
+#endif
+    }
+
+    double* fTime;
+    double fStart;
+#else
+    ProfileTimer(double*)
+    {}
+#endif
+};
+}
+
 // ---------------------------------------------------------
 BCEngineMCMC::BCEngineMCMC(const std::string& name)
     : fMCMCNIterationsConvergenceGlobal(-1),
@@ -80,7 +131,9 @@ BCEngineMCMC::BCEngineMCMC(const std::string& name)
       fMCMCTreeReuseObservables(true),
       fParameterTree(0),
       fRescaleHistogramRangesAfterPreRun(false),
-      fHistogramRescalePadding(0.1)
+      fHistogramRescalePadding(0.1),
+      fH2OnDemand(false),
+      fMCMCFlagProfiling(false)
 {
     SetName(name);
     SetPrecision(BCEngineMCMC::kMedium);
@@ -117,7 +170,9 @@ BCEngineMCMC::BCEngineMCMC(const std::string& filename, const std::string& name,
       fMCMCTreeReuseObservables(true),
       fParameterTree(0),
       fRescaleHistogramRangesAfterPreRun(false),
-      fHistogramRescalePadding(0.1)
+      fHistogramRescalePadding(0.1),
+      fH2OnDemand(false),
+      fMCMCFlagProfiling(false)
 {
     SetName(name);
     SetPrecision(BCEngineMCMC::kMedium);
@@ -190,7 +245,14 @@ BCEngineMCMC::BCEngineMCMC(const BCEngineMCMC& other)
       fBCH1DdrawingOptions(other.fBCH1DdrawingOptions),
       fBCH2DdrawingOptions(other.fBCH2DdrawingOptions),
       fRescaleHistogramRangesAfterPreRun(other.fRescaleHistogramRangesAfterPreRun),
-      fHistogramRescalePadding(other.fHistogramRescalePadding)
+      fHistogramRescalePadding(other.fHistogramRescalePadding),
+      fH2OnDemand(other.fH2OnDemand),
+      fH2OnDemandPairs(other.fH2OnDemandPairs),
+      fH2OnDemandLimits(other.fH2OnDemandLimits),
+      fH2OnDemandSamples(other.fH2OnDemandSamples),
+      fMCMCFlagProfiling(other.fMCMCFlagProfiling),
+      fMCMCProfilePreRun(other.fMCMCProfilePreRun),
+      fMCMCProfileRun(other.fMCMCProfileRun)
 {
     fH1Marginalized = std::vector<TH1*>(other.fH1Marginalized.size(), NULL);
     for (unsigned i = 0; i < other.fH1Marginalized.size(); ++i)
@@ -297,6 +359,13 @@ void swap(BCEngineMCMC& A, BCEngineMCMC& B)
     std::swap(A.fBCH2DdrawingOptions, B.fBCH2DdrawingOptions);
     std::swap(A.fRescaleHistogramRangesAfterPreRun, B.fRescaleHistogramRangesAfterPreRun);
     std::swap(A.fHistogramRescalePadding, B.fHistogramRescalePadding);
+    std::swap(A.fH2OnDemand, B.fH2OnDemand);
+    std::swap(A.fH2OnDemandPairs, B.fH2OnDemandPairs);
+    std::swap(A.fH2OnDemandLimits, B.fH2OnDemandLimits);
+    std::swap(A.fH2OnDemandSamples, B.fH2OnDemandSamples);
+    std::swap(A.fMCMCFlagProfiling, B.fMCMCFlagProfiling);
+    std::swap(A.fMCMCProfilePreRun, B.fMCMCProfilePreRun);
+    std::swap(A.fMCMCProfileRun, B.fMCMCProfileRun);
 }
 
 // ---------------------------------------------------------
@@ -555,6 +624,12 @@ TH2* BCEngineMCMC::GetMarginalizedHistogram(unsigned i, unsigned j) const
     if (fH2Marginalized[i][j])
         return fH2Marginalized[i][j];
 
+    // build from stored values on first access
+    if (fH2OnDemandPairs.count(std::make_pair(i, j)) > 0) {
+        fH2Marginalized[i][j] = CreateH2OnDemand(i, j);
+        return fH2Marginalized[i][j];
+    }
+
     if (i < GetNVariables() && j < GetNVariables())
         BCLog::OutWarning(Form("BCEngineMCMC::GetMarginalizedHistogram : marginal distribution not stored for %s %s vs %s %s",
                                GetVariable(i).GetPrefix().data(), GetVariable(i).GetName().data(),
@@ -826,10 +901,45 @@ void BCEngineMCMC::UpdateParameterTree()
         ++i;
     TBranch* b_eff = fParameterTree->Branch(TString::Format("efficiency_%d", i), &(eff.front()), TString::Format("efficiency_%d[%d]/D", i, GetNChains()));
 
+    // counters per chain and times per stage of pre-run and main run
+    const unsigned ncounters = 5;
+    const char* counter_names[ncounters] = { "n_evaluations", "n_accepted", "n_rejected", "n_out_of_bounds", "n_nonfinite" };
+    const char* phase_names[2] = { "prerun", "run" };
+    std::vector<std::vector<ULong64_t> > counters(2 * ncounters, std::vector<ULong64_t>(GetNChains(), 0));
+    std::vector<std::vector<double> > times(2, std::vector<double>(kNProfileStages, 0));
+    std::vector<TBranch*> b_profile;
+    for (unsigned p = 0; p < 2; ++p) {
+        const std::vector<Profile>& profiles = GetProfileVector(p == 0 ? kPreRun : kMainRun);
+        if (profiles.empty())
+            continue;
+        for (unsigned j = 0; j < nchains && j < profiles.size(); ++j) {
+            counters[p * ncounters + 0][j] = profiles[j].n_evaluations;
+            counters[p * ncounters + 1][j] = profiles[j].n_accepted;
+            counters[p * ncounters + 2][j] = profiles[j].n_rejected;
+            counters[p * ncounters + 3][j] = profiles[j].n_out_of_bounds;
+            counters[p * ncounters + 4][j] = profiles[j].n_nonfinite;
+        }
+        Profile total = GetProfile(p == 0 ? kPreRun : kMainRun);
+        times[p].assign(total.time, total.time + kNProfileStages);
+
+        // if branch doesn't exist, create it
+        for (unsigned k = 0; k < ncounters; ++k) {
+            TString name = TString::Format("%s_%s", counter_names[k], phase_names[p]);
+            if (!fParameterTree->GetBranch(name))
+                b_profile.push_back(fParameterTree->Branch(name, &(counters[p * ncounters + k].front()), TString::Format("%s[%d]/l", name.Data(), GetNChains())));
+        }
+        TString name = TString::Format("time_%s", phase_names[p]);
+        if (!fParameterTree->GetBranch(name))
+            b_profile.push_back(fParameterTree->Branch(name, &(times[p].front()), TString::Format("%s[%d]/D", name.Data(), kNProfileStages)));
+    }
+
     for (unsigned n = 0; n < fParameterTree->GetEntries(); ++n) {
         if (b_nchains)
             b_nchains->Fill();
 
+        for (unsigned k = 0; k < b_profile.size(); ++k)
+            b_profile[k]->Fill();
+
         for (unsigned j = 0; j < nchains; ++j) {
             scale[j] = (n < GetNParameters()) ? fMCMCProposalFunctionScaleFactor[j][n] : -1;
             if (!fMCMCProposeMultivariate)
@@ -1481,15 +1591,31 @@ bool BCEngineMCMC::GetNewPointMetropolis(unsigned chain, unsigned parameter)
     // increase counter
     fMCMCNIterations[chain]++;
 
+    Profile* profile = CurrentProfile(chain);
+
     // get proposal point
-    if (GetProposalPointMetropolis(chain, parameter, fMCMCThreadLocalStorage[chain].xLocal)) {
+    bool in_bounds;
+    {
+        ProfileTimer timer(ProfileTime(chain, kProfileProposal));
+        in_bounds = GetProposalPointMetropolis(chain, parameter, fMCMCThreadLocalStorage[chain].xLocal);
+    }
+
+    if (in_bounds) {
         // calculate probabilities of the old and new points
         double p0 = (std::isfinite(fMCMCprob[chain])) ? fMCMCprob[chain] : -std::numeric_limits<double>::max();
-        double p1 = LogEval(fMCMCThreadLocalStorage[chain].xLocal);
+        double p1;
+        {
+            ProfileTimer timer(ProfileTime(chain, kProfileLogEval));
+            p1 = LogEval(fMCMCThreadLocalStorage[chain].xLocal);
+        }
+        if (profile)
+            ++profile->n_evaluations;
 
         if (std::isfinite(p1)) {
             // if the new point is more probable, keep it; or else throw dice
             if (p1 >= p0 || log(fMCMCThreadLocalStorage[chain].rng->Rndm()) < (p1 - p0)) {
+                if (profile)
+                    ++profile->n_accepted;
                 // increase efficiency
                 fMCMCStatistics[chain].efficiency[parameter] += (1. - fMCMCStatistics[chain].efficiency[parameter]) / (fMCMCStatistics[chain].n_samples_efficiency + 1.);
                 // copy the point
@@ -1503,16 +1629,21 @@ bool BCEngineMCMC::GetNewPointMetropolis(unsigned chain, unsigned parameter)
                 MCMCCurrentPointInterface(fMCMCThreadLocalStorage[chain].xLocal, chain, true);
                 return true;
             } else {
+                if (profile)
+                    ++profile->n_rejected;
                 // decrease efficiency
                 fMCMCStatistics[chain].efficiency[parameter] *= 1.*fMCMCStatistics[chain].n_samples_efficiency / (fMCMCStatistics[chain].n_samples_efficiency + 1.);
             }
         } else {						// new log(likelihood) was not a finite number
-            BCLog::OutDebug(Form("Log(likelihood) evaluated to nan or inf in chain %i while varying parameter %s to %.3e", chain, GetParameter(parameter).GetName().data(), fMCMCThreadLocalStorage[chain].xLocal[parameter]));
+            if (profile)
+                ++profile->n_nonfinite;
+            BCLOG_OUT_LIMITED(debug, 100, Form("Log(likelihood) evaluated to nan or inf in chain %i while varying parameter %s to %.3e", chain, GetParameter(parameter).GetName().data(), fMCMCThreadLocalStorage[chain].xLocal[parameter]));
             // decrease efficiency
             fMCMCStatistics[chain].efficiency[parameter] *= 1.*fMCMCStatistics[chain].n_samples_efficiency / (fMCMCStatistics[chain].n_samples_efficiency + 1.);
             // print parameter point
         }
-    }
+    } else if (profile)
+        ++profile->n_out_of_bounds;
 
     // execute user code
     MCMCCurrentPointInterface(fMCMCThreadLocalStorage[chain].xLocal, chain, false);
@@ -1525,15 +1656,31 @@ bool BCEngineMCMC::GetNewPointMetropolis(unsigned chain)
     // increase counter
     fMCMCNIterations[chain]++;
 
+    Profile* profile = CurrentProfile(chain);
+
     // get proposal point
-    if (GetProposalPointMetropolis(chain, fMCMCThreadLocalStorage[chain].xLocal)) {
+    bool in_bounds;
+    {
+        ProfileTimer timer(ProfileTime(chain, kProfileProposal));
+        in_bounds = GetProposalPointMetropolis(chain, fMCMCThreadLocalStorage[chain].xLocal);
+    }
+
+    if (in_bounds) {
         // calculate probabilities of the old and new points
         double p0 = (std::isfinite(fMCMCprob[chain])) ? fMCMCprob[chain] : -std::numeric_limits<double>::max();
-        double p1 = LogEval(fMCMCThreadLocalStorage[chain].xLocal);
+        double p1;
+        {
+            ProfileTimer timer(ProfileTime(chain, kProfileLogEval));
+            p1 = LogEval(fMCMCThreadLocalStorage[chain].xLocal);
+        }
+        if (profile)
+            ++profile->n_evaluations;
 
         if (std::isfinite(p1)) {
             // if the new point is more probable, keep it; or else throw dice
             if (p1 >= p0 || log(fMCMCThreadLocalStorage[chain].rng->Rndm()) < (p1 - p0)) {
+                if (profile)
+                    ++profile->n_accepted;
                 // increase efficiency
                 fMCMCStatistics[chain].efficiency[0] += (1. - fMCMCStatistics[chain].efficiency[0]) / (fMCMCStatistics[chain].n_samples_efficiency + 1.);
 
@@ -1548,16 +1695,22 @@ bool BCEngineMCMC::GetNewPointMetropolis(unsigned chain)
                 MCMCCurrentPointInterface(fMCMCThreadLocalStorage[chain].xLocal, chain, true);
                 return true;
             } else {
+                if (profile)
+                    ++profile->n_rejected;
                 // decrease efficiency
                 fMCMCStatistics[chain].efficiency[0] *= 1.*fMCMCStatistics[chain].n_samples_efficiency / (fMCMCStatistics[chain].n_samples_efficiency + 1.);
             }
         } else { // new log(likelihood) was not a finite number
-            BCLog::OutDebug("LogEval is nan or inf at ");
-            PrintParameters(fMCMCThreadLocalStorage[chain].xLocal, BCLog::OutDebug);
+            if (profile)
+                ++profile->n_nonfinite;
+            BCLOG_LIMITED(debug, 100,
+                          BCLog::OutDebug("LogEval is nan or inf at ");
+                          PrintParameters(fMCMCThreadLocalStorage[chain].xLocal, BCLog::OutDebug));
             // decrease efficiency
             fMCMCStatistics[chain].efficiency[0] *= 1.*fMCMCStatistics[chain].n_samples_efficiency / (fMCMCStatistics[chain].n_samples_efficiency + 1.);
         }
-    }
+    } else if (profile)
+        ++profile->n_out_of_bounds;
 
     // execute user code for every point
     MCMCCurrentPointInterface(fMCMCThreadLocalStorage[chain].xLocal, chain, false);
@@ -1633,6 +1786,11 @@ void BCEngineMCMC::InChainFillHistograms()
                 if (dynamic_cast<TH2*>(fH2Marginalized[j][k]) != NULL)
                     fH2Marginalized[j][k]->Fill((j < GetNParameters()) ? fMCMCx[c][j] : fMCMCObservables[c][j - GetNParameters()],
                                                 (k < GetNParameters()) ? fMCMCx[c][k] : fMCMCObservables[c][k - GetNParameters()]);
+
+        ////////////////////////////////////////
+        // store values for 2-dimensional histograms built on request
+        for (std::map<unsigned, std::vector<double> >::iterator s = fH2OnDemandSamples.begin(); s != fH2OnDemandSamples.end(); ++s)
+            s->second.push_back((s->first < GetNParameters()) ? fMCMCx[c][s->first] : fMCMCObservables[c][s->first - GetNParameters()]);
     }
 }
 
@@ -1735,6 +1893,8 @@ bool BCEngineMCMC::MetropolisPreRun()
 
     unsigned nChecks = 0;
 
+    fMCMCProfilePreRun.assign(fMCMCNChains + 1, Profile());
+
     // While loop criteria---do while:
     //     not yet at maximum number of iterations
     // AND (    not yet above minimum number of iterations
@@ -1754,12 +1914,16 @@ bool BCEngineMCMC::MetropolisPreRun()
             EvaluateObservables();
 
             // update chain statistics
-            for (unsigned c = 0; c < fMCMCNChains; ++c)
+            for (unsigned c = 0; c < fMCMCNChains; ++c) {
+                ProfileTimer timer(ProfileTime(c, kProfileStatistics));
                 fMCMCStatistics[c].Update(fMCMCprob[c], fMCMCx[c], fMCMCObservables[c]);
+            }
 
             // update output tree
-            if (fMCMCFlagWritePreRunToFile)
+            if (fMCMCFlagWritePreRunToFile) {
+                ProfileTimer timer(ProfileTime(fMCMCNChains, kProfileFillTree));
                 InChainFillTree();
+            }
         }
 
         //////////////////////////////////////////
@@ -1880,6 +2044,8 @@ bool BCEngineMCMC::MetropolisPreRun()
         // Check convergence
         if (fMCMCNChains > 1) {
 
+            ProfileTimer timer(ProfileTime(fMCMCNChains, kProfileRValue));
+
             // Calculate & check R values
             fMCMCNIterationsConvergenceGlobal = fMCMCCurrentIteration;
             for (unsigned p = 0; p < GetNParameters(); ++p) {
@@ -1927,8 +2093,10 @@ bool BCEngineMCMC::MetropolisPreRun()
         }
 
         // Update multivariate proposal function covariances
-        if (fMCMCProposeMultivariate)
+        if (fMCMCProposeMultivariate) {
+            ProfileTimer timer(ProfileTime(fMCMCNChains, kProfileCholesky));
             UpdateCholeskyDecompositions();
+        }
 
         if (fMCMCCurrentIteration >= (int)fMCMCNIterationsPreRunMax)
             continue;
@@ -2122,6 +2290,8 @@ bool BCEngineMCMC::Metropolis()
 
     unsigned nwrite = UpdateFrequency(fMCMCNIterationsRun);
 
+    fMCMCProfileRun.assign(fMCMCNChains + 1, Profile());
+
     // start the run
     fMCMCCurrentIteration = 0;
     while (fMCMCCurrentIteration < (int)fMCMCNIterationsRun) {
@@ -2140,16 +2310,22 @@ bool BCEngineMCMC::Metropolis()
 
         MCMCUserIterationInterface();		// user action (overloadable)
 
-        for (unsigned c = 0; c < fMCMCNChains; ++c)
+        for (unsigned c = 0; c < fMCMCNChains; ++c) {
+            ProfileTimer timer(ProfileTime(c, kProfileStatistics));
             fMCMCStatistics[c].Update(fMCMCprob[c], fMCMCx[c], fMCMCObservables[c]);
+        }
 
         // fill histograms
-        if (!fH1Marginalized.empty() || !fH2Marginalized.empty())
+        if (!fH1Marginalized.empty() || !fH2Marginalized.empty()) {
+            ProfileTimer timer(ProfileTime(fMCMCNChains, kProfileFillHistograms));
             InChainFillHistograms();
+        }
 
         // write chain to file
-        if (fMCMCFlagWriteChainToFile)
+        if (fMCMCFlagWriteChainToFile) {
+            ProfileTimer timer(ProfileTime(fMCMCNChains, kProfileFillTree));
             InChainFillTree();
+        }
 
     } // end run
 
@@ -2233,6 +2409,8 @@ void BCEngineMCMC::ResetResults()
     fMCMCLogPrior_Provisional.clear();
     fMCMCNIterationsConvergenceGlobal = -1;
     fMCMCRValueParameters.clear();
+    fMCMCProfilePreRun.clear();
+    fMCMCProfileRun.clear();
 
     for (unsigned i = 0; i < fH1Marginalized.size(); ++i)
         delete fH1Marginalized[i];
@@ -2244,6 +2422,8 @@ void BCEngineMCMC::ResetResults()
     // clear plots
     fH1Marginalized.clear();
     fH2Marginalized.clear();
+    fH2OnDemandPairs.clear();
+    fH2OnDemandSamples.clear();
 
     // reset flags
     fMCMCFlagRun = false;
@@ -2257,6 +2437,9 @@ void BCEngineMCMC::MCMCInitialize()
     // reset phase
     fMCMCPhase = BCEngineMCMC::kUnsetPhase;
 
+    // print limited messages again in every run
+    BCLog::ResetMessageLimits();
+
     // reset convergence
     fMCMCNIterationsConvergenceGlobal = -1;
 
@@ -2486,6 +2669,8 @@ void BCEngineMCMC::CreateHistograms(bool rescale_ranges)
         for (unsigned j = 0; j < fH2Marginalized[i].size(); ++j)
             delete fH2Marginalized[i][j];
     fH2Marginalized.assign(GetNVariables(), std::vector<TH2*>(GetNVariables(), NULL));
+    fH2OnDemandPairs.clear();
+    fH2OnDemandSamples.clear();
 
     // store old bounds, rescale if rescaling:
     std::vector<std::pair<double, double> > original_bounds;
@@ -2541,37 +2726,26 @@ void BCEngineMCMC::CreateHistograms(bool rescale_ranges)
         unsigned i = (h->first >= 0)  ? h->first  : -(h->first + 1);
         unsigned j = (h->second >= 0) ? h->second : -(h->second + 1);
 
+        // convert to variable indices
         if (h->first >= 0) {
             if (i >= GetNParameters())
                 continue;
-
-            if (h->second >= 0) { // par vs par
-                if (j >= GetNParameters())
-                    continue;
-                fH2Marginalized[i][j] = GetParameter(i).CreateH2(Form("h2_%s_par_%i_vs_par_%i", GetSafeName().data(), j, i), GetParameter(j));
-
-            } else {              // obs vs par
-                if (j >= GetNObservables())
-                    continue;
-                fH2Marginalized[i][j + GetNParameters()] = GetParameter(i).CreateH2(Form("h2_%s_obs_%i_vs_par_%i", GetSafeName().data(), j, i), GetObservable(j));
-            }
-
         } else {
             if (i >= GetNObservables())
                 continue;
-
-            if (h->second >= 0) { // par vs obs
-                if (j >= GetNParameters())
-                    continue;
-                fH2Marginalized[i + GetNParameters()][j] = GetObservable(i).CreateH2(Form("h2_%s_par_%i_vs_obs_%i", GetSafeName().data(), j, i), GetParameter(j));
-
-            } else { // obs vs obs
-                if (j >= GetNObservables())
-                    continue;
-                fH2Marginalized[i + GetNParameters()][j + GetNParameters()] = GetObservable(i).CreateH2(Form("h2_%s_obs_%i_vs_obs_%i", GetSafeName().data(), j, i), GetObservable(j));
-            }
+            i += GetNParameters();
+        }
+        if (h->second >= 0) {
+            if (j >= GetNParameters())
+                continue;
+        } else {
+            if (j >= GetNObservables())
+                continue;
+            j += GetNParameters();
         }
-        ++filling;
+
+        if (BookH2(i, j))
+            ++filling;
     }
 
     // automatically produced combinations, using pars' and obvs' FillH2():
@@ -2583,16 +2757,12 @@ void BCEngineMCMC::CreateHistograms(bool rescale_ranges)
 
         // parameter j as ordinate
         for (unsigned j = i + 1; j < GetNParameters(); ++j)
-            if (!GetParameter(j).Fixed() && GetParameter(j).FillH2() && !fH2Marginalized[i][j]) {
-                fH2Marginalized[i][j] = GetParameter(i).CreateH2(Form("h2_%s_par_%i_vs_par_%i", GetSafeName().data(), j, i), GetParameter(j));
+            if (!GetParameter(j).Fixed() && GetParameter(j).FillH2() && BookH2(i, j))
                 ++filling;
-            }
         // user-defined observable j as ordinate
         for (unsigned j = 0; j < GetNObservables(); ++j)
-            if (GetObservable(j).FillH2() && !fH2Marginalized[i][j + GetNParameters()]) {
-                fH2Marginalized[i][j + GetNParameters()] = GetParameter(i).CreateH2(Form("h2_%s_obs_%i_vs_par_%i", GetSafeName().data(), j, i), GetObservable(j));
+            if (GetObservable(j).FillH2() && BookH2(i, j + GetNParameters()))
                 ++filling;
-            }
     }
 
     // user-defined observable i as abscissa
@@ -2602,10 +2772,21 @@ void BCEngineMCMC::CreateHistograms(bool rescale_ranges)
 
         // user-defined observable j as ordinate
         for (unsigned j = i + 1; j < GetNObservables(); ++j)
-            if (GetObservable(j).FillH2() && !fH2Marginalized[i + GetNParameters()][j + GetNParameters()]) {
-                fH2Marginalized[i + GetNParameters()][j + GetNParameters()] = GetObservable(i).CreateH2(Form("h2_%s_obs_%i_vs_obs_%i", GetSafeName().data(), j, i), GetObservable(j));
+            if (GetObservable(j).FillH2() && BookH2(i + GetNParameters(), j + GetNParameters()))
                 ++filling;
-            }
+    }
+
+    // store ranges and prepare storage of values for histograms built on request
+    if (!fH2OnDemandPairs.empty()) {
+        fH2OnDemandLimits.clear();
+        for (unsigned i = 0; i < GetNVariables(); ++i)
+            fH2OnDemandLimits.push_back(std::make_pair(GetVariable(i).GetLowerLimit(), GetVariable(i).GetUpperLimit()));
+        for (std::set<std::pair<unsigned, unsigned> >::const_iterator p = fH2OnDemandPairs.begin(); p != fH2OnDemandPairs.end(); ++p) {
+            fH2OnDemandSamples[p->first];
+            fH2OnDemandSamples[p->second];
+        }
+        for (std::map<unsigned, std::vector<double> >::iterator v = fH2OnDemandSamples.begin(); v != fH2OnDemandSamples.end(); ++v)
+            v->second.reserve(fMCMCNIterationsRun * fMCMCNChains);
     }
 
     if (filling == 0)	// if filling no 2D histograms, clear vector
@@ -2616,6 +2797,51 @@ void BCEngineMCMC::CreateHistograms(bool rescale_ranges)
         GetVariable(i).SetLimits(original_bounds[i].first, original_bounds[i].second);
 }
 
+// ---------------------------------------------------------
+std::string BCEngineMCMC::GetH2Name(unsigned i, unsigned j) const
+{
+    return Form("h2_%s_%s_%i_vs_%s_%i", GetSafeName().data(),
+                (j < GetNParameters()) ? "par" : "obs", (j < GetNParameters()) ? j : j - GetNParameters(),
+                (i < GetNParameters()) ? "par" : "obs", (i < GetNParameters()) ? i : i - GetNParameters());
+}
+
+// ---------------------------------------------------------
+bool BCEngineMCMC::BookH2(unsigned i, unsigned j)
+{
+    if (MarginalizedHistogramExists(i, j))
+        return false;
+
+    if (fH2OnDemand)
+        fH2OnDemandPairs.insert(std::make_pair(i, j));
+    else
+        fH2Marginalized[i][j] = GetVariable(i).CreateH2(GetH2Name(i, j), GetVariable(j));
+    return true;
+}
+
+// ---------------------------------------------------------
+TH2* BCEngineMCMC::CreateH2OnDemand(unsigned i, unsigned j) const
+{
+    // use the ranges the histograms were created with
+    BCVariable x(GetVariable(i));
+    BCVariable y(GetVariable(j));
+    if (i < fH2OnDemandLimits.size() && j < fH2OnDemandLimits.size()) {
+        x.SetLimits(fH2OnDemandLimits[i].first, fH2OnDemandLimits[i].second);
+        y.SetLimits(fH2OnDemandLimits[j].first, fH2OnDemandLimits[j].second);
+    }
+
+    TH2* h = x.CreateH2(GetH2Name(i, j), y);
+    // not owned by the current directory, which may be an output file
+    h->SetDirectory(0);
+
+    std::map<unsigned, std::vector<double> >::const_iterator vx = fH2OnDemandSamples.find(i);
+    std::map<unsigned, std::vector<double> >::const_iterator vy = fH2OnDemandSamples.find(j);
+    if (vx != fH2OnDemandSamples.end() && vy != fH2OnDemandSamples.end())
+        for (unsigned n = 0; n < vx->second.size() && n < vy->second.size(); ++n)
+            h->Fill(vx->second[n], vy->second[n]);
+
+    return h;
+}
+
 // ---------------------------------------------------------
 void BCEngineMCMC::PrintSummary() const
 {
@@ -2624,6 +2850,10 @@ void BCEngineMCMC::PrintSummary() const
     PrintBestFitSummary();
     BCLog::OutSummary("");
     PrintMarginalizationSummary();
+    if (!fMCMCProfilePreRun.empty() || !fMCMCProfileRun.empty()) {
+        BCLog::OutSummary("");
+        PrintProfileSummary();
+    }
 }
 
 // ---------------------------------------------------------
@@ -2759,6 +2989,39 @@ void BCEngineMCMC::PrintMarginalizationSummary() const
     }
 }
 
+// ---------------------------------------------------------
+void BCEngineMCMC::PrintProfileSummary() const
+{
+    BCLog::OutSummary(" Profile of the MCMC");
+    BCLog::OutSummary(" ===================");
+
+    const Phase phases[2] = { kPreRun, kMainRun };
+    for (unsigned p = 0; p < 2; ++p) {
+        if (GetProfileVector(phases[p]).empty())
+            continue;
+        Profile profile = GetProfile(phases[p]);
+
+        BCLog::OutSummary(phases[p] == kPreRun ? " Pre-run:" : " Main run:");
+        BCLog::OutSummary(Form("   Evaluations of the posterior:         %lu", profile.n_evaluations));
+        if (profile.n_evaluations > 0) {
+            BCLog::OutSummary(Form("   Accepted proposals:                   %lu (%4.1f %%)", profile.n_accepted, 100. * profile.n_accepted / profile.n_evaluations));
+            BCLog::OutSummary(Form("   Rejected proposals:                   %lu (%4.1f %%)", profile.n_rejected, 100. * profile.n_rejected / profile.n_evaluations));
+            BCLog::OutSummary(Form("   Proposals with nan or inf posterior:  %lu", profile.n_nonfinite));
+        }
+        BCLog::OutSummary(Form("   Proposals out of bounds:              %lu", profile.n_out_of_bounds));
+
+        double total = profile.GetTotalTime();
+        if (total <= 0)
+            continue;
+        BCLog::OutSummary(Form("   Time in timed stages:                 %.3g s", total));
+        for (unsigned s = 0; s < kNProfileStages; ++s)
+            if (profile.time[s] > 0)
+                BCLog::OutDetail(Form("     %-22s : %10.3g s  %5.1f %%", GetProfileStageName(static_cast<ProfileStage>(s)).data(), profile.time[s], 100. * profile.time[s] / total));
+        if (profile.n_evaluations > 0)
+            BCLog::OutDetail(Form("     time per evaluation    : %10.3g s", profile.time[kProfileLogEval] / profile.n_evaluations));
+    }
+}
+
 
 // ---------------------------------------------------------
 void BCEngineMCMC::PrintParameters(const std::vector<double>& P, void (*output)(const std::string&)) const
@@ -2851,7 +3114,7 @@ unsigned BCEngineMCMC::PrintAllMarginalized(const std::string& filename, unsigne
     for (unsigned k = 0; k < H2Coords.size(); ++k) {
         unsigned i = H2Coords[k].first;
         unsigned j = H2Coords[k].second;
-        if (fH2Marginalized[i][j]->Integral() == 0) { // histogram was never filled in range
+        if (GetMarginalizedHistogram(i, j)->Integral() == 0) { // histogram was never filled in range
             BCLog::OutWarning(Form("BCEngineMCMC::PrintAllMarginalized : 2D Marginalized histogram for \"%s\":\"%s\" is empty; printing is skipped.", GetVariable(i).GetName().data(), GetVariable(i).GetName().data()));
             continue;
         }
@@ -3165,10 +3428,10 @@ bool BCEngineMCMC::PrintCorrelationMatrix(const std::string& filename) const
             double corr_ij = std::numeric_limits<double>::infinity();
             if (std::isfinite(covar_ij) && std::isfinite(var_i) && std::isfinite(var_j))
                 corr_ij = covar_ij / sqrt(var_i * var_j);
-            else if (i < fH2Marginalized.size() && j < fH2Marginalized[i].size() && fH2Marginalized[i][j])
-                corr_ij = fH2Marginalized[i][j]->GetCorrelationFactor();
-            else if (j < fH2Marginalized.size() && i < fH2Marginalized[j].size() && fH2Marginalized[j][i])
-                corr_ij = fH2Marginalized[j][i]->GetCorrelationFactor();
+            else if (MarginalizedHistogramExists(i, j))
+                corr_ij = GetMarginalizedHistogram(i, j)->GetCorrelationFactor();
+            else if (MarginalizedHistogramExists(j, i))
+                corr_ij = GetMarginalizedHistogram(j, i)->GetCorrelationFactor();
             if (std::isfinite(corr_ij)) {
                 hist_corr->SetBinContent(i + 1, GetNVariables() - j, corr_ij);
                 hist_corr->SetBinContent(j + 1, GetNVariables() - i, corr_ij);
@@ -3795,3 +4058,105 @@ BCEngineMCMC::Statistics& BCEngineMCMC::Statistics::operator+=(const BCEngineMCM
 
     return *this;
 }
+
+// ---------------------------------------------------------
+BCEngineMCMC::Profile::Profile()
+{
+    Reset();
+}
+
+// ---------------------------------------------------------
+void BCEngineMCMC::Profile::Reset()
+{
+    n_evaluations = 0;
+    n_accepted = 0;
+    n_rejected = 0;
+    n_out_of_bounds = 0;
+    n_nonfinite = 0;
+    std::fill(time, time + kNProfileStages, 0.);
+}
+
+// ---------------------------------------------------------
+double BCEngineMCMC::Profile::GetTotalTime() const
+{
+    double total = 0;
+    for (unsigned s = 0; s < kNProfileStages; ++s)
+        total += time[s];
+    return total;
+}
+
+// ---------------------------------------------------------
+BCEngineMCMC::Profile& BCEngineMCMC::Profile::operator+=(const BCEngineMCMC::Profile& rhs)
+{
+    n_evaluations += rhs.n_evaluations;
+    n_accepted += rhs.n_accepted;
+    n_rejected += rhs.n_rejected;
+    n_out_of_bounds += rhs.n_out_of_bounds;
+    n_nonfinite += rhs.n_nonfinite;
+    for (unsigned s = 0; s < kNProfileStages; ++s)
+        time[s] += rhs.time[s];
+    return *this;
+}
+
+// ---------------------------------------------------------
+BCEngineMCMC::Profile BCEngineMCMC::GetProfile(BCEngineMCMC::Phase phase) const
+{
+    const std::vector<Profile>& profiles = GetProfileVector(phase);
+    Profile total;
+    for (unsigned i = 0; i < profiles.size(); ++i)
+        total += profiles[i];
+    return total;
+}
+
+// ---------------------------------------------------------
+std::string BCEngineMCMC::GetProfileStageName(BCEngineMCMC::ProfileStage stage)
+{
+    switch (stage) {
+        case kProfileLogEval:
+            return "posterior evaluation";
+        case kProfileProposal:
+            return "proposal";
+        case kProfileStatistics:
+            return "chain statistics";
+        case kProfileFillHistograms:
+            return "histogram filling";
+        case kProfileFillTree:
+            return "tree filling";
+        case kProfileRValue:
+            return "R-value check";
+        case kProfileCholesky:
+            return "covariance update";
+        default:
+            return "unknown";
+    }
+}
+
+// ---------------------------------------------------------
+BCEngineMCMC::Profile* BCEngineMCMC::CurrentProfile(unsigned chain)
+{
+    std::vector<Profile>* profiles = NULL;
+    if (fMCMCPhase == kPreRun)
+        profiles = &fMCMCProfilePreRun;
+    else if (fMCMCPhase == kMainRun)
+        profiles = &fMCMCProfileRun;
+
+    if (!profiles || chain >= profiles->size())
+        return NULL;
+    return &(*profiles)[chain];
+}
+
+// ---------------------------------------------------------
+double* BCEngineMCMC::ProfileTime(unsigned chain, BCEngineMCMC::ProfileStage stage)
+{
+#if PROFILING
+    if (fMCMCFlagProfiling) {
+        Profile* profile = CurrentProfile(chain);
+        if (profile)
+            return &profile->time[stage];
+    }
+#else
+    (void) chain;
+    (void) stage;
+#endif
+    return NULL;
+}
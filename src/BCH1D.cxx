@@ -133,10 +133,10 @@ std::vector<double> BCH1D::DefaultIntervals(int nbands)
 // ---------------------------------------------------------
 void BCH1D::DrawBands(const std::string& options)
 {
-    GetHistogram()->SetLineColor(GetLineColor());
-    GetHistogram()->Draw(options.data());
+    fHistogram->SetLineColor(GetLineColor());
+    fHistogram->Draw(options.data());
 
-    if ( fBandType == kNoBands or GetHistogram()->Integral() <= 0 )
+    if ( fBandType == kNoBands or fHistogram->Integral() <= 0 )
         return;
 
     std::vector<double> intervals = fIntervals;
@@ -165,7 +165,7 @@ void BCH1D::DrawBands(const std::string& options)
         std::string legend_text;
 
         if (fBandType == kSmallestInterval) {
-            hist_band = (TH1*) GetHistogram()->Clone((std::string(GetHistogram()->GetName()) + "_band").data());
+            hist_band = (TH1*) fHistogram->Clone((std::string(fHistogram->GetName()) + "_band").data());
             for (int b = 1; b <= hist_band->GetNbinsX(); ++b)
                 if (hist_band->GetBinContent(b) < bounds[i].first)
                     hist_band->SetBinContent(b, 0);
@@ -222,7 +222,7 @@ void BCH1D::DrawBands(const std::string& options)
         AddBandLegendEntry(fROOTObjects[i], "", "F");
 
     // redraw histogram
-    GetHistogram()->Draw(options.data());
+    fHistogram->Draw(options.data());
 }
 
 // ---------------------------------------------------------
@@ -245,7 +245,7 @@ void BCH1D::DrawQuantiles(const unsigned n)
     std::vector<double> p(n - 1, 0);
     for (unsigned i = 1; i < n; ++i)
         p[i - 1] = i * 1. / n;
-    if (GetHistogram()->GetQuantiles(n - 1, &q[0], &p[0]) != (int)n - 1)
+    if (fHistogram->GetQuantiles(n - 1, &q[0], &p[0]) != (int)n - 1)
         return;
 
     TLine* quantile_line = new TLine();
@@ -262,7 +262,7 @@ void BCH1D::DrawQuantiles(const unsigned n)
 
     // draw quantile lines
     for (unsigned i = 0; i < n - 1; ++i)
-        quantile_line->DrawLine(q[i], ymin, q[i], GetHistogram()->GetBinContent(GetHistogram()->FindFixBin(q[i])));
+        quantile_line->DrawLine(q[i], ymin, q[i], fHistogram->GetBinContent(fHistogram->FindFixBin(q[i])));
 
     std::string quantile_text;
     switch (n) {
@@ -330,7 +330,7 @@ void BCH1D::DrawMedian()
     TLegendEntry* le = 0;
     double q[2], p[2] = {0.1587, 0.8413};
 
-    if ( fDrawCentral68 and GetHistogram()->GetQuantiles(2, q, p) == 2 ) {
+    if ( fDrawCentral68 and fHistogram->GetQuantiles(2, q, p) == 2 ) {
         TArrow* arrow_ci = new TArrow(q[0], ymid * (fLogy ? pow(ymax / ymin, -0.1) : 0.8),
                                       q[1], ymid * (fLogy ? pow(ymax / ymin, -0.1) : 0.8),
                                       0.02 * gPad->GetWNDC(), "<|>");
@@ -350,65 +350,65 @@ void BCH1D::DrawMedian()
 // ---------------------------------------------------------
 TH1* BCH1D::GetSubHistogram(double min, double max, const std::string& name, bool preserve_range)
 {
-    if (min == max or !GetHistogram())
+    if (min == max or !fHistogram)
         return 0;
     if (min > max)
         return GetSubHistogram(max, min, name);
 
-    double xmin = GetHistogram()->GetXaxis()->GetXmin();
-    double xmax = GetHistogram()->GetXaxis()->GetXmax();
+    double xmin = fHistogram->GetXaxis()->GetXmin();
+    double xmax = fHistogram->GetXaxis()->GetXmax();
 
     if (max<xmin or min>xmax)
         return 0;
 
     std::string newName(name);
     if (name.empty())
-        newName = std::string(GetHistogram()->GetName()) + "_subhist";
+        newName = std::string(fHistogram->GetName()) + "_subhist";
 
     if ( min <= xmin and max >= xmax )
-        return (TH1*) GetHistogram()->Clone(name.data());
+        return (TH1*) fHistogram->Clone(name.data());
     min = std::max<double>(min, xmin);
     max = std::min<double>(max, xmax);
 
-    int imin = (min > xmin) ? GetHistogram()->FindFixBin(min) : 1;
-    int imax = (max < xmax) ? GetHistogram()->FindFixBin(max) : GetHistogram()->GetNbinsX();
+    int imin = (min > xmin) ? fHistogram->FindFixBin(min) : 1;
+    int imax = (max < xmax) ? fHistogram->FindFixBin(max) : fHistogram->GetNbinsX();
 
     // create binning for new histogram
-    std::vector<double> bins(GetHistogram()->GetNbinsX() + 2, 0);
+    std::vector<double> bins(fHistogram->GetNbinsX() + 2, 0);
     bins[0] = (preserve_range) ? xmin : min;
     int i0 = (preserve_range) ? 2 : imin + 1;
-    int i1 = (preserve_range) ? GetHistogram()->GetNbinsX() : imax;
+    int i1 = (preserve_range) ? fHistogram->GetNbinsX() : imax;
     unsigned n = 1;
     for (int i = i0; i <= i1; ++i) {
-        bins[n++] = GetHistogram()->GetXaxis()->GetBinLowEdge(i);
-        if (min > GetHistogram()->GetXaxis()->GetBinLowEdge(i) and min < GetHistogram()->GetXaxis()->GetBinUpEdge(i))
+        bins[n++] = fHistogram->GetXaxis()->GetBinLowEdge(i);
+        if (min > fHistogram->GetXaxis()->GetBinLowEdge(i) and min < fHistogram->GetXaxis()->GetBinUpEdge(i))
             bins[n++] = min;
-        if (max > GetHistogram()->GetXaxis()->GetBinLowEdge(i) and max < GetHistogram()->GetXaxis()->GetBinUpEdge(i))
+        if (max > fHistogram->GetXaxis()->GetBinLowEdge(i) and max < fHistogram->GetXaxis()->GetBinUpEdge(i))
             bins[n++] = max;
     }
-    if (preserve_range or max == GetHistogram()->GetXaxis()->GetBinUpEdge(i1))
-        bins[n++] = GetHistogram()->GetXaxis()->GetBinUpEdge(i1);
+    if (preserve_range or max == fHistogram->GetXaxis()->GetBinUpEdge(i1))
+        bins[n++] = fHistogram->GetXaxis()->GetBinUpEdge(i1);
 
     // now define the new histogram
-    TH1D* h0 = new TH1D(newName.data(), Form("%s;%s;%s", GetHistogram()->GetTitle(), GetHistogram()->GetXaxis()->GetTitle(), GetHistogram()->GetYaxis()->GetTitle()), n - 1, &bins[0]);
+    TH1D* h0 = new TH1D(newName.data(), Form("%s;%s;%s", fHistogram->GetTitle(), fHistogram->GetXaxis()->GetTitle(), fHistogram->GetYaxis()->GetTitle()), n - 1, &bins[0]);
     imin = h0->FindFixBin(min);
     imax = h0->FindFixBin(max);
     for (int i = imin; i <= imax; ++i)
-        h0->SetBinContent(i, GetHistogram()->GetBinContent(GetHistogram()->FindFixBin(h0->GetBinCenter(i))));
+        h0->SetBinContent(i, fHistogram->GetBinContent(fHistogram->FindFixBin(h0->GetBinCenter(i))));
     return h0;
 }
 
 // ---------------------------------------------------------
 void BCH1D::PrintSummary(const std::string& prefix, unsigned prec, std::vector<double> intervals)
 {
-    if (!GetHistogram())
+    if (!fHistogram)
         return;
 
     double p[7] = {5e-2, 10e-2, 16e-2, 50e-2, 84e-2, 90e-2, 95e-2};
     double q[7];
-    GetHistogram()->GetQuantiles(7, q, p);
+    fHistogram->GetQuantiles(7, q, p);
 
-    BCLog::OutSummary(prefix + Form("Mean +- sqrt(Variance):         %.*g +- %.*g", prec, GetHistogram()->GetMean(), prec, GetHistogram()->GetRMS()));
+    BCLog::OutSummary(prefix + Form("Mean +- sqrt(Variance):         %.*g +- %.*g", prec, fHistogram->GetMean(), prec, fHistogram->GetRMS()));
     BCLog::OutSummary(prefix + Form("Median +- central 68%% interval: %.*g +  %.*g - %.*g", prec, q[3], prec, q[4] - q[3], prec, q[2] - q[3]));
     BCLog::OutSummary(prefix + Form("(Marginalized) mode:            %.*g",  prec, GetLocalMode()));
     BCLog::OutSummary(prefix + Form("%2.0f%% quantile:                   %.*g", 100 * p[0], prec, q[0]));
@@ -441,20 +441,20 @@ std::vector<BCH1D::BCH1DSmallestInterval> BCH1D::GetSmallestIntervals(std::vecto
     for (unsigned i = 0; i < bounds.size(); ++i) {
         BCH1D::BCH1DSmallestInterval smallest_interval;
         smallest_interval.total_mass = 0;
-        for (int b = 1; b <= GetHistogram()->GetNbinsX(); ++b)
-            if (GetHistogram()->GetBinContent(b) >= bounds[i].first) {
+        for (int b = 1; b <= fHistogram->GetNbinsX(); ++b)
+            if (fHistogram->GetBinContent(b) >= bounds[i].first) {
                 BCH1D::BCH1DInterval interval;
-                interval.xmin = GetHistogram()->GetXaxis()->GetBinLowEdge(b);
-                interval.xmax = GetHistogram()->GetXaxis()->GetBinUpEdge(b);
-                interval.relative_height = GetHistogram()->GetBinContent(b);
-                interval.mode = GetHistogram()->GetBinCenter(b);
-                interval.relative_mass += GetHistogram()->Integral(b, b, "width");
-                while (b < GetHistogram()->GetNbinsX() and GetHistogram()->GetBinContent(b + 1) > bounds[i].first) {
-                    interval.xmax = GetHistogram()->GetXaxis()->GetBinUpEdge(++b);
-                    interval.relative_mass += GetHistogram()->Integral(b, b, "width");
-                    if (GetHistogram()->GetBinContent(b) > interval.relative_height) {
-                        interval.relative_height = GetHistogram()->GetBinContent(b);
-                        interval.mode = GetHistogram()->GetBinCenter(b);
+                interval.xmin = fHistogram->GetXaxis()->GetBinLowEdge(b);
+                interval.xmax = fHistogram->GetXaxis()->GetBinUpEdge(b);
+                interval.relative_height = fHistogram->GetBinContent(b);
+                interval.mode = fHistogram->GetBinCenter(b);
+                interval.relative_mass += fHistogram->GetBinContent(b) * fHistogram->GetXaxis()->GetBinWidth(b);
+                while (b < fHistogram->GetNbinsX() and fHistogram->GetBinContent(b + 1) > bounds[i].first) {
+                    interval.xmax = fHistogram->GetXaxis()->GetBinUpEdge(++b);
+                    interval.relative_mass += fHistogram->GetBinContent(b) * fHistogram->GetXaxis()->GetBinWidth(b);
+                    if (fHistogram->GetBinContent(b) > interval.relative_height) {
+                        interval.relative_height = fHistogram->GetBinContent(b);
+                        interval.mode = fHistogram->GetBinCenter(b);
                     }
                 }
                 smallest_interval.intervals.push_back(interval);
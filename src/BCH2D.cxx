@@ -91,7 +91,7 @@ std::vector<double> BCH2D::DefaultIntervals(int nbands)
 void BCH2D::DrawBands(const std::string& options)
 {
     if (fBandType == kNoBands) {
-        GetHistogram()->Draw((options + "colz").data());
+        fHistogram->Draw((options + "colz").data());
         gPad->Update();
         return;
     }
@@ -125,7 +125,7 @@ void BCH2D::DrawBands(const std::string& options)
                 levels.push_back(dens_mass[dens_mass.size() - i - 1].first);
                 legend_text.push_back(Form("smallest %.1f %% interval(s)", 100 * dens_mass[i].second));
             }
-            // levels.push_back(GetHistogram()->GetMaximum());
+            // levels.push_back(fHistogram->GetMaximum());
             break;
     }
 
@@ -139,15 +139,15 @@ void BCH2D::DrawBands(const std::string& options)
         colors.push_back(fBandColors[i]);
 
     // set contour levels
-    GetHistogram()->SetContour(levels.size(), &levels[0]);
+    fHistogram->SetContour(levels.size(), &levels[0]);
 
     if (fBandFillStyle <= 0) {
-        GetHistogram()->SetLineColor(GetLineColor());
-        GetHistogram()->Draw((options + "cont2").data());
+        fHistogram->SetLineColor(GetLineColor());
+        fHistogram->Draw((options + "cont2").data());
     } else {
         gStyle->SetPalette(colors.size(), &colors[0]);
-        GetHistogram()->SetFillStyle(fBandFillStyle);
-        GetHistogram()->Draw((options + "cont").data());
+        fHistogram->SetFillStyle(fBandFillStyle);
+        fHistogram->Draw((options + "cont").data());
     }
     gPad->Update();
 
@@ -178,9 +178,11 @@ void BCH2D::DrawMarkers()
 // ---------------------------------------------------------
 TGraph* BCH2D::CalculateProfileGraph(BCH2DProfileAxis axis, BCH2DProfileType bt)
 {
+    // read the histogram directly, which keeps the smallest-interval cache
+    TH2* hist = static_cast<TH2*>(fHistogram);
 
-    unsigned n_i = (axis == kProfileY) ? GetHistogram()->GetNbinsY() : GetHistogram()->GetNbinsX();
-    unsigned n_j = (axis == kProfileY) ? GetHistogram()->GetNbinsX() : GetHistogram()->GetNbinsY();
+    unsigned n_i = (axis == kProfileY) ? hist->GetNbinsY() : hist->GetNbinsX();
+    unsigned n_j = (axis == kProfileY) ? hist->GetNbinsX() : hist->GetNbinsY();
 
     TGraph* g = new TGraph();
 
@@ -192,19 +194,19 @@ TGraph* BCH2D::CalculateProfileGraph(BCH2DProfileAxis axis, BCH2DProfileType bt)
             case kProfileMedian: {
 
                 // calculate 50% of total probability mass in slice
-                double median_prob = 0.5 * ((axis == kProfileY) ? GetHistogram()->Integral(1, n_j, i, i, "width") : GetHistogram()->Integral(i, i, 1, n_j, "width"));
+                double median_prob = 0.5 * ((axis == kProfileY) ? hist->Integral(1, n_j, i, i, "width") : hist->Integral(i, i, 1, n_j, "width"));
                 if (median_prob <= 0)
                     break;
 
                 double prob_sum = 0;
                 // loop until 50% of probability mass is found
                 for (unsigned j = 1; j <= n_j; ++j) {
-                    prob_sum += (axis == kProfileY) ? GetHistogram()->Integral(j, j, i, i, "width") : GetHistogram()->Integral(i, i, j, j, "width");
+                    prob_sum += (axis == kProfileY) ? hist->Integral(j, j, i, i, "width") : hist->Integral(i, i, j, j, "width");
                     if (prob_sum > median_prob) {
                         if (axis == kProfileY)
-                            g->SetPoint(g->GetN(), GetHistogram()->GetXaxis()->GetBinLowEdge(j), GetHistogram()->GetYaxis()->GetBinCenter(i));
+                            g->SetPoint(g->GetN(), hist->GetXaxis()->GetBinLowEdge(j), hist->GetYaxis()->GetBinCenter(i));
                         else
-                            g->SetPoint(g->GetN(), GetHistogram()->GetXaxis()->GetBinCenter(i), GetHistogram()->GetYaxis()->GetBinLowEdge(j));
+                            g->SetPoint(g->GetN(), hist->GetXaxis()->GetBinCenter(i), hist->GetYaxis()->GetBinLowEdge(j));
                         break;
                     }
                 }
@@ -215,7 +217,7 @@ TGraph* BCH2D::CalculateProfileGraph(BCH2DProfileAxis axis, BCH2DProfileType bt)
                 double max_val = 0;
                 unsigned j_max_val = 0;
                 for (unsigned j = 1; j <= n_j; ++j) {
-                    double val = (axis == kProfileY) ? GetHistogram()->GetBinContent(j, i) : GetHistogram()->GetBinContent(i, j);
+                    double val = (axis == kProfileY) ? hist->GetBinContent(j, i) : hist->GetBinContent(i, j);
                     if (val > max_val) {
                         j_max_val = j;
                         max_val = val;
@@ -223,9 +225,9 @@ TGraph* BCH2D::CalculateProfileGraph(BCH2DProfileAxis axis, BCH2DProfileType bt)
                 }
                 if (j_max_val > 0) {
                     if (axis == kProfileY)
-                        g->SetPoint(g->GetN(), GetHistogram()->GetXaxis()->GetBinCenter(j_max_val), GetHistogram()->GetYaxis()->GetBinCenter(i));
+                        g->SetPoint(g->GetN(), hist->GetXaxis()->GetBinCenter(j_max_val), hist->GetYaxis()->GetBinCenter(i));
                     else
-                        g->SetPoint(g->GetN(), GetHistogram()->GetXaxis()->GetBinCenter(i), GetHistogram()->GetYaxis()->GetBinCenter(j_max_val));
+                        g->SetPoint(g->GetN(), hist->GetXaxis()->GetBinCenter(i), hist->GetYaxis()->GetBinCenter(j_max_val));
                 }
                 break;
             }
@@ -236,15 +238,15 @@ TGraph* BCH2D::CalculateProfileGraph(BCH2DProfileAxis axis, BCH2DProfileType bt)
                 double mass_sum = 0;
                 double sum = 0 ;
                 for (unsigned j = 0; j <= n_j; ++j) {
-                    double mass = (axis == kProfileY) ? GetHistogram()->Integral(j, j, i, i, "width") : GetHistogram()->Integral(i, i, j, j, "width");
+                    double mass = (axis == kProfileY) ? hist->Integral(j, j, i, i, "width") : hist->Integral(i, i, j, j, "width");
                     mass_sum += mass;
-                    sum += mass * ((axis == kProfileY) ? GetHistogram()->GetXaxis()->GetBinCenter(j) : GetHistogram()->GetYaxis()->GetBinCenter(j));
+                    sum += mass * ((axis == kProfileY) ? hist->GetXaxis()->GetBinCenter(j) : hist->GetYaxis()->GetBinCenter(j));
                 }
                 if (mass_sum >= 0) {
                     if (axis == kProfileY)
-                        g->SetPoint(g->GetN(), sum / mass_sum, GetHistogram()->GetYaxis()->GetBinCenter(i));
+                        g->SetPoint(g->GetN(), sum / mass_sum, hist->GetYaxis()->GetBinCenter(i));
                     else
-                        g->SetPoint(g->GetN(), GetHistogram()->GetXaxis()->GetBinCenter(i), sum / mass_sum);
+                        g->SetPoint(g->GetN(), hist->GetXaxis()->GetBinCenter(i), sum / mass_sum);
                 }
                 break;
             }
@@ -181,12 +181,18 @@ void swap(BCHistogramBase& first, BCHistogramBase& second)
     std::swap(first.fBandOvercoverage,      second.fBandOvercoverage);
     std::swap(first.fIntervals,             second.fIntervals);
     std::swap(first.fROOToptions,           second.fROOToptions);
+
+    // swap cached smallest-interval tables
+    std::swap(first.fSmallestIntervalDensities, second.fSmallestIntervalDensities);
+    std::swap(first.fSmallestIntervalMasses,    second.fSmallestIntervalMasses);
+    std::swap(first.fSmallestIntervalSizes,     second.fSmallestIntervalSizes);
 }
 
 // ---------------------------------------------------------
 void BCHistogramBase::SetHistogram(const TH1* const hist)
 {
     delete fHistogram;
+    ClearSmallestIntervalCache();
 
     if (!hist or (fDimension >= 0 and hist->GetDimension() != fDimension)) {
         fHistogram = 0;
@@ -200,26 +206,26 @@ void BCHistogramBase::SetHistogram(const TH1* const hist)
     fDimension = fHistogram->GetDimension();
 
     // normalize; TO DO: replace with division of each bin by width/area for arbitrary binning
-    double integral = GetHistogram()->Integral("width");
+    double integral = fHistogram->Integral("width");
     if (integral != 0)
-        GetHistogram()->Scale(1. / integral);
+        fHistogram->Scale(1. / integral);
 
     // Get local mode
-    int b = GetHistogram()->GetMaximumBin();
+    int b = fHistogram->GetMaximumBin();
     int bx, by, bz;
-    GetHistogram()->GetBinXYZ(b, bx, by, bz);
-    fLocalMode.assign(1, GetHistogram()->GetXaxis()->GetBinCenter(bx));
+    fHistogram->GetBinXYZ(b, bx, by, bz);
+    fLocalMode.assign(1, fHistogram->GetXaxis()->GetBinCenter(bx));
     if (by > 0)
-        fLocalMode.push_back(GetHistogram()->GetYaxis()->GetBinCenter(by));
+        fLocalMode.push_back(fHistogram->GetYaxis()->GetBinCenter(by));
     if (bz > 0)
-        fLocalMode.push_back(GetHistogram()->GetZaxis()->GetBinCenter(bz));
+        fLocalMode.push_back(fHistogram->GetZaxis()->GetBinCenter(bz));
 
-    GetHistogram()->GetXaxis()->SetNdivisions(508);
+    fHistogram->GetXaxis()->SetNdivisions(508);
     // Set Y title, if 1D
-    // if (GetHistogram()->GetDimension()==1 and strlen(GetHistogram()->GetYaxis()->GetTitle())==0)
-    // 	GetHistogram()->SetYTitle(TString::Format("P(%s|Data)",GetHistogram()->GetXaxis()->GetTitle()));
-    if (GetHistogram()->GetDimension() > 1)
-        GetHistogram()->GetYaxis()->SetNdivisions(508);
+    // if (fHistogram->GetDimension()==1 and strlen(fHistogram->GetYaxis()->GetTitle())==0)
+    // 	fHistogram->SetYTitle(TString::Format("P(%s|Data)",fHistogram->GetXaxis()->GetTitle()));
+    if (fHistogram->GetDimension() > 1)
+        fHistogram->GetYaxis()->SetNdivisions(508);
 }
 
 // ---------------------------------------------------------
@@ -294,16 +300,17 @@ void BCHistogramBase::Smooth(int n)
         n = fNSmooth;
     if (n <= 0)
         return;
-    GetHistogram()->Scale(GetHistogram()->Integral("width"));
-    if (GetHistogram()->GetDimension() == 1) {
-        if (GetHistogram()->GetNbinsX() >= 3)
-            GetHistogram()->Smooth(n);
+    ClearSmallestIntervalCache();
+    fHistogram->Scale(fHistogram->Integral("width"));
+    if (fHistogram->GetDimension() == 1) {
+        if (fHistogram->GetNbinsX() >= 3)
+            fHistogram->Smooth(n);
     } else // ROOT currently only allows single instances of smoothing for TH2
         for (int i = 0; i < n; ++i)
-            GetHistogram()->Smooth(1);
-    double integral = GetHistogram()->Integral("width");
+            fHistogram->Smooth(1);
+    double integral = fHistogram->Integral("width");
     if ( integral != 0 )
-        GetHistogram()->Scale(1. / integral);
+        fHistogram->Scale(1. / integral);
 }
 
 // ---------------------------------------------------------
@@ -350,25 +357,25 @@ std::vector<double> BCHistogramBase::DefaultIntervals(int nbands)
 // ---------------------------------------------------------
 void BCHistogramBase::GetNonzeroBinDensityMassVector(std::vector<std::pair<double, double> >& bin_dens_mass, int sort)
 {
-    if (!GetHistogram())
+    if (!fHistogram)
         return;
 
     // calculate number of bins
-    unsigned nbins = GetHistogram()->GetBin(GetHistogram()->GetNbinsX(), GetHistogram()->GetNbinsY(), GetHistogram()->GetNbinsZ());
+    unsigned nbins = fHistogram->GetBin(fHistogram->GetNbinsX(), fHistogram->GetNbinsY(), fHistogram->GetNbinsZ());
 
     // reserve space
     bin_dens_mass.reserve(nbins);
 
     // fill bin_dens_mass with pairs of (prob. density, prob. mass) for all non-empty bins
     for (unsigned i = 1; i <= nbins; ++i)
-        if (!GetHistogram()->IsBinUnderflow(i) and !GetHistogram()->IsBinOverflow(i) and GetHistogram()->GetBinContent(i) > 0) {
+        if (!fHistogram->IsBinUnderflow(i) and !fHistogram->IsBinOverflow(i) and fHistogram->GetBinContent(i) > 0) {
             // if 1D, by = bz = -1; if 2D, bz = -1
             int bx, by, bz;
-            GetHistogram()->GetBinXYZ(i, bx, by, bz);
+            fHistogram->GetBinXYZ(i, bx, by, bz);
             // bin val
-            double v = GetHistogram()->GetBinContent(i);
+            double v = fHistogram->GetBinContent(i);
             // bin width / area / volume
-            double w = (bx > 0 ? GetHistogram()->GetXaxis()->GetBinWidth(bx) : 1) * (by > 0 ? GetHistogram()->GetYaxis()->GetBinWidth(by) : 1) * (bz > 0 ? GetHistogram()->GetZaxis()->GetBinWidth(bz) : 1);
+            double w = (bx > 0 ? fHistogram->GetXaxis()->GetBinWidth(bx) : 1) * (by > 0 ? fHistogram->GetYaxis()->GetBinWidth(by) : 1) * (bz > 0 ? fHistogram->GetZaxis()->GetBinWidth(bz) : 1);
             bin_dens_mass.push_back(std::make_pair(v, v * w));
         }
     // sort
@@ -378,53 +385,79 @@ void BCHistogramBase::GetNonzeroBinDensityMassVector(std::vector<std::pair<doubl
         std::stable_sort(bin_dens_mass.begin(), bin_dens_mass.end(), std::less<std::pair<double, double> >());
 }
 
+// ---------------------------------------------------------
+void BCHistogramBase::ClearSmallestIntervalCache()
+{
+    fSmallestIntervalDensities.clear();
+    fSmallestIntervalMasses.clear();
+    fSmallestIntervalSizes.clear();
+}
+
+// ---------------------------------------------------------
+void BCHistogramBase::FillSmallestIntervalCache()
+{
+    if (!fSmallestIntervalDensities.empty() or !fHistogram)
+        return;
+
+    std::vector<std::pair<double, double> > bin_dens_mass;
+    GetNonzeroBinDensityMassVector(bin_dens_mass, -1); // sorted in decreasing order
+
+    fSmallestIntervalDensities.reserve(bin_dens_mass.size());
+    fSmallestIntervalMasses.reserve(bin_dens_mass.size());
+    fSmallestIntervalSizes.reserve(bin_dens_mass.size());
+
+    // consolidate bins by density and accumulate
+    double mass = 0;
+    double size = 0;
+    for (unsigned i = 0; i < bin_dens_mass.size(); ++i) {
+        double dens = bin_dens_mass[i].first;
+        double level_mass = bin_dens_mass[i].second;
+        while (i + 1 < bin_dens_mass.size() and bin_dens_mass[i + 1].first == dens)
+            level_mass += bin_dens_mass[++i].second;
+        mass += level_mass;
+        size += level_mass / dens;
+        fSmallestIntervalDensities.push_back(dens);
+        fSmallestIntervalMasses.push_back(mass);
+        fSmallestIntervalSizes.push_back(size);
+    }
+}
+
 // ---------------------------------------------------------
 std::vector<std::pair<double, double> > BCHistogramBase::GetSmallestIntervalBounds(std::vector<double> masses, bool overcoverage)
 {
     std::vector<std::pair<double, double> > levels;
 
     // if no masses asked for or no histogram set, return empty vector
-    if (masses.empty() or !GetHistogram())
+    if (masses.empty() or !fHistogram)
         return levels;
 
     // check and sort masses to decreasing order
     CheckIntervals(masses, -1);
 
+    FillSmallestIntervalCache();
+    const std::vector<double>& dens = fSmallestIntervalDensities;
+    const std::vector<double>& cumulative = fSmallestIntervalMasses;
+    if (dens.empty())
+        return levels;
+
     // reserce space in the levels vector
     levels.reserve(masses.size());
 
-    std::vector<std::pair<double, double> > bin_dens_mass;
-    GetNonzeroBinDensityMassVector(bin_dens_mass, -1); // sorted in decreasing order
-
-    // consolidate bins by density
-    std::vector<std::pair<double, double> > dens_mass;
-    dens_mass.reserve(bin_dens_mass.size());
-    for (unsigned i = 0; i < bin_dens_mass.size(); ++i) {
-        dens_mass.push_back(bin_dens_mass[i]);
-        while (i < bin_dens_mass.size() - 1 and bin_dens_mass[i + 1].first == dens_mass.back().first)
-            dens_mass.back().second += bin_dens_mass[++i].second;
-    }
-
-    if (overcoverage) {
-        double prob_sum = 0;
-        for (unsigned i = 0; i < dens_mass.size() and !masses.empty() and prob_sum <= 1; ++i) {
-            prob_sum += dens_mass[i].second;
-            while (!masses.empty() and prob_sum >= masses.back()) {
-                levels.push_back(std::make_pair(dens_mass[i].first, prob_sum));
-                masses.pop_back();
-            }
-        }
-    }	else { // undercoverage
-        // remove mass levels that cannot be undercovered
-        double prob_sum = dens_mass.front().second;
-        while (!masses.empty() and masses.back() < prob_sum)
-            masses.pop_back();
-        for (unsigned i = 1; i < dens_mass.size() and !masses.empty() and prob_sum <= 1; ++i) {
-            prob_sum += dens_mass[i].second;
-            while (!masses.empty() and prob_sum >= masses.back()) {
-                levels.push_back(std::make_pair(dens_mass[i - 1].first, prob_sum - dens_mass[i].second));
-                masses.pop_back();
-            }
+    // in increasing order of mass
+    for (std::vector<double>::const_reverse_iterator m = masses.rbegin(); m != masses.rend(); ++m) {
+        // first density level containing at least the mass
+        unsigned i = std::lower_bound(cumulative.begin(), cumulative.end(), *m) - cumulative.begin();
+
+        if (overcoverage) {
+            if (i < cumulative.size())
+                levels.push_back(std::make_pair(dens[i], cumulative[i]));
+        } else { // undercoverage
+            // mass levels below the highest bin cannot be undercovered
+            if (*m < cumulative.front())
+                continue;
+            i = std::max(i, 1u);
+            if (i < cumulative.size())
+                levels.push_back(std::make_pair(dens[i - 1], cumulative[i - 1]));
         }
     }
 
@@ -451,23 +484,22 @@ std::vector<double> BCHistogramBase::GetSmallestIntervalSize(std::vector<double>
     if (masses.empty())
         return S;
 
-    std::vector<std::pair<double, double> > bin_dens_mass;
-    GetNonzeroBinDensityMassVector(bin_dens_mass, -1); // sorted in decreasing order
-
-    if (bin_dens_mass.empty())
+    FillSmallestIntervalCache();
+    const std::vector<double>& dens = fSmallestIntervalDensities;
+    const std::vector<double>& cumulative = fSmallestIntervalMasses;
+    const std::vector<double>& sizes = fSmallestIntervalSizes;
+    if (dens.empty())
         return S;
 
+    // interpolate linearly within the density level containing the mass
     S.assign(masses.size(), 0);
-    double mass = 0;
-    double area = 0;
-    unsigned n = 0;
-    for (std::vector<std::pair<double, double> >::const_iterator bin = bin_dens_mass.begin(); bin != bin_dens_mass.end() and n < S.size(); ++bin) {
-        for (unsigned i = 0; i < masses.size(); ++i)
-            if (mass + bin->second >= masses[i] and mass <= masses[i]) {
-                S[i] = area + (masses[i] - mass) / bin->first;
-                ++n;
-            }
-        area += bin->second / bin->first;
+    for (unsigned j = 0; j < masses.size(); ++j) {
+        unsigned i = std::lower_bound(cumulative.begin(), cumulative.end(), masses[j]) - cumulative.begin();
+        if (i >= cumulative.size())
+            continue;
+        double mass = (i > 0) ? cumulative[i - 1] : 0;
+        double area = (i > 0) ? sizes[i - 1] : 0;
+        S[j] = area + (masses[j] - mass) / dens[i];
     }
     return S;
 }
@@ -484,10 +516,10 @@ double BCHistogramBase::GetSmallestIntervalSize(double mass, bool overcoverage)
 // ---------------------------------------------------------
 void BCHistogramBase::Draw()
 {
-    if (!GetHistogram())
+    if (!fHistogram)
         return;
 
-    GetHistogram()->SetStats(fDrawStats);
+    fHistogram->SetStats(fDrawStats);
     fLegend.SetNColumns(fNLegendColumns);
 
     Smooth(fNSmooth);
@@ -500,7 +532,7 @@ void BCHistogramBase::Draw()
         gPad->SetLogz(fLogz);
         gPad->SetGridx(fGridx);
         gPad->SetGridy(fGridy);
-        GetHistogram()->Draw("axis");
+        fHistogram->Draw("axis");
         gPad->Update();
         options += "same";
     }
@@ -536,7 +568,7 @@ void BCHistogramBase::DrawGlobalMode()
         ymax = pow(10, ymax);
         y = ymin * pow(ymax / ymin, 0.5);
     }
-    if (GetHistogram()->GetDimension() > 1 and fGlobalMode.size() > 1)
+    if (fHistogram->GetDimension() > 1 and fGlobalMode.size() > 1)
         y = fGlobalMode[1];
 
     if (fDrawGlobalMode and !fGlobalMode.empty()) {
@@ -560,7 +592,7 @@ void BCHistogramBase::DrawGlobalMode()
             arrow_mode->Draw();
             fROOTObjects.push_back(arrow_mode);
 
-            if (GetHistogram()->GetDimension() > 1 and fGlobalMode.size() > 1) {
+            if (fHistogram->GetDimension() > 1 and fGlobalMode.size() > 1) {
                 double xmin = gPad->GetUxmin();
                 double xmax = gPad->GetUxmax();
                 if (gPad->GetLogx()) {
@@ -592,7 +624,7 @@ void BCHistogramBase::DrawLocalMode()
         ymax = pow(10, ymax);
         y = ymin * pow(ymax / ymin, 0.25);
     }
-    if (GetHistogram()->GetDimension() > 1 and fLocalMode.size() > 1)
+    if (fHistogram->GetDimension() > 1 and fLocalMode.size() > 1)
         y = fLocalMode[1];
 
     if (fDrawLocalMode and !fLocalMode.empty()) {
@@ -616,7 +648,7 @@ void BCHistogramBase::DrawLocalMode()
             arrow_mode->Draw();
             fROOTObjects.push_back(arrow_mode);
 
-            if (GetHistogram()->GetDimension() > 1 and fLocalMode.size() > 1) {
+            if (fHistogram->GetDimension() > 1 and fLocalMode.size() > 1) {
                 double xmin = gPad->GetUxmin();
                 double xmax = gPad->GetUxmax();
                 if (gPad->GetLogx()) {
@@ -648,11 +680,11 @@ void BCHistogramBase::DrawMean()
         ymax = pow(10, ymax);
         y = ymin * pow(ymax / ymin, 60e-2);
     }
-    if (GetHistogram()->GetDimension() > 1)
-        y = GetHistogram()->GetMean(2);
+    if (fHistogram->GetDimension() > 1)
+        y = fHistogram->GetMean(2);
 
     if ( fDrawMean ) {
-        TMarker* marker_mean = new TMarker(GetHistogram()->GetMean(1), y, fMeanMarkerStyle);
+        TMarker* marker_mean = new TMarker(fHistogram->GetMean(1), y, fMeanMarkerStyle);
         marker_mean->SetMarkerColor(GetMarkerColor());
         marker_mean->SetMarkerSize(fMarkerScale * gPad->GetWNDC());
         marker_mean->Draw();
@@ -660,8 +692,8 @@ void BCHistogramBase::DrawMean()
 
         TLegendEntry* le = 0;
         if ( fDrawStandardDeviation ) {
-            TArrow* arrow_std = new TArrow(marker_mean->GetX() - GetHistogram()->GetRMS(1), marker_mean->GetY(),
-                                           marker_mean->GetX() + GetHistogram()->GetRMS(1), marker_mean->GetY(),
+            TArrow* arrow_std = new TArrow(marker_mean->GetX() - fHistogram->GetRMS(1), marker_mean->GetY(),
+                                           marker_mean->GetX() + fHistogram->GetRMS(1), marker_mean->GetY(),
                                            0.02 * gPad->GetWNDC(), "<|>");
             arrow_std->SetLineColor(marker_mean->GetMarkerColor());
             arrow_std->SetFillColor(marker_mean->GetMarkerColor());
@@ -669,9 +701,9 @@ void BCHistogramBase::DrawMean()
             le = AddLegendEntry(arrow_std, "mean and std. dev.", "PL");
             le->SetLineColor(arrow_std->GetLineColor());
 
-            if (GetHistogram()->GetDimension() > 1) {
-                TArrow* arrow_std2 = new TArrow(marker_mean->GetX(), marker_mean->GetY() - GetHistogram()->GetRMS(2),
-                                                marker_mean->GetX(), marker_mean->GetY() + GetHistogram()->GetRMS(2),
+            if (fHistogram->GetDimension() > 1) {
+                TArrow* arrow_std2 = new TArrow(marker_mean->GetX(), marker_mean->GetY() - fHistogram->GetRMS(2),
+                                                marker_mean->GetX(), marker_mean->GetY() + fHistogram->GetRMS(2),
                                                 0.02 * gPad->GetWNDC(), "<|>");
                 arrow_std2->SetLineColor(marker_mean->GetMarkerColor());
                 arrow_std2->SetFillColor(marker_mean->GetMarkerColor());
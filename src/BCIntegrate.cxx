@@ -740,6 +740,8 @@ int BCIntegrate::MarginalizeAll()
             // set all pointers to zero
             fH1Marginalized.assign(GetNParameters(), NULL);
             fH2Marginalized.assign(GetNParameters(), std::vector<TH2*>(GetNParameters(), NULL));
+            fH2OnDemandPairs.clear();
+            fH2OnDemandSamples.clear();
 
             // count how often posterior is evaluated
             unsigned nIterations = 0;
@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
 
 std::ofstream BCLog::fOutputStream;
@@ -27,6 +28,8 @@ BCLog::LogLevel BCLog::fMinimumLogLevelScreen = BCLog::summary;
 
 bool BCLog::fFirstOutputDone = false;
 
+unsigned BCLog::fMessageEpoch = 0;
+
 std::string BCLog::fVersion = VERSION;
 
 // ---------------------------------------------------------
@@ -64,20 +67,57 @@ void BCLog::OpenLog(const std::string& filename, BCLog::LogLevel loglevelfile, B
 
 void BCLog::Out(BCLog::LogLevel loglevelfile, BCLog::LogLevel loglevelscreen, const std::string& message)
 {
-    // if this is the first call to Out(), call StartupInfo() first
-    if (!fFirstOutputDone)
-        BCLog::StartupInfo();
-
-    // open log file if not opened
-    if (BCLog::IsOpen()) {
-        // write message in to log file
-        if (loglevelfile >= BCLog::fMinimumLogLevelFile)
-            BCLog::fOutputStream << BCLog::ToString(loglevelfile) << " : " << message << std::endl;
+    const bool to_screen = loglevelscreen >= BCLog::fMinimumLogLevelScreen;
+    const bool to_file = loglevelfile >= BCLog::fMinimumLogLevelFile;
+    if (!to_screen && !to_file && fFirstOutputDone)
+        return;
+
+    // compose the lines in the calling thread, so the lock is only held for writing them
+    const std::string line_file = to_file ? BCLog::ToString(loglevelfile) + " : " + message + "\n" : "";
+    const std::string line_screen = to_screen ? BCLog::ToString(loglevelscreen) + " : " + message + "\n" : "";
+
+    // one message at a time, e.g. from models running concurrently
+    #pragma omp critical(BCLog__Out)
+    {
+        // if this is the first call to Out(), call StartupInfo() first
+        if (!fFirstOutputDone)
+            BCLog::StartupInfo();
+
+        // open log file if not opened
+        if (to_file && BCLog::IsOpen())
+            // write message in to log file
+            BCLog::fOutputStream << line_file << std::flush;
+
+        // write message to screen
+        if (to_screen)
+            std::cout << line_screen << std::flush;
     }
+}
 
-    // write message to screen
-    if (loglevelscreen >= BCLog::fMinimumLogLevelScreen)
-        std::cout << BCLog::ToString(loglevelscreen) << " : " << message << std::endl;
+// ---------------------------------------------------------
+
+unsigned BCLog::CountMessage(unsigned& counter, unsigned& epoch)
+{
+    unsigned n;
+    #pragma omp critical(BCLog__CountMessage)
+    {
+        if (epoch != fMessageEpoch) {
+            epoch = fMessageEpoch;
+            counter = 0;
+        }
+        if (counter < std::numeric_limits<unsigned>::max())
+            ++counter;
+        n = counter;
+    }
+    return n;
+}
+
+// ---------------------------------------------------------
+
+void BCLog::ResetMessageLimits()
+{
+    #pragma omp critical(BCLog__CountMessage)
+    ++fMessageEpoch;
 }
 
 // ---------------------------------------------------------
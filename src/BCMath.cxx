@@ -8,6 +8,8 @@
 
 // ---------------------------------------------------------
 
+#include <config.h>
+
 #include "BCMath.h"
 
 #include "BCLog.h"
@@ -17,8 +19,15 @@
 #include <TMath.h>
 #include <TRandom3.h>
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <math.h>
+#include <stdint.h>
+
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
 
 // ---------------------------------------------------------
 double BCMath::LogGaus(double x, double mean, double sigma, bool norm)
@@ -101,9 +110,23 @@ double BCMath::ApproxBinomial(unsigned n, unsigned k, double p)
 namespace
 {
 /**
- * Vector of cached log factorials.
+ * Table of log factorials, log(n!) for n = 0, 1, ... Tables are
+ * never modified after publication, so they can be read from many
+ * threads at once; CacheFactorials() publishes a larger copy instead.
+ * The pointer is zero-initialized before any dynamic initialization.
  * Hidden in anonymous namespace. */
-static std::vector<double> CachedLogFactorials;
+static const std::vector<double>* CachedLogFactorials = 0;
+
+/**
+ * The acquire load pairs with the release store in CacheFactorials():
+ * a thread that sees the new pointer also sees the complete table.
+ * @return The current table of log factorials; never NULL. */
+const std::vector<double>& LogFactorialTable()
+{
+    static const std::vector<double> empty;
+    const std::vector<double>* table = __atomic_load_n(&CachedLogFactorials, __ATOMIC_ACQUIRE);
+    return table ? *table : empty;
+}
 }
 
 // ---------------------------------------------------------
@@ -118,7 +141,7 @@ double BCMath::LogBinomFactor(unsigned n, unsigned k)
         return log((double)n);
 
     // if no approximation needed
-    if ( n < CachedLogFactorials.size() and (n - k) < 10 )
+    if ( n < LogFactorialTable().size() and (n - k) < 10 )
         return LogBinomFactorExact(n, k);
 
     // calculate final log(n over k) using approximations if necessary
@@ -130,9 +153,10 @@ double BCMath::ApproxLogFact(double x)
 {
     if (x < 0)
         return std::numeric_limits<double>::quiet_NaN();
+    const std::vector<double>& table = LogFactorialTable();
     unsigned n = static_cast<unsigned>(floor(x + 0.5));
-    if (n < CachedLogFactorials.size())
-        return CachedLogFactorials[n];
+    if (n < table.size())
+        return table[n];
     return x * log(x) - x + log(x * (1 + 4 * x * (1 + 2 * x))) / 6 + log(M_PI) / 2;
 }
 
@@ -140,36 +164,47 @@ double BCMath::ApproxLogFact(double x)
 double BCMath::LogFact(unsigned n)
 {
     // return cached value if available
-    if (n < CachedLogFactorials.size())
-        return CachedLogFactorials[n];
+    const std::vector<double>& table = LogFactorialTable();
+    if (n < table.size())
+        return table[n];
 
-    // calculate factorial starting from the highest cached value
-    double logfact = (CachedLogFactorials.empty()) ? 0 : CachedLogFactorials.back();
-    for (unsigned i = CachedLogFactorials.size(); i <= n; ++i)
-        logfact += log((double)i);
-
-    return logfact;
+    // log(n!) = log(Gamma(n+1)), thread safe unlike lgamma
+    return TMath::LnGamma(n + 1.);
 }
 
 // ---------------------------------------------------------
 unsigned BCMath::CacheFactorials(unsigned n)
 {
-    if (n < CachedLogFactorials.size())
-        // log factorials have already been cached up to n
-        return CachedLogFactorials.size();
-
-    // reserve memory
-    CachedLogFactorials.reserve(n);
-
-    // add log(0!) if not there
-    if (CachedLogFactorials.empty())
-        CachedLogFactorials.push_back(0);
-
-    // calculate new log factorials
-    for (unsigned i = CachedLogFactorials.size(); i <= n; ++i)
-        CachedLogFactorials.push_back(CachedLogFactorials.back() + log(static_cast<double>(i)));
+    unsigned size = 0;
+
+    #pragma omp critical(BCMath__CacheFactorials)
+    {
+        const std::vector<double>& old = LogFactorialTable();
+
+        if (n < old.size())
+            // log factorials have already been cached up to n
+            size = old.size();
+        else {
+            // extend a copy; readers may still use the old table,
+            // which is therefore never deleted
+            std::vector<double>* table = new std::vector<double>(old);
+            table->reserve(n + 1);
+
+            // add log(0!) if not there
+            if (table->empty())
+                table->push_back(0);
+
+            // calculate new log factorials
+            for (unsigned i = table->size(); i <= n; ++i)
+                table->push_back(table->back() + log(static_cast<double>(i)));
+
+            // make the table visible to other threads only when complete
+            __atomic_store_n(&CachedLogFactorials, table, __ATOMIC_RELEASE);
+            size = table->size();
+        }
+    }
 
-    return CachedLogFactorials.size();
+    return size;
 }
 
 namespace
@@ -180,6 +215,378 @@ namespace
 static unsigned cached_factorials = BCMath::CacheFactorials(899);
 }
 
+namespace
+{
+/** Number of points evaluated at once using temporary arrays on the stack. */
+const unsigned BatchSize = 256;
+
+/** @return The bits of a double */
+inline uint64_t AsBits(double x)
+{
+    uint64_t i;
+    std::memcpy(&i, &x, sizeof(i));
+    return i;
+}
+
+/** @return The double with the given bits */
+inline double AsDouble(uint64_t i)
+{
+    double x;
+    std::memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+/** @return Whether x is positive, normal and finite. */
+inline bool IsPositiveNormal(double x)
+{
+    // bits from those of the smallest normal number up to infinity
+    return AsBits(x) - 0x0010000000000000ULL < 0x7fe0000000000000ULL;
+}
+
+/**
+ * Natural logarithm of a positive normal number, following fdlibm:
+ * x = 2^k (1 + f) with 1 + f in [sqrt(1/2), sqrt(2)), and log(1 + f)
+ * from a minimax polynomial in s = f / (2 + f). Only integer and
+ * floating-point arithmetic without branches, so loops over it can be
+ * vectorized. */
+inline double LogKernel(double x)
+{
+    static const double ln2_hi = 6.93147180369123816490e-01;
+    static const double ln2_lo = 1.90821492927058770002e-10;
+    static const double Lg1 = 6.666666666666735130e-01;
+    static const double Lg2 = 3.999999999940941908e-01;
+    static const double Lg3 = 2.857142874366239149e-01;
+    static const double Lg4 = 2.222219843214978396e-01;
+    static const double Lg5 = 1.818357216161805012e-01;
+    static const double Lg6 = 1.531383769920937332e-01;
+    static const double Lg7 = 1.479819860511658591e-01;
+
+    // subtracting the bits of sqrt(1/2) makes the exponent field k
+    const uint64_t bits = AsBits(x);
+    const int64_t k = static_cast<int64_t>(bits - 0x3fe6a09e667f3bcdULL) >> 52;
+    const double z = AsDouble(bits - (static_cast<uint64_t>(k) << 52));
+
+    // k as double via the bits of 1.5 * 2^52 + k
+    const double dk = AsDouble(0x4338000000000000ULL + static_cast<uint64_t>(k)) - 6755399441055744.;
+
+    const double f = z - 1;
+    const double s = f / (2 + f);
+    const double s2 = s * s;
+    const double s4 = s2 * s2;
+    const double r = s4 * (Lg2 + s4 * (Lg4 + s4 * Lg6)) + s2 * (Lg1 + s4 * (Lg3 + s4 * (Lg5 + s4 * Lg7)));
+    const double hfsq = 0.5 * f * f;
+    return dk * ln2_hi - ((hfsq - (s * (hfsq + r) + dk * ln2_lo)) - f);
+}
+
+/** @return The sum of n values, in independent partial sums so the loop can be vectorized. */
+inline double Sum(const double* x, unsigned n)
+{
+    double sum[4] = { 0, 0, 0, 0 };
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (unsigned j = 0; j < 4; ++j)
+            sum[j] += x[i + j];
+    for (; i < n; ++i)
+        sum[0] += x[i];
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+/** @return Whether LogPoisson can take log(x!) from a table of size xmax + 0.5. */
+inline bool PoissonFromTable(double x, double lambda, double xmax)
+{
+    return x >= 0 and x < xmax and lambda > 0 and lambda <= 899;
+}
+}
+
+// ---------------------------------------------------------
+void BCMath::Log(unsigned n, const double* x, double* result)
+{
+    unsigned special = 0;
+    for (unsigned i = 0; i < n; ++i)
+        special += !IsPositiveNormal(x[i]);
+
+    if (special == 0)
+        for (unsigned i = 0; i < n; ++i)
+            result[i] = LogKernel(x[i]);
+    else
+        for (unsigned i = 0; i < n; ++i)
+            result[i] = IsPositiveNormal(x[i]) ? LogKernel(x[i]) : log(x[i]);
+}
+
+// ---------------------------------------------------------
+void BCMath::LogGaus(unsigned n, const double* x, const double* mean, const double* sigma, double* result, bool norm)
+{
+    const double c = 0.5 * log(2 * M_PI);
+    double logsigma[BatchSize];
+
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        const double* xx = x + b;
+        const double* mu = mean + b;
+        const double* s = sigma + b;
+        double* r = result + b;
+
+        unsigned special = 0;
+        for (unsigned i = 0; i < m; ++i) {
+            const double arg = (xx[i] - mu[i]) / s[i];
+            r[i] = -.5 * arg * arg;
+            special += s[i] == 0;
+        }
+
+        if (norm) {
+            for (unsigned i = 0; i < m; ++i)
+                logsigma[i] = fabs(s[i]);
+            Log(m, logsigma, logsigma);
+            for (unsigned i = 0; i < m; ++i)
+                r[i] = r[i] - c - logsigma[i];
+        }
+
+        // delta functions
+        if (special > 0)
+            for (unsigned i = 0; i < m; ++i)
+                if (s[i] == 0)
+                    r[i] = LogGaus(xx[i], mu[i], s[i], norm);
+    }
+}
+
+// ---------------------------------------------------------
+void BCMath::LogSplitGaus(unsigned n, const double* x, const double* mode, const double* sigma_below, const double* sigma_above, double* result, bool norm)
+{
+    const double c = 0.5 * log(2 / M_PI);
+    double normalization[BatchSize];
+
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        const double* xx = x + b;
+        const double* mu = mode + b;
+        const double* below = sigma_below + b;
+        const double* above = sigma_above + b;
+        double* r = result + b;
+
+        if (norm) {
+            for (unsigned i = 0; i < m; ++i)
+                normalization[i] = below[i] + above[i];
+            Log(m, normalization, normalization);
+            for (unsigned i = 0; i < m; ++i)
+                normalization[i] = c - normalization[i];
+        } else
+            std::fill(normalization, normalization + m, 0.);
+
+        unsigned special = 0;
+        for (unsigned i = 0; i < m; ++i) {
+            const double s = xx[i] > mu[i] ? above[i] : below[i];
+            const double arg = (xx[i] - mu[i]) / s;
+            r[i] = -.5 * arg * arg + normalization[i];
+            special += s == 0;
+        }
+
+        // delta functions
+        if (special > 0)
+            for (unsigned i = 0; i < m; ++i)
+                if ((xx[i] > mu[i] ? above[i] : below[i]) == 0)
+                    r[i] = LogSplitGaus(xx[i], mu[i], below[i], above[i], norm);
+    }
+}
+
+// ---------------------------------------------------------
+void BCMath::LogPoisson(unsigned n, const double* x, const double* lambda, double* result)
+{
+    const std::vector<double>& table = LogFactorialTable();
+    if (table.empty()) {
+        for (unsigned i = 0; i < n; ++i)
+            result[i] = LogPoisson(x[i], lambda[i]);
+        return;
+    }
+    const double* logfact = &table[0];
+    const double xmax = table.size() - 0.5;
+
+    Log(n, lambda, result);
+
+    unsigned special = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        const bool fast = PoissonFromTable(x[i], lambda[i], xmax);
+        const unsigned k = fast ? static_cast<unsigned>(x[i] + 0.5) : 0;
+        result[i] = x[i] * result[i] - lambda[i] - logfact[k];
+        special += !fast;
+    }
+
+    // invalid arguments, large counts, and Gaussian approximation
+    if (special > 0)
+        for (unsigned i = 0; i < n; ++i)
+            if (!PoissonFromTable(x[i], lambda[i], xmax))
+                result[i] = LogPoisson(x[i], lambda[i]);
+}
+
+// ---------------------------------------------------------
+void BCMath::LogApproxBinomial(unsigned n, const unsigned* trials, const unsigned* k, const double* p, double* result)
+{
+    double logp[BatchSize];
+    double logq[BatchSize];
+
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        const unsigned* nn = trials + b;
+        const unsigned* kk = k + b;
+        const double* pp = p + b;
+        double* r = result + b;
+
+        for (unsigned i = 0; i < m; ++i)
+            logq[i] = 1 - pp[i];
+        Log(m, pp, logp);
+        Log(m, logq, logq);
+
+        for (unsigned i = 0; i < m; ++i)
+            r[i] = (kk[i] <= nn[i] and pp[i] > 0 and pp[i] < 1) ?
+                   LogBinomFactor(nn[i], kk[i]) + kk[i] * logp[i] + (nn[i] - kk[i]) * logq[i] :
+                   LogApproxBinomial(nn[i], kk[i], pp[i]);
+    }
+}
+
+// ---------------------------------------------------------
+void BCMath::LogLogNormal(unsigned n, const double* x, const double* mean, const double* sigma, double* result)
+{
+    const double c = 0.5 * log(2 * M_PI);
+    double logx[BatchSize];
+    double logsigma[BatchSize];
+
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        const double* xx = x + b;
+        const double* mu = mean + b;
+        const double* s = sigma + b;
+        double* r = result + b;
+
+        for (unsigned i = 0; i < m; ++i)
+            logsigma[i] = fabs(s[i]);
+        Log(m, logsigma, logsigma);
+        Log(m, xx, logx);
+
+        unsigned special = 0;
+        for (unsigned i = 0; i < m; ++i) {
+            const double arg = (logx[i] - mu[i]) / s[i];
+            r[i] = -.5 * arg * arg - (logx[i] + c + logsigma[i]);
+            special += s[i] == 0;
+        }
+
+        // delta functions
+        if (special > 0)
+            for (unsigned i = 0; i < m; ++i)
+                if (s[i] == 0)
+                    r[i] = LogLogNormal(xx[i], mu[i], s[i]);
+    }
+}
+
+// ---------------------------------------------------------
+void BCMath::LogGammaPDF(unsigned n, const double* x, const double* alpha, const double* beta, double* result)
+{
+    double logx[BatchSize];
+    double logbeta[BatchSize];
+    double lngamma[BatchSize];
+
+    // alpha is often the same for all points
+    double lastalpha = std::numeric_limits<double>::quiet_NaN();
+    double lastlngamma = 0;
+
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        const double* xx = x + b;
+        const double* a = alpha + b;
+        const double* bb = beta + b;
+        double* r = result + b;
+
+        for (unsigned i = 0; i < m; ++i) {
+            if (a[i] != lastalpha) {
+                lastalpha = a[i];
+                lastlngamma = TMath::LnGamma(a[i]);
+            }
+            lngamma[i] = lastlngamma;
+        }
+        Log(m, xx, logx);
+        Log(m, bb, logbeta);
+
+        for (unsigned i = 0; i < m; ++i)
+            r[i] = a[i] * logbeta[i] - lngamma[i] + (a[i] - 1) * logx[i] - bb[i] * xx[i];
+    }
+}
+
+// ---------------------------------------------------------
+double BCMath::SumLogGaus(unsigned n, const double* x, const double* mean, const double* sigma, bool norm)
+{
+    double buffer[BatchSize];
+    double sum = 0;
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        LogGaus(m, x + b, mean + b, sigma + b, buffer, norm);
+        sum += Sum(buffer, m);
+    }
+    return sum;
+}
+
+// ---------------------------------------------------------
+double BCMath::SumLogSplitGaus(unsigned n, const double* x, const double* mode, const double* sigma_below, const double* sigma_above, bool norm)
+{
+    double buffer[BatchSize];
+    double sum = 0;
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        LogSplitGaus(m, x + b, mode + b, sigma_below + b, sigma_above + b, buffer, norm);
+        sum += Sum(buffer, m);
+    }
+    return sum;
+}
+
+// ---------------------------------------------------------
+double BCMath::SumLogPoisson(unsigned n, const double* x, const double* lambda)
+{
+    double buffer[BatchSize];
+    double sum = 0;
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        LogPoisson(m, x + b, lambda + b, buffer);
+        sum += Sum(buffer, m);
+    }
+    return sum;
+}
+
+// ---------------------------------------------------------
+double BCMath::SumLogApproxBinomial(unsigned n, const unsigned* trials, const unsigned* k, const double* p)
+{
+    double buffer[BatchSize];
+    double sum = 0;
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        LogApproxBinomial(m, trials + b, k + b, p + b, buffer);
+        sum += Sum(buffer, m);
+    }
+    return sum;
+}
+
+// ---------------------------------------------------------
+double BCMath::SumLogLogNormal(unsigned n, const double* x, const double* mean, const double* sigma)
+{
+    double buffer[BatchSize];
+    double sum = 0;
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        LogLogNormal(m, x + b, mean + b, sigma + b, buffer);
+        sum += Sum(buffer, m);
+    }
+    return sum;
+}
+
+// ---------------------------------------------------------
+double BCMath::SumLogGammaPDF(unsigned n, const double* x, const double* alpha, const double* beta)
+{
+    double buffer[BatchSize];
+    double sum = 0;
+    for (unsigned b = 0; b < n; b += BatchSize) {
+        const unsigned m = std::min(BatchSize, n - b);
+        LogGammaPDF(m, x + b, alpha + b, beta + b, buffer);
+        sum += Sum(buffer, m);
+    }
+    return sum;
+}
+
 // ---------------------------------------------------------
 int BCMath::Nint(double x)
 {
@@ -305,9 +712,74 @@ double BCMath::CorrectPValue(const double& pvalue, const unsigned& npar, const u
     return TMath::Prob(chi2, dof);
 }
 
+namespace
+{
+/**
+ * One Markov chain over toy histograms for BCMath::FastPValue.
+ * Hidden in anonymous namespace. */
+struct FastPValueWalker {
+    FastPValueWalker(const std::vector<unsigned>& start, double logp_start) :
+        histogram(start),
+        logp(logp_start),
+        counter(0)
+    {}
+
+    /**
+     * One Metropolis step in every bin. */
+    void Sweep(const std::vector<double>& expected)
+    {
+        // loop over bins
+        for (size_t ibin = 0; ibin < histogram.size(); ++ibin) {
+            // random step up or down in statistics for this bin
+            double ptest = rng.Rndm() - 0.5;
+
+            // increase statistics by 1
+            if (ptest > 0) {
+                // calculate factor of probability
+                double r = expected[ibin] / double(histogram[ibin] + 1);
+
+                // walk, or don't (this is the Metropolis part)
+                if (rng.Rndm() < r) {
+                    ++histogram[ibin];
+                    logp += log(r);
+                }
+            }
+
+            // decrease statistics by 1
+            else if (ptest <= 0 && histogram[ibin] > 0) {
+                // calculate factor of probability
+                double r = double(histogram[ibin]) / expected[ibin];
+
+                // walk, or don't (this is the Metropolis part)
+                if (rng.Rndm() < r) {
+                    --histogram[ibin];
+                    logp += log(r);
+                }
+            }
+        } // end of looping over bins
+    }
+
+    /**
+     * Count the current toy histogram if it is at most as likely as the observed one. */
+    void Count(double logp_observed)
+    {
+        if (logp <= logp_observed)
+            ++counter;
+        // handle the case where a -b +b > a because of precision loss
+        else if (logp_observed && logp != logp_observed && fabs((logp - logp_observed) / logp_observed) < 1e-15)
+            ++counter;
+    }
+
+    std::vector<unsigned> histogram;
+    double logp;
+    unsigned counter;
+    TRandom3 rng;
+};
+}
+
 // ---------------------------------------------------------
 double BCMath::FastPValue(const std::vector<unsigned>& observed, const std::vector<double>& expected,
-                          unsigned nIterations, unsigned seed) throw (std::invalid_argument)
+                          unsigned nIterations, unsigned seed, unsigned nWalkers, int nBurnIn, double precision) throw (std::invalid_argument)
 {
     size_t nbins = observed.size();
     if (nbins != expected.size()) {
@@ -315,18 +787,25 @@ double BCMath::FastPValue(const std::vector<unsigned>& observed, const std::vect
                                          "size of expected and observed do not match, %u vs %u", unsigned(expected.size()), unsigned(nbins)));
     }
 
-    // temporary histogram to be modified in each MCMC step
-    std::vector<unsigned> histogram(nbins, 0);
+    // one walker per thread on request
+    if (nWalkers == 0) {
+        nWalkers = 1;
+#if THREAD_PARALLELIZATION
+        nWalkers = omp_get_max_threads();
+#endif
+    }
+    nWalkers = std::max(1u, std::min(nWalkers, nIterations));
 
-    // fix seed to iterations for reproducible results
-    TRandom3 rng(seed);
+    // decorrelate several walkers started from the same histogram
+    if (nBurnIn < 0)
+        nBurnIn = nWalkers > 1 ? 100 : 0;
 
     // keep track of log of probability and count data sets with larger value
     double logp = 0;
     double logp_start = 0;
-    int counter_pvalue = 0;
 
     // define starting distribution as histogram with most likely entries
+    std::vector<unsigned> histogram(nbins, 0);
     for (size_t ibin = 0; ibin < nbins; ++ibin) {
 
         // get the number of expected events
@@ -342,51 +821,104 @@ double BCMath::FastPValue(const std::vector<unsigned>& observed, const std::vect
         logp_start += LogPoisson(observed[ibin], yexp);
     }
 
-    // loop over iterations
-    for (unsigned iiter = 0; iiter < nIterations; ++iiter) {
-        // loop over bins
-        for (size_t ibin = 0; ibin < nbins; ++ibin) {
-            // random step up or down in statistics for this bin
-            double ptest = rng.Rndm() - 0.5;
-
-            // increase statistics by 1
-            if (ptest > 0) {
-                // calculate factor of probability
-                double r = expected[ibin] / double(histogram[ibin] + 1);
-
-                // walk, or don't (this is the Metropolis part)
-                if (rng.Rndm() < r) {
-                    ++histogram[ibin];
-                    logp += log(r);
-                }
-            }
-
-            // decrease statistics by 1
-            else if (ptest <= 0 && histogram[ibin] > 0) {
-                // calculate factor of probability
-                double r = double(histogram[ibin]) / expected[ibin];
-
-                // walk, or don't (this is the Metropolis part)
-                if (rng.Rndm() < r) {
-                    --histogram[ibin];
-                    logp += log(r);
-                }
+    // all walkers start from the mode, each with its own random numbers.
+    // Fix seed for reproducible results, the first walker uses the seed as is
+    std::vector<FastPValueWalker> walkers(nWalkers, FastPValueWalker(histogram, logp));
+    for (unsigned w = 0; w < nWalkers; ++w)
+        walkers[w].rng.SetSeed(seed == 0 ? 0 : seed + w);
+
+    // distribute the iterations
+    std::vector<unsigned> todo(nWalkers, nIterations / nWalkers);
+    for (unsigned w = 0; w < nIterations % nWalkers; ++w)
+        ++todo[w];
+
+    // check the precision after every round, else do everything in one round
+    const unsigned nround = precision > 0 ? 1000 : nIterations;
+
+    unsigned w;
+    (void) w;
+
+    // burn in
+    #pragma omp parallel for private(w) schedule(static)
+    for (unsigned w = 0; w < nWalkers; ++w)
+        for (int iiter = 0; iiter < nBurnIn; ++iiter)
+            walkers[w].Sweep(expected);
+
+    double counter_pvalue = 0;
+    double nDone = 0;
+    while (true) {
+        // loop over iterations
+        #pragma omp parallel for private(w) schedule(static)
+        for (unsigned w = 0; w < nWalkers; ++w) {
+            const unsigned n = std::min(nround, todo[w]);
+            for (unsigned iiter = 0; iiter < n; ++iiter) {
+                walkers[w].Sweep(expected);
+                walkers[w].Count(logp_start);
             }
-        } // end of looping over bins
-
-        // increase counter
-        if (logp <= logp_start)
-            ++counter_pvalue;
-        // handle the case where a -b +b > a because of precision loss
-        else if (logp_start && logp != logp_start && fabs((logp - logp_start) / logp_start) < 1e-15)
-            ++counter_pvalue;
+            todo[w] -= n;
+        }
+
+        // combine counters in fixed order
+        counter_pvalue = 0;
+        unsigned nLeft = 0;
+        for (unsigned w = 0; w < nWalkers; ++w) {
+            counter_pvalue += walkers[w].counter;
+            nLeft += todo[w];
+        }
+        nDone = nIterations - nLeft;
+
+        if (nLeft == 0)
+            break;
 
-    } // end of looping over iterations
+        // binomial uncertainty with a uniform prior, so it doesn't vanish for p = 0 or 1
+        if (precision > 0) {
+            const double p = (counter_pvalue + 1) / (nDone + 2);
+            if (sqrt(p * (1 - p) / (nDone + 3)) < precision)
+                break;
+        }
+    }
 
     // calculate p-value
-    return double(counter_pvalue) / nIterations;
+    return nDone > 0 ? counter_pvalue / nDone : 0;
 }
 
+// ---------------------------------------------------------
+void BCMath::GaussLegendre(unsigned n, std::vector<double>& nodes, std::vector<double>& weights)
+{
+    nodes.assign(n, 0);
+    weights.assign(n, 0);
+
+    // roots are symmetric, so only find half of them by Newton's method
+    for (unsigned i = 0; i < (n + 1) / 2; ++i) {
+        // initial guess for the i-th root
+        double z = cos(M_PI * (i + 0.75) / (n + 0.5));
+        double dp = 0;
+
+        for (unsigned iter = 0; iter < 100; ++iter) {
+            // evaluate P_n(z) and its derivative by recurrence
+            double p0 = 1;
+            double p1 = 0;
+            for (unsigned j = 1; j <= n; ++j) {
+                const double p2 = p1;
+                p1 = p0;
+                p0 = ((2. * j - 1.) * z * p1 - (j - 1.) * p2) / j;
+            }
+            dp = n * (z * p0 - p1) / (z * z - 1.);
+
+            // stop once converged, keeping the derivative at the root
+            const double dz = p0 / dp;
+            if (fabs(dz) < 1e-14)
+                break;
+            z -= dz;
+        }
+
+        nodes[i] = -z;
+        nodes[n - 1 - i] = z;
+        weights[i] = weights[n - 1 - i] = 2. / ((1. - z * z) * dp * dp);
+    }
+}
+
+// ---------------------------------------------------------
 double BCMath::Random::Chi2(TRandom* rng, double dof)
 {
     return 2.0 * Gamma(rng, dof / 2.0, 1.0);
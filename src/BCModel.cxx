@@ -8,6 +8,8 @@
 
 // ---------------------------------------------------------
 
+#include <config.h>
+
 #include "BCModel.h"
 
 #include "BCDataSet.h"
@@ -25,6 +27,53 @@
 #include <TH2.h>
 #include <TTree.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
+
+namespace
+{
+/** Number of data points per block summed by one thread. */
+const unsigned SumBlockSize = 512;
+
+/**
+ * Neumaier's compensated summation, keeping the rounding error of
+ * the running sum in a separate correction term. */
+class CompensatedSum
+{
+public:
+    CompensatedSum()
+        : fSum(0),
+          fCorrection(0)
+    {}
+
+    void Add(double x)
+    {
+        const double t = fSum + x;
+        if (std::fabs(fSum) >= std::fabs(x))
+            fCorrection += (fSum - t) + x;
+        else
+            fCorrection += (x - t) + fSum;
+        fSum = t;
+    }
+
+    double Result() const
+    {
+        // the correction is meaningless for infinite or NaN sums
+        return std::isfinite(fSum) ? fSum + fCorrection : fSum;
+    }
+
+private:
+    double fSum;
+    double fCorrection;
+};
+}
+
 // ---------------------------------------------------------
 BCModel::BCModel(const std::string& name)
     : BCIntegrate(name)
@@ -82,6 +131,106 @@ void swap(BCModel& A, BCModel& B)
     std::swap(A.fFactorizedPrior, B.fFactorizedPrior);
 }
 
+// ---------------------------------------------------------
+namespace
+{
+/**
+ * Log densities of the points of a data set. */
+class DataSetBlockLogDensity : public BCModel::BlockLogDensity
+{
+public:
+    DataSetBlockLogDensity(const BCDataSet& data, const BCModel::PointLogDensity& f)
+        : fData(data),
+          fPointLogDensity(f)
+    {}
+
+    virtual void operator()(unsigned begin, unsigned end, unsigned, double* logdensity) const
+    {
+        for (unsigned i = begin; i < end; ++i)
+            logdensity[i - begin] = fPointLogDensity(fData[i]);
+    }
+
+private:
+    const BCDataSet& fData;
+    const BCModel::PointLogDensity& fPointLogDensity;
+};
+
+/**
+ * Evaluate one block and add it up. */
+double SumBlock(const BCModel::BlockLogDensity& f, unsigned b, unsigned n, unsigned slot, const double* weights)
+{
+    const unsigned begin = b * SumBlockSize;
+    const unsigned end = std::min(begin + SumBlockSize, n);
+
+    // per block on the stack, so nothing is allocated per call
+    double logdensity[SumBlockSize];
+    f(begin, end, slot, logdensity);
+
+    CompensatedSum sum;
+    for (unsigned i = begin; i < end; ++i)
+        sum.Add(weights ? weights[i] * logdensity[i - begin] : logdensity[i - begin]);
+    return sum.Result();
+}
+}
+
+// ---------------------------------------------------------
+unsigned BCModel::GetLogDensityBlockSize()
+{
+    return SumBlockSize;
+}
+
+// ---------------------------------------------------------
+double BCModel::SumLogDensities(const PointLogDensity& f) const
+{
+    if (!fDataSet)
+        return 0;
+
+    // f is stateless, so any number of threads can share it
+    return SumLogDensities(fDataSet->GetNDataPoints(), DataSetBlockLogDensity(*fDataSet, f),
+                           std::numeric_limits<unsigned>::max(), fDataSet->GetWeights());
+}
+
+// ---------------------------------------------------------
+double BCModel::SumLogDensities(unsigned n, const BlockLogDensity& f, unsigned nslots, const double* weights) const
+{
+    const unsigned nblocks = (n + SumBlockSize - 1) / SumBlockSize;
+
+    // parallelize over points only if the chains don't run in parallel already
+    bool parallel = false;
+    (void) nslots;
+#if THREAD_PARALLELIZATION
+    parallel = !omp_in_parallel() and nblocks > 1 and unsigned(omp_get_max_threads()) <= nslots;
+#endif
+
+    CompensatedSum total;
+
+    if (!parallel) {
+        const unsigned chain = GetCurrentChain();
+        for (unsigned b = 0; b < nblocks; ++b)
+            total.Add(SumBlock(f, b, n, chain, weights));
+        return total.Result();
+    }
+
+    std::vector<double> sums(nblocks);
+
+    #pragma omp parallel
+    {
+        unsigned thread = 0;
+#if THREAD_PARALLELIZATION
+        thread = omp_get_thread_num();
+#endif
+        #pragma omp for schedule(static)
+        for (int b = 0; b < int(nblocks); ++b)
+            sums[b] = SumBlock(f, b, n, thread, weights);
+    }
+
+    // add blocks in fixed order
+    for (unsigned b = 0; b < nblocks; ++b)
+        total.Add(sums[b]);
+
+    return total.Result();
+}
+
 // ---------------------------------------------------------
 double BCModel::LogProbabilityNN(const std::vector<double>& parameters)
 {
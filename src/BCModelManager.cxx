@@ -8,16 +8,58 @@
 
 // ---------------------------------------------------------
 
+#include <config.h>
+
 #include "BCModelManager.h"
 
 #include "BCDataPoint.h"
 #include "BCLog.h"
 
+#include <TH1.h>
+#include <TROOT.h>
 #include <TString.h>
 
+#if THREAD_PARALLELIZATION
+#include <omp.h>
+#endif
+
+namespace
+{
+/**
+ * Tasks run on all models.
+ * Hidden in anonymous namespace. */
+void IntegrateModel(BCModel& model)
+{
+    // Minuit keeps global state, so only one model at a time may use it
+    if (model.GetIntegrationMethod() == BCIntegrate::kIntLaplace) {
+        #pragma omp critical(BCModelManager_Minuit)
+        model.Integrate();
+    } else
+        model.Integrate();
+}
+
+void FindModeOfModel(BCModel& model)
+{
+    // the default optimization uses Minuit, and simulated annealing
+    // keeps its lookup table for the Cauchy schedule in static variables
+    if (model.GetOptimizationMethod() == BCIntegrate::kOptMinuit or model.GetOptimizationMethod() == BCIntegrate::kOptDefault) {
+        #pragma omp critical(BCModelManager_Minuit)
+        model.FindMode();
+    } else if (model.GetOptimizationMethod() == BCIntegrate::kOptSimAnn) {
+        #pragma omp critical(BCModelManager_SimAnn)
+        model.FindMode();
+    } else
+        model.FindMode();
+}
+
+void MarginalizeModel(BCModel& model)
+{ model.MarginalizeAll(); }
+}
+
 // ---------------------------------------------------------
 BCModelManager::BCModelManager()
-    : fDataSet(NULL)
+    : fDataSet(NULL),
+      fNConcurrentModels(1)
 {
 }
 
@@ -26,7 +68,8 @@ BCModelManager::BCModelManager(const BCModelManager& other)
     : fModels(other.fModels),
       fAPrioriProbability(other.fAPrioriProbability),
       fAPosterioriProbability(other.fAPosterioriProbability),
-      fDataSet(other.fDataSet)
+      fDataSet(other.fDataSet),
+      fNConcurrentModels(other.fNConcurrentModels)
 {
 }
 
@@ -49,6 +92,7 @@ void swap(BCModelManager& A, BCModelManager& B)
     std::swap(A.fAPrioriProbability,     B.fAPrioriProbability);
     std::swap(A.fAPosterioriProbability, B.fAPosterioriProbability);
     std::swap(A.fDataSet,                B.fDataSet);
+    std::swap(A.fNConcurrentModels,      B.fNConcurrentModels);
 }
 
 // ---------------------------------------------------------
@@ -161,12 +205,11 @@ void BCModelManager::Integrate()
 
     BCLog::OutSummary("Running normalization of all models.");
 
-    for (unsigned int i = 0; i < GetNModels(); ++i) {
-        fModels[i]->Integrate();
+    RunModels(IntegrateModel);
 
-        // add to total normalization
+    // add to total normalization once all models are integrated
+    for (unsigned int i = 0; i < GetNModels(); ++i)
         normalization += fModels[i]->GetIntegral() * fAPrioriProbability[i];
-    }
 
     // set model a posteriori probabilities
     for (unsigned int i = 0; i < GetNModels(); ++i)
@@ -217,16 +260,69 @@ double BCModelManager::BayesFactor(unsigned imodel1, unsigned imodel2) const
 // ---------------------------------------------------------
 void BCModelManager::FindMode()
 {
-    for (unsigned i = 0; i < GetNModels(); ++i)
-        GetModel(i)->FindMode();
+    RunModels(FindModeOfModel);
 }
 
 // ---------------------------------------------------------
 void BCModelManager::MarginalizeAll()
 {
     // marginalizes all models registered
-    for (unsigned i = 0; i < GetNModels(); ++i)
-        GetModel(i)->MarginalizeAll();
+    RunModels(MarginalizeModel);
+}
+
+// ---------------------------------------------------------
+void BCModelManager::RunModels(void (*task)(BCModel&))
+{
+    std::vector<BCModel*> concurrent;
+    std::vector<BCModel*> serial;
+
+#if THREAD_PARALLELIZATION
+    if (fNConcurrentModels > 1 and !omp_in_parallel()) {
+        for (unsigned i = 0; i < fModels.size(); ++i) {
+#if ROOTVERSION < 6000000
+            // ROOT 5 can't write files from several threads
+            if (fModels[i]->GetWriteMarkovChainRun() or fModels[i]->GetWriteMarkovChainPreRun()) {
+                serial.push_back(fModels[i]);
+                continue;
+            }
+#endif
+            concurrent.push_back(fModels[i]);
+        }
+    } else
+#endif
+        serial = fModels;
+
+    if (concurrent.size() > 1) {
+#if THREAD_PARALLELIZATION
+#if ROOTVERSION >= 6000000
+        ROOT::EnableThreadSafety();
+#endif
+        // keep histograms out of the current ROOT directory
+        const bool adddirectory = TH1::AddDirectoryStatus();
+        TH1::AddDirectory(false);
+
+        // share the threads: each model runs its chains with its part
+        const int nmodels = std::min<int>(fNConcurrentModels, concurrent.size());
+        const int nthreads = std::max(1, omp_get_max_threads() / nmodels);
+        const int levels = omp_get_max_active_levels();
+        omp_set_max_active_levels(std::max(levels, 2));
+
+        BCLog::OutSummary(Form("Running %d models at once with %d threads each.", nmodels, nthreads));
+
+        #pragma omp parallel for num_threads(nmodels) schedule(dynamic, 1)
+        for (int i = 0; i < int(concurrent.size()); ++i) {
+            omp_set_num_threads(nthreads);
+            task(*concurrent[i]);
+        }
+
+        omp_set_max_active_levels(levels);
+        TH1::AddDirectory(adddirectory);
+#endif
+    } else
+        serial.insert(serial.begin(), concurrent.begin(), concurrent.end());
+
+    for (unsigned i = 0; i < serial.size(); ++i)
+        task(*serial[i]);
 }
 
 // ---------------------------------------------------------
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+// ---------------------------------------------------------
+
+#include "BCQuantileSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+/**
+ * Scale function k1 of the t-digest, mapping the cumulative probability q onto the index space. */
+double ScaleK(double q, double compression)
+{
+    return compression / (2 * M_PI) * std::asin(2 * q - 1);
+}
+
+/**
+ * Inverse of ScaleK(). */
+double ScaleQ(double k, double compression)
+{
+    if (k >= compression / 4)
+        return 1;
+    return (std::sin(k * 2 * M_PI / compression) + 1) / 2;
+}
+}
+
+// ---------------------------------------------------------
+BCQuantileSketch::BCQuantileSketch(double compression)
+    : fCompression(std::max(compression, 10.)),
+      fTotalWeight(0),
+      fMinimum(std::numeric_limits<double>::infinity()),
+      fMaximum(-std::numeric_limits<double>::infinity())
+{
+}
+
+// ---------------------------------------------------------
+void BCQuantileSketch::Add(double x, double w)
+{
+    if (!(w > 0) or x != x)
+        return;
+
+    fBuffer.push_back(std::make_pair(x, w));
+    fTotalWeight += w;
+    fMinimum = std::min(fMinimum, x);
+    fMaximum = std::max(fMaximum, x);
+
+    // amortize the cost of sorting over many values
+    if (fBuffer.size() >= fCompression)
+        Compress();
+}
+
+// ---------------------------------------------------------
+void BCQuantileSketch::Merge(const BCQuantileSketch& other)
+{
+    other.Compress();
+    for (unsigned i = 0; i < other.fCentroids.size(); ++i)
+        fBuffer.push_back(other.fCentroids[i]);
+    fTotalWeight += other.fTotalWeight;
+    fMinimum = std::min(fMinimum, other.fMinimum);
+    fMaximum = std::max(fMaximum, other.fMaximum);
+    Compress();
+}
+
+// ---------------------------------------------------------
+void BCQuantileSketch::Reset()
+{
+    fCentroids.clear();
+    fBuffer.clear();
+    fTotalWeight = 0;
+    fMinimum = std::numeric_limits<double>::infinity();
+    fMaximum = -std::numeric_limits<double>::infinity();
+}
+
+// ---------------------------------------------------------
+void BCQuantileSketch::Compress() const
+{
+    if (fBuffer.empty())
+        return;
+
+    // merge old centroids and new values in one sorted sequence
+    fBuffer.insert(fBuffer.end(), fCentroids.begin(), fCentroids.end());
+    std::sort(fBuffer.begin(), fBuffer.end());
+    fCentroids.clear();
+
+    // combine neighbors as long as the centroid stays within one unit of the scale function
+    double wSoFar = 0;
+    double qLimit = ScaleQ(ScaleK(0, fCompression) + 1, fCompression);
+    std::pair<double, double> current = fBuffer.front();
+    for (unsigned i = 1; i < fBuffer.size(); ++i) {
+        const double proposed = current.second + fBuffer[i].second;
+        if ((wSoFar + proposed) / fTotalWeight <= qLimit) {
+            current.first += (fBuffer[i].first - current.first) * fBuffer[i].second / proposed;
+            current.second = proposed;
+        } else {
+            fCentroids.push_back(current);
+            wSoFar += current.second;
+            qLimit = ScaleQ(ScaleK(wSoFar / fTotalWeight, fCompression) + 1, fCompression);
+            current = fBuffer[i];
+        }
+    }
+    fCentroids.push_back(current);
+
+    fBuffer.clear();
+}
+
+// ---------------------------------------------------------
+unsigned BCQuantileSketch::GetNCentroids() const
+{
+    Compress();
+    return fCentroids.size();
+}
+
+// ---------------------------------------------------------
+double BCQuantileSketch::GetQuantile(double p) const
+{
+    Compress();
+
+    if (fCentroids.empty())
+        return std::numeric_limits<double>::quiet_NaN();
+    if (p <= 0)
+        return fMinimum;
+    if (p >= 1)
+        return fMaximum;
+
+    const unsigned n = fCentroids.size();
+    const double target = p * fTotalWeight;
+
+    // interpolate from the minimum to the center of the first centroid
+    double cumulative = fCentroids.front().second / 2;
+    if (target < cumulative)
+        return fMinimum + (fCentroids.front().first - fMinimum) * target / cumulative;
+
+    // interpolate linearly between the centers of neighboring centroids
+    for (unsigned i = 0; i + 1 < n; ++i) {
+        const double dw = (fCentroids[i].second + fCentroids[i + 1].second) / 2;
+        if (target < cumulative + dw)
+            return fCentroids[i].first + (fCentroids[i + 1].first - fCentroids[i].first) * (target - cumulative) / dw;
+        cumulative += dw;
+    }
+
+    // interpolate from the center of the last centroid to the maximum
+    const double rest = fCentroids.back().second / 2;
+    return fCentroids.back().first + (fMaximum - fCentroids.back().first) * std::min(1., (target - cumulative) / rest);
+}
+
+// ---------------------------------------------------------
+std::pair<double, double> BCQuantileSketch::GetSmallestInterval(double mass, unsigned nsteps) const
+{
+    mass = std::min(std::max(mass, 0.), 1.);
+    nsteps = std::max(nsteps, 1u);
+
+    std::pair<double, double> interval(GetQuantile(0), GetQuantile(mass));
+    for (unsigned i = 1; i <= nsteps; ++i) {
+        const double p = (1 - mass) * i / nsteps;
+        const double low = GetQuantile(p);
+        const double high = GetQuantile(p + mass);
+        if (high - low < interval.second - interval.first)
+            interval = std::make_pair(low, high);
+    }
+    return interval;
+}
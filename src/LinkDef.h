@@ -29,6 +29,7 @@
 #pragma link C++ class BCParameterSet-;
 #pragma link C++ class BCPrior-;
 #pragma link C++ class BCPriorModel-;
+#pragma link C++ class BCQuantileSketch-;
 #pragma link C++ class BCSplitGaussianPrior-;
 #pragma link C++ class BCTF1LogPrior-;
 #pragma link C++ class BCTF1Prior-;
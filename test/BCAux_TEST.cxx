@@ -9,7 +9,10 @@
 #include <test.h>
 #include <BAT/BCAux.h>
 
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <sstream>
 
 using namespace test;
 using namespace BCAux;
@@ -71,10 +74,75 @@ public:
         TEST_CHECK_EQUAL(RangeType(fin_val, -fin_val),  kReverseRange);
     }
 
+    static double parse(const std::string& s)
+    {
+        double value = -999;
+        TEST_CHECK(ParseNumber(s.data(), s.data() + s.size(), value));
+        return value;
+    }
+
+    void parseNumberTest() const
+    {
+        double value;
+        TEST_CHECK_EQUAL(parse("0"), 0);
+        TEST_CHECK_EQUAL(parse("-12"), -12);
+        TEST_CHECK_EQUAL(parse("+3.25"), 3.25);
+        TEST_CHECK_EQUAL(parse(".5"), 0.5);
+        TEST_CHECK_EQUAL(parse("5."), 5);
+        TEST_CHECK_EQUAL(parse("1e3"), 1000);
+        TEST_CHECK_EQUAL(parse("2.5E-2"), 0.025);
+        TEST_CHECK_EQUAL(parse("0.1"), 0.1);
+
+        // mantissas above 2^53 and large exponents agree with the compiler
+        TEST_CHECK_EQUAL(parse("9007199254740993"), 9007199254740993.);
+        TEST_CHECK_EQUAL(parse("-12345678901234567"), -12345678901234567.);
+        TEST_CHECK_EQUAL(parse("1234567890123456789"), 1234567890123456789.);
+        TEST_CHECK_EQUAL(parse("0.1234567890123456789"), 0.1234567890123456789);
+        TEST_CHECK_EQUAL(parse("3.14159265358979323e-200"), 3.14159265358979323e-200);
+        TEST_CHECK_EQUAL(parse("1e23"), 1e23);
+        TEST_CHECK_EQUAL(parse("0e500"), 0);
+        TEST_CHECK_EQUAL(parse("1e-400"), 0);
+        TEST_CHECK(!ParseNumber("1e400", std::strchr("1e400", 0), value));
+        TEST_CHECK(!ParseNumber("-2.5e308", std::strchr("-2.5e308", 0), value));
+
+        TEST_CHECK_EQUAL(parse("0.30000000000000004"), 0.30000000000000004);
+        TEST_CHECK_EQUAL(parse("1.7976931348623157e308"), 1.7976931348623157e308);
+        TEST_CHECK_EQUAL(parse("4.9406564584124654e-324"), 4.9406564584124654e-324);
+
+        // more than 19 significant digits: standard library
+        TEST_CHECK_EQUAL(parse("123456789012345678901234567890"), 123456789012345678901234567890.);
+        TEST_CHECK_EQUAL(parse("1.00000000000000000000000000001"), 1.);
+
+        // round trip of many values
+        for (unsigned i = 1; i < 10000; ++i) {
+            const double x = std::pow(-1., int(i)) * i * 1.2345678901234567e-7 * i * i;
+            std::ostringstream os;
+            os.precision(17);
+            os << x;
+            TEST_CHECK_EQUAL(parse(os.str()), x);
+        }
+
+        const std::string invalid[] = { "", "-", ".", "e5", "1e", "1.2.3", "0x10", "nan", "1,5", "abc" };
+        for (unsigned i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+            TEST_CHECK(!ParseNumber(invalid[i].data(), invalid[i].data() + invalid[i].size(), value));
+
+        // separated by any white space, stop at invalid token
+        const std::string text = " 1\t2\n\n 3e1\r\n4 x 5";
+        std::vector<double> values;
+        TEST_CHECK(!ParseNumbers(text.data(), text.data() + text.size(), values));
+        TEST_CHECK_EQUAL(values.size(), 4);
+        TEST_CHECK_EQUAL(values[2], 30);
+
+        values.clear();
+        TEST_CHECK(ParseNumbers(text.data(), text.data() + 12, values));
+        TEST_CHECK_EQUAL(values.size(), 3);
+    }
+
     virtual void run() const
     {
         defaultToPDFTest();
         rangeTypeTest();
+        parseNumberTest();
     }
 
 } bcaux_Test;
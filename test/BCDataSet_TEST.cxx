@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <test.h>
+#include <BAT/BCDataSet.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <stdint.h>
+
+using namespace test;
+
+class BCDataSetTest :
+    public TestCase
+{
+public:
+    BCDataSetTest() :
+        TestCase("BCDataSet test")
+    {
+    }
+
+    /**
+     * Overwrite a 64-bit word in the header of a binary file. */
+    static void PatchWord(const char* filename, long position, uint64_t value)
+    {
+        std::FILE* f = std::fopen(filename, "r+b");
+        std::fseek(f, position, SEEK_SET);
+        std::fwrite(&value, sizeof(value), 1, f);
+        std::fclose(f);
+    }
+
+    virtual void run() const
+    {
+        // dimension set by first data point
+        {
+            BCDataSet ds;
+            std::vector<double> x(3);
+            for (unsigned i = 0; i < 5; ++i) {
+                x[0] = i;
+                x[1] = 10 * i;
+                x[2] = -1. * i;
+                TEST_CHECK(ds.AddDataPoint(BCDataPoint(x)));
+            }
+            TEST_CHECK_EQUAL(ds.GetNDataPoints(), 5);
+            TEST_CHECK_EQUAL(ds.GetNValuesPerPoint(), 3);
+
+            // wrong dimension rejected
+            TEST_CHECK(!ds.AddDataPoint(BCDataPoint(2)));
+            TEST_CHECK_EQUAL(ds.GetNDataPoints(), 5);
+
+            // columns are contiguous and agree with the rows
+            const double* col = ds.GetColumn(1);
+            for (unsigned i = 0; i < 5; ++i) {
+                TEST_CHECK_EQUAL(col[i], 10. * i);
+                TEST_CHECK_EQUAL(ds[i][1], col[i]);
+                TEST_CHECK_EQUAL(ds.GetDataPoint(i).GetValue(2), -1. * i);
+            }
+            TEST_CHECK(ds.GetDataComponents(1) == std::vector<double>(col, col + 5));
+            TEST_CHECK(ds.GetDataComponents(3).empty());
+
+            // bounds
+            TEST_CHECK_EQUAL(ds.GetLowerBound(0), 0);
+            TEST_CHECK_EQUAL(ds.GetUpperBound(1), 40);
+            TEST_CHECK_EQUAL(ds.GetLowerBound(2), -4);
+
+            // rows are views, writing goes to the columns
+            ds.Back()[0] = 42;
+            TEST_CHECK_EQUAL(ds.GetColumn(0)[4], 42);
+            ds.GetDataPoint(0).SetValue(2, 7);
+            TEST_CHECK_EQUAL(ds.GetColumn(2)[0], 7);
+
+            std::vector<double> row = ds.GetDataPoint(2).GetValues();
+            TEST_CHECK_EQUAL(row.size(), 3);
+            TEST_CHECK_EQUAL(row[1], 20);
+
+            const BCDataSet& cds = ds;
+            BCDataSet::ConstRow r = cds[3];
+            TEST_CHECK_EQUAL(r.GetNValues(), 3);
+            TEST_CHECK_EQUAL(r[0], 3);
+
+            // checked access
+            TEST_CHECK_THROWS(std::out_of_range, ds.GetDataPoint(5));
+            TEST_CHECK_THROWS(std::out_of_range, ds.GetColumn(3));
+
+            // copies are independent
+            BCDataSet copy(ds);
+            copy[0][0] = -5;
+            TEST_CHECK_EQUAL(ds[0][0], 0);
+            TEST_CHECK_EQUAL(copy.GetColumn(0)[0], -5);
+
+            ds.Reset();
+            TEST_CHECK_EQUAL(ds.GetNDataPoints(), 0);
+            TEST_CHECK_EQUAL(ds.GetNValuesPerPoint(), 0);
+        }
+
+        // bounds with uncertainties
+        {
+            BCDataSet ds(2);
+            ds.Reserve(2);
+            ds.AddDataPoint(BCDataPoint(2));
+            ds.Back()[0] = 1;
+            ds.Back()[1] = 0.5;
+            ds.AddDataPoint(BCDataPoint(2));
+            ds.Back()[0] = 3;
+            ds.Back()[1] = 1;
+            ds.AdjustBoundForUncertainties(0, 2, 1);
+            TEST_CHECK_EQUAL(ds.GetLowerBound(0), 0);
+            TEST_CHECK_EQUAL(ds.GetUpperBound(0), 5);
+        }
+
+        // text file spanning several chunks, points spanning lines
+        {
+            static const char* filename = "BCDataSet_TEST.txt";
+            static const unsigned N = 100000;
+
+            std::FILE* f = std::fopen(filename, "w");
+            for (unsigned i = 0; i < N; ++i) {
+                std::fprintf(f, "%u %.17g\n", i, 1. / (i + 1));
+                std::fprintf(f, "%.17g\n", -1e-3 * i);
+            }
+            // incomplete point
+            std::fprintf(f, "1 2\n");
+            std::fclose(f);
+
+            BCDataSet ds;
+            TEST_CHECK(ds.ReadDataFromFileTxt(filename, 3));
+            TEST_CHECK_EQUAL(ds.GetNDataPoints(), N);
+            TEST_CHECK_EQUAL(ds.GetNValuesPerPoint(), 3);
+            bool equal = true;
+            for (unsigned i = 0; i < N; ++i)
+                equal &= ds[i][0] == i and ds[i][1] == 1. / (i + 1) and ds[i][2] == -1e-3 * i;
+            TEST_CHECK(equal);
+            TEST_CHECK_EQUAL(ds.GetLowerBound(0), 0);
+            TEST_CHECK_EQUAL(ds.GetUpperBound(0), N - 1);
+            TEST_CHECK_EQUAL(ds.GetUpperBound(1), 1);
+            TEST_CHECK_EQUAL(ds.GetLowerBound(2), -1e-3 * (N - 1));
+
+            // stop at first token that is not a number
+            f = std::fopen(filename, "w");
+            std::fprintf(f, "1 2\n3 4\n5 # 6\n7 8\n");
+            std::fclose(f);
+            TEST_CHECK(ds.ReadDataFromFileTxt(filename, 2));
+            TEST_CHECK_EQUAL(ds.GetNDataPoints(), 2);
+            TEST_CHECK_EQUAL(ds.GetUpperBound(1), 4);
+
+            // wrong dimension
+            TEST_CHECK(!ds.ReadDataFromFileTxt(filename, 0));
+
+            std::remove(filename);
+        }
+
+        // binary file round trip
+        {
+            static const char* filename = "BCDataSet_TEST.bin";
+            static const unsigned N = 1000;
+
+            BCDataSet ds(2);
+            ds.SetComponentName(0, "x");
+            ds.SetComponentName(1, "weight");
+            std::vector<double> x(2);
+            for (unsigned i = 0; i < N; ++i) {
+                x[0] = 0.5 * i;
+                x[1] = 1. / (i + 1);
+                ds.AddDataPoint(BCDataPoint(x));
+            }
+            ds.SetBounds(1, 0, 2, true);
+            TEST_CHECK(ds.WriteDataToFileBinary(filename));
+
+            BCDataSet in;
+            TEST_CHECK(in.ReadDataFromFileBinary(filename));
+            TEST_CHECK_EQUAL(in.GetNDataPoints(), N);
+            TEST_CHECK_EQUAL(in.GetNValuesPerPoint(), 2);
+            TEST_CHECK_EQUAL(in.GetComponentName(1), "weight");
+            TEST_CHECK_EQUAL(in.GetLowerBound(0), 0);
+            TEST_CHECK_EQUAL(in.GetUpperBound(0), 0.5 * (N - 1));
+            TEST_CHECK_EQUAL(in.GetUpperBound(1), 2);
+            TEST_CHECK(in.IsFixed(1));
+            for (unsigned i = 0; i < N; ++i) {
+                TEST_CHECK_EQUAL(in.GetColumn(0)[i], 0.5 * i);
+                TEST_CHECK_EQUAL(in[i][1], 1. / (i + 1));
+            }
+
+            // changes stay private to the data set
+            in[0][0] = -1;
+            BCDataSet again;
+            TEST_CHECK(again.ReadDataFromFileBinary(filename));
+            TEST_CHECK_EQUAL(again[0][0], 0);
+
+            // copies and added points live in memory
+            BCDataSet copy(in);
+            TEST_CHECK(!copy.IsMapped());
+            TEST_CHECK_EQUAL(copy[0][0], -1);
+            TEST_CHECK(again.AddDataPoint(BCDataPoint(2)));
+            TEST_CHECK(!again.IsMapped());
+            TEST_CHECK_EQUAL(again.GetNDataPoints(), N + 1);
+            TEST_CHECK_EQUAL(again[N - 1][0], 0.5 * (N - 1));
+
+            // header words after the 8-byte magic word: byte order,
+            // components, points, offset, weighted, first name length
+            static const uint64_t corrupt[][2] = {
+                { 8, 0x0807060504030201ULL },
+                { 16, uint64_t(1) << 40 },
+                { 24, ~uint64_t(0) / 8 },
+                { 24, N + 1 },
+                { 32, 4 },
+                { 32, ~uint64_t(0) - 7 },
+                { 48, ~uint64_t(0) - 4 }
+            };
+            for (unsigned i = 0; i < sizeof(corrupt) / sizeof(corrupt[0]); ++i) {
+                TEST_CHECK(ds.WriteDataToFileBinary(filename));
+                PatchWord(filename, corrupt[i][0], corrupt[i][1]);
+                TEST_CHECK(!again.ReadDataFromFileBinary(filename));
+                TEST_CHECK_EQUAL(again.GetNDataPoints(), N + 1);
+            }
+
+            // not a data set file
+            std::FILE* f = std::fopen(filename, "w");
+            std::fputs("1 2 3\n", f);
+            std::fclose(f);
+            TEST_CHECK(!again.ReadDataFromFileBinary(filename));
+            TEST_CHECK_EQUAL(again.GetNDataPoints(), N + 1);
+
+            std::remove(filename);
+        }
+
+        // compaction of identical points
+        {
+            BCDataSet ds;
+            BCDataPoint p(2);
+            const double values[6][2] = { {1, 2}, {3, 4}, {1, 2}, {1, -2}, {3, 4}, {1, 2} };
+            for (unsigned i = 0; i < 6; ++i) {
+                p[0] = values[i][0];
+                p[1] = values[i][1];
+                TEST_CHECK(ds.AddDataPoint(p, i == 5 ? 0.5 : 1));
+            }
+            TEST_CHECK(ds.HasWeights());
+            TEST_CHECK_NEARLY_EQUAL(ds.GetTotalWeight(), 5.5, 1e-15);
+
+            TEST_CHECK_EQUAL(ds.Compact(), 3);
+            TEST_CHECK_EQUAL(ds.GetNDataPoints(), 3);
+            TEST_CHECK_NEARLY_EQUAL(ds.GetTotalWeight(), 5.5, 1e-15);
+
+            // first occurrences in original order
+            TEST_CHECK_EQUAL(ds[0][0], 1);
+            TEST_CHECK_EQUAL(ds[0][1], 2);
+            TEST_CHECK_EQUAL(ds[1][0], 3);
+            TEST_CHECK_EQUAL(ds[2][1], -2);
+            TEST_CHECK_NEARLY_EQUAL(ds.GetWeight(0), 2.5, 1e-15);
+            TEST_CHECK_EQUAL(ds.GetWeight(1), 2);
+            TEST_CHECK_EQUAL(ds.GetWeight(2), 1);
+
+            // weights survive copies and binary files
+            BCDataSet copy(ds);
+            TEST_CHECK_EQUAL(copy.GetWeights()[1], 2);
+
+            const char* filename = "BCDataSet_TEST_weights.bin";
+            TEST_CHECK(ds.WriteDataToFileBinary(filename));
+            BCDataSet in;
+            TEST_CHECK(in.ReadDataFromFileBinary(filename));
+            TEST_CHECK_EQUAL(in.GetNDataPoints(), 3);
+            TEST_CHECK_EQUAL(in[1][1], 4);
+            TEST_CHECK_NEARLY_EQUAL(in.GetWeight(0), 2.5, 1e-15);
+            std::remove(filename);
+
+            // unweighted data set
+            BCDataSet unique;
+            TEST_CHECK(unique.AddDataPoint(p));
+            TEST_CHECK(!unique.HasWeights());
+            TEST_CHECK(unique.GetWeights() == 0);
+            TEST_CHECK_EQUAL(unique.GetWeight(0), 1);
+            TEST_CHECK_EQUAL(unique.Compact(), 1);
+            TEST_CHECK_EQUAL(unique.GetTotalWeight(), 1);
+        }
+    }
+};
+
+BCDataSetTest bcDataSetTest;
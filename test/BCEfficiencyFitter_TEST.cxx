@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCEfficiencyFitter.h>
+
+#include <BAT/BCMath.h>
+
+#include <TF1.h>
+#include <TH1D.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace test;
+
+class BCEfficiencyFitterTest :
+    public TestCase
+{
+public:
+    BCEfficiencyFitterTest():
+        TestCase("BCEfficiencyFitter")
+    {
+    }
+
+    /**
+     * Sum of the binomial probabilities of all bins, as computed bin by bin
+     * before the constant factors were cached.
+     * @param trials Numbers of trials
+     * @param successes Numbers of successes
+     * @param p Parameters of the line a + b x
+     * @return The log likelihood */
+    static double Reference(const std::vector<unsigned>& trials, const std::vector<unsigned>& successes, const std::vector<double>& p)
+    {
+        double logl = 0;
+        for (unsigned i = 0; i < trials.size(); ++i) {
+            // linear interpolation over bins of unit width
+            const double eff = p[0] + p[1] * (i + 0.5);
+            logl += BCMath::LogApproxBinomial(trials[i], successes[i], eff);
+        }
+        return logl;
+    }
+
+    virtual void run() const
+    {
+        // no successes, no failures, no trials, and many trials
+        const unsigned n[] = {10, 20, 0, 30, 40, 500};
+        const unsigned k[] = { 0,  5, 0, 30, 20, 320};
+        std::vector<unsigned> trials(n, n + 6);
+        std::vector<unsigned> successes(k, k + 6);
+
+        TH1D htrials("h_efficiency_trials", "", 6, 0, 6);
+        TH1D hsuccesses("h_efficiency_successes", "", 6, 0, 6);
+        for (unsigned i = 0; i < trials.size(); ++i) {
+            htrials.SetBinContent(i + 1, trials[i]);
+            hsuccesses.SetBinContent(i + 1, successes[i]);
+        }
+
+        TF1 f("f_efficiency", "[0]+[1]*x", 0, 6);
+        f.SetParLimits(0, -1, 1);
+        f.SetParLimits(1, -1, 1);
+
+        BCEfficiencyFitter fitter(htrials, hsuccesses, f, "efficiency_test");
+
+        std::vector<double> p(2);
+        p[0] = 0.1;
+        p[1] = 0.15;
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), Reference(trials, successes, p), 1e-12);
+
+        p[0] = 0.4;
+        p[1] = 0.05;
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), Reference(trials, successes, p), 1e-12);
+
+        // efficiency zero in the first bin without successes
+        p[0] = -0.0625;
+        p[1] = 0.125;
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), Reference(trials, successes, p), 1e-12);
+
+        // efficiency zero in the last bin with successes
+        p[0] = 0.6875;
+        p[1] = -0.125;
+        TEST_CHECK(std::isinf(fitter.LogLikelihood(p)));
+        TEST_CHECK(std::isinf(Reference(trials, successes, p)));
+
+        // efficiency out of range
+        p[0] = 0.5;
+        p[1] = 0.2;
+        TEST_CHECK(std::isnan(fitter.LogLikelihood(p)));
+        p[0] = -0.5;
+        p[1] = 0.1;
+        TEST_CHECK(std::isnan(fitter.LogLikelihood(p)));
+    }
+} bcEfficiencyFitterTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCEfficiencyFitter.TEST || cat test-suite.log)"
+// End:
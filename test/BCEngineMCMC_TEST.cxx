@@ -6,9 +6,13 @@
  * For documentation see http://mpp.mpg.de/bat
  */
 
+#include <config.h>
+
 #include "test.h"
 #include "GaussModel.h"
 
+#include <TH2.h>
+
 #include <limits>
 
 using namespace test;
@@ -230,6 +234,102 @@ public:
     }
 } convergenceTest;
 
+class H2OnDemandTest :
+    public TestCase
+{
+public:
+    H2OnDemandTest() :
+        TestCase("2D marginals on demand")
+    {
+    }
+
+    static GaussModel* run_model(bool on_demand)
+    {
+        GaussModel* m = new GaussModel(on_demand ? "on demand" : "dense", 3);
+        m->SetRandomSeed(613);
+        m->SetNChains(2);
+        m->SetNIterationsRun(2000);
+        m->SetH2OnDemand(on_demand);
+        m->MarginalizeAll(BCIntegrate::kMargMetropolis);
+        return m;
+    }
+
+    virtual void run() const
+    {
+        GaussModel* dense = run_model(false);
+        GaussModel* on_demand = run_model(true);
+
+        TEST_CHECK(on_demand->GetH2OnDemand());
+        for (unsigned i = 0; i < 3; ++i)
+            for (unsigned j = i + 1; j < 3; ++j) {
+                TEST_CHECK(dense->MarginalizedHistogramExists(i, j));
+                TEST_CHECK(on_demand->MarginalizedHistogramExists(i, j));
+                TEST_CHECK(!on_demand->MarginalizedHistogramExists(j, i));
+
+                TH2* h_dense = dense->GetMarginalizedHistogram(i, j);
+                TH2* h_on_demand = on_demand->GetMarginalizedHistogram(i, j);
+                TEST_CHECK(h_dense);
+                TEST_CHECK(h_on_demand);
+                TEST_CHECK_EQUAL(h_on_demand->GetEntries(), h_dense->GetEntries());
+                TEST_CHECK_EQUAL(h_on_demand->GetNbinsX(), h_dense->GetNbinsX());
+                TEST_CHECK_EQUAL(h_on_demand->GetNbinsY(), h_dense->GetNbinsY());
+                for (int bx = 0; bx <= h_dense->GetNbinsX() + 1; ++bx)
+                    for (int by = 0; by <= h_dense->GetNbinsY() + 1; ++by)
+                        TEST_CHECK_EQUAL(h_on_demand->GetBinContent(bx, by), h_dense->GetBinContent(bx, by));
+
+                // built only once
+                TEST_CHECK(on_demand->GetMarginalizedHistogram(i, j) == h_on_demand);
+            }
+
+        // a copy builds its own histograms
+        GaussModel copy(*on_demand);
+        TEST_CHECK_EQUAL(copy.GetMarginalizedHistogram(0u, 1u)->GetEntries(), dense->GetMarginalizedHistogram(0u, 1u)->GetEntries());
+
+        delete on_demand;
+        delete dense;
+    }
+} h2OnDemandTest;
+
+class ProfileTest :
+    public TestCase
+{
+public:
+    ProfileTest() :
+        TestCase("counters and timers of the chains")
+    {
+    }
+
+    virtual void run() const
+    {
+        GaussModel m("profile", 2);
+        m.SetRandomSeed(613);
+        m.SetNChains(2);
+        m.SetNIterationsRun(1000);
+        m.SetProfiling();
+        m.SetProposeMultivariate(false);
+        m.MarginalizeAll(BCIntegrate::kMargMetropolis);
+
+        // one entry per chain plus one for all chains
+        TEST_CHECK_EQUAL(m.GetProfileVector(BCEngineMCMC::kPreRun).size(), m.GetNChains() + 1);
+        TEST_CHECK_EQUAL(m.GetProfileVector(BCEngineMCMC::kMainRun).size(), m.GetNChains() + 1);
+
+        const BCEngineMCMC::Profile run = m.GetProfile(BCEngineMCMC::kMainRun);
+
+        // factorized proposal: one proposal per parameter and iteration
+        TEST_CHECK_EQUAL(run.n_evaluations + run.n_out_of_bounds, (unsigned long)(m.GetNChains() * m.GetNIterationsRun() * m.GetNParameters()));
+        TEST_CHECK_EQUAL(run.n_accepted + run.n_rejected + run.n_nonfinite, run.n_evaluations);
+        TEST_CHECK(run.n_accepted > 0);
+
+        // nothing is evaluated for all chains at once
+        TEST_CHECK_EQUAL(m.GetProfileVector(BCEngineMCMC::kMainRun).back().n_evaluations, 0ul);
+
+#if PROFILING
+        TEST_CHECK(run.time[BCEngineMCMC::kProfileLogEval] > 0);
+        TEST_CHECK(run.GetTotalTime() >= run.time[BCEngineMCMC::kProfileLogEval]);
+#endif
+    }
+} profileTest;
+
 #if 0
 class RValueTest :
     public TestCase
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCFunctorFitter.h>
+#include <models/base/BCGraphFitter.h>
+
+#include <TF1.h>
+#include <TGraphErrors.h>
+
+#include <vector>
+
+using namespace test;
+
+namespace
+{
+/**
+ * A straight line as a plain function. */
+double Line(double x, const double* p)
+{
+    return p[0] + p[1] * x;
+}
+
+/**
+ * A straight line as a function object. */
+class LineFunctor
+{
+public:
+    double operator()(double x, const double* p) const
+    { return p[0] + p[1] * x; }
+};
+}
+
+class BCFunctorFitterTest :
+    public TestCase
+{
+public:
+    BCFunctorFitterTest():
+        TestCase("BCFunctorFitter")
+    {
+    }
+
+    /**
+     * Points on y = 1 + 2 x with equal uncertainties. */
+    static TGraphErrors Graph()
+    {
+        TGraphErrors graph(10);
+        for (int i = 0; i < graph.GetN(); ++i) {
+            graph.SetPoint(i, i, 1 + 2 * i);
+            graph.SetPointError(i, 0, 0.1);
+        }
+        return graph;
+    }
+
+    static void SetLimits(TF1& f)
+    {
+        f.SetParLimits(0, -5, 5);
+        f.SetParLimits(1, -5, 5);
+    }
+
+    /**
+     * Fit the line and compare the likelihood to the fitter with the TF1.
+     * @param fitter The fitter with a function object
+     * @param f The TF1 of the same function */
+    template <class Fitter>
+    void Check(Fitter& fitter, const TF1& f) const
+    {
+        BCGraphFitter reference(Graph(), f, "functor_reference");
+
+        std::vector<double> p(2);
+        p[0] = 0.5;
+        p[1] = 2.3;
+
+        // same function values as the TF1
+        std::vector<double> x(3);
+        x[0] = -1;
+        x[1] = 0;
+        x[2] = 4.5;
+        std::vector<double> y;
+        fitter.EvaluateFitFunction(p, x, y);
+        TEST_CHECK_EQUAL(y.size(), x.size());
+        for (unsigned i = 0; i < x.size(); ++i) {
+            TEST_CHECK_NEARLY_EQUAL(y[i], p[0] + p[1] * x[i], 1e-14);
+            TEST_CHECK_NEARLY_EQUAL(fitter.FitFunction(std::vector<double>(1, x[i]), p), y[i], 1e-14);
+        }
+
+        // same likelihood as the TF1
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), reference.LogLikelihood(p), 1e-12);
+
+        // least squares: the points lie on the line
+        const std::vector<double> mode = fitter.FindMode(BCIntegrate::kOptMinuit, p);
+        TEST_CHECK_NEARLY_EQUAL(mode[0], 1, 1e-4);
+        TEST_CHECK_NEARLY_EQUAL(mode[1], 2, 1e-4);
+    }
+
+    virtual void run() const
+    {
+        // plain function
+        {
+            typedef double (*Function)(double, const double*);
+            TF1 f("functor_line_function", BCFunctorTF1Adapter<Function>(&Line), 0, 10, 2);
+            SetLimits(f);
+
+            BCFunctorFitter<BCGraphFitter, Function> fitter(Graph(), f, &Line, "functor_function");
+            TEST_CHECK_EQUAL(fitter.GetNParameters(), 2);
+            TEST_CHECK(fitter.GetFunction() == &Line);
+            Check(fitter, f);
+        }
+
+        // function object
+        {
+            TF1 f("functor_line_object", BCFunctorTF1Adapter<LineFunctor>(LineFunctor()), 0, 10, 2);
+            SetLimits(f);
+
+            BCFunctorFitter<BCGraphFitter, LineFunctor> fitter(Graph(), f, LineFunctor(), "functor_object");
+            TEST_CHECK_EQUAL(fitter.GetNParameters(), 2);
+            Check(fitter, f);
+        }
+    }
+} bcFunctorFitterTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCFunctorFitter.TEST || cat test-suite.log)"
+// End:
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCGraphFitter.h>
+
+#include <BAT/BCMath.h>
+
+#include <TF1.h>
+#include <TGraphErrors.h>
+
+#include <vector>
+
+using namespace test;
+
+class BCGraphFitterTest :
+    public TestCase
+{
+public:
+    BCGraphFitterTest():
+        TestCase("BCGraphFitter")
+    {
+    }
+
+    /**
+     * Ten distinct points followed by three repeated ones. */
+    static TGraphErrors Graph()
+    {
+        TGraphErrors graph(13);
+        for (int i = 0; i < 10; ++i) {
+            graph.SetPoint(i, 0.5 * i, 1 + 0.3 * i * i - 0.1 * (i % 3));
+            graph.SetPointError(i, 0, 0.1 + 0.02 * i);
+        }
+        const int repeated[] = {0, 4, 4};
+        for (int i = 10; i < 13; ++i) {
+            const int j = repeated[i - 10];
+            graph.SetPoint(i, graph.GetX()[j], graph.GetY()[j]);
+            graph.SetPointError(i, 0, graph.GetEY()[j]);
+        }
+        return graph;
+    }
+
+    /**
+     * The log likelihood and chi^2 point by point, as before caching.
+     * @param graph The data points
+     * @param p Parameters of the parabola a + b x + c x^2 */
+    static void Reference(const TGraphErrors& graph, const std::vector<double>& p, double& logl, double& chi2)
+    {
+        logl = 0;
+        chi2 = 0;
+        for (int i = 0; i < graph.GetN(); ++i) {
+            const double x = graph.GetX()[i];
+            const double f = p[0] + p[1] * x + p[2] * x * x;
+            const double chi = (graph.GetY()[i] - f) / graph.GetEY()[i];
+            logl += BCMath::LogGaus(graph.GetY()[i], f, graph.GetEY()[i], true);
+            chi2 += chi * chi;
+        }
+    }
+
+    static void Compare(BCGraphFitter& fitter, const TGraphErrors& graph, const std::vector<double>& p)
+    {
+        double logl, chi2;
+        Reference(graph, p, logl, chi2);
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), logl, 1e-12);
+        TEST_CHECK_RELATIVE_ERROR(fitter.CalculateChi2(p), chi2, 1e-12);
+    }
+
+    virtual void run() const
+    {
+        const TGraphErrors graph = Graph();
+
+        TF1 f("f_graph", "[0]+[1]*x+[2]*x*x", 0, 5);
+        f.SetParLimits(0, -5, 5);
+        f.SetParLimits(1, -5, 5);
+        f.SetParLimits(2, -5, 5);
+
+        BCGraphFitter fitter(graph, f, "graph_test");
+
+        std::vector<std::vector<double> > points;
+        std::vector<double> p(3);
+        p[0] = 1;
+        p[1] = 0;
+        p[2] = 1.2;
+        points.push_back(p);
+        p[0] = 0.7;
+        p[1] = -0.4;
+        p[2] = 0.9;
+        points.push_back(p);
+
+        // every point on its own
+        for (unsigned i = 0; i < points.size(); ++i)
+            Compare(fitter, graph, points[i]);
+
+        // repeated points evaluated once with their weights
+        TEST_CHECK_EQUAL(fitter.CompactData(), 10);
+        for (unsigned i = 0; i < points.size(); ++i)
+            Compare(fitter, graph, points[i]);
+
+        // the data set and the degrees of freedom still count all points
+        TEST_CHECK_EQUAL(fitter.GetNDataPoints(), 13);
+    }
+} bcGraphFitterTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCGraphFitter.TEST || cat test-suite.log)"
+// End:
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <BAT/BCH1D.h>
+
+#include <TH1D.h>
+
+using namespace test;
+
+class BCH1DTest :
+    public TestCase
+{
+public:
+    BCH1DTest():
+        TestCase("BCH1D")
+    {
+    }
+
+    virtual void run() const
+    {
+        // densities 1/4 and 3/4 after normalization
+        TH1D hist("bch1d_test", "", 4, 0, 4);
+        hist.SetDirectory(0);
+        hist.SetBinContent(1, 1);
+        hist.SetBinContent(2, 3);
+
+        BCH1D b(&hist);
+        TEST_CHECK_NEARLY_EQUAL(b.GetSmallestIntervalSize(0.5), 2. / 3, 1e-12);
+        BCH1D::BCH1DSmallestInterval s = b.GetSmallestIntervals(0.5);
+        TEST_CHECK_EQUAL(s.intervals.size(), 1);
+        TEST_CHECK_EQUAL(s.intervals[0].xmin, 1);
+        TEST_CHECK_EQUAL(s.intervals[0].xmax, 2);
+
+        // cached table gives the same result
+        TEST_CHECK_NEARLY_EQUAL(b.GetSmallestIntervalSize(0.5), 2. / 3, 1e-12);
+
+        // modifying the histogram gives new intervals
+        b.GetHistogram()->SetBinContent(3, 1.5);
+        TEST_CHECK_NEARLY_EQUAL(b.GetSmallestIntervalSize(0.5), 1. / 3, 1e-12);
+        s = b.GetSmallestIntervals(0.5);
+        TEST_CHECK_EQUAL(s.intervals.size(), 1);
+        TEST_CHECK_EQUAL(s.intervals[0].xmin, 2);
+        TEST_CHECK_EQUAL(s.intervals[0].xmax, 3);
+
+        // a kept pointer needs the cache cleared explicitly
+        TH1* h = b.GetHistogram();
+        TEST_CHECK_NEARLY_EQUAL(b.GetSmallestIntervalSize(0.5), 1. / 3, 1e-12);
+        h->SetBinContent(4, 5);
+        b.ClearSmallestIntervalCache();
+        TEST_CHECK_NEARLY_EQUAL(b.GetSmallestIntervalSize(0.5), 0.1, 1e-12);
+
+        // a new histogram replaces the table
+        b.SetHistogram(&hist);
+        TEST_CHECK_NEARLY_EQUAL(b.GetSmallestIntervalSize(0.5), 2. / 3, 1e-12);
+    }
+} bcH1DTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCH1D.TEST || cat test-suite.log)"
+// End:
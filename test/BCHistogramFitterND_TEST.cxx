@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCHistogramFitterND.h>
+
+#include <BAT/BCMath.h>
+
+#include <TF2.h>
+#include <TH2D.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace test;
+
+class BCHistogramFitterNDTest :
+    public TestCase
+{
+public:
+    BCHistogramFitterNDTest():
+        TestCase("BCHistogramFitterND")
+    {
+    }
+
+    void Bins() const
+    {
+        // 2 x 2 bins of width 1 on [0, 2] x [0, 2]
+        TH2D hist("hist_nd_test", "", 2, 0, 2, 2, 0, 2);
+        hist.SetDirectory(0);
+        hist.SetBinContent(1, 1, 1);
+        hist.SetBinContent(2, 1, 0);
+        hist.SetBinContent(1, 2, 2);
+        hist.SetBinContent(2, 2, 3);
+
+        // the integral of p x y over bin [a, a+1] x [b, b+1] is p (a + 1/2) (b + 1/2)
+        TF2 f("f_nd_test", "[0]*x*y", 0, 2, 0, 2);
+        f.SetParLimits(0, 0, 10);
+
+        BCHistogramFitterND fitter(hist, f, "nd_test");
+        TEST_CHECK_EQUAL(fitter.GetDimension(), 2);
+        TEST_CHECK_EQUAL(fitter.GetNParameters(), 1);
+        TEST_CHECK_EQUAL(fitter.GetNDataPoints(), 4);
+
+        const std::vector<double> p(1, 2.);
+
+        // bins in the order x first, then y
+        static const double expected[4] = { 0.5, 1.5, 1.5, 4.5 };
+        static const double counts[4] = { 1, 0, 2, 3 };
+        static const double logfact[4] = { 0, 0, std::log(2.), std::log(6.) };
+
+        double logl = 0;
+        for (unsigned i = 0; i < 4; ++i)
+            logl += counts[i] * std::log(expected[i]) - expected[i] - logfact[i];
+
+        // the midpoint rule is exact for x y as well
+        for (unsigned order = 1; order <= 3; ++order) {
+            fitter.SetIntegrationOrder(order);
+
+            const std::vector<double>& e = fitter.GetExpectations(p);
+            TEST_CHECK_EQUAL(e.size(), 4);
+            for (unsigned i = 0; i < e.size(); ++i)
+                TEST_CHECK_NEARLY_EQUAL(e[i], expected[i], 1e-12);
+
+            TEST_CHECK_NEARLY_EQUAL(fitter.LogLikelihood(p), logl, 1e-12);
+        }
+
+        // the expectation histogram has the binning of the data
+        TH1* h = fitter.GetExpectationHistogram(p);
+        TEST_CHECK_NEARLY_EQUAL(h->GetBinContent(2, 2), 4.5, 1e-12);
+        TEST_CHECK_NEARLY_EQUAL(h->Integral(), 8, 1e-12);
+        delete h;
+    }
+
+    /**
+     * Enough bins for several blocks, which are evaluated in parallel
+     * if thread parallelization is enabled. */
+    void Blocks() const
+    {
+        const int n = int(std::sqrt(3. * BCModel::GetLogDensityBlockSize())) + 2;
+        TEST_CHECK(unsigned(n * n) > 2 * BCModel::GetLogDensityBlockSize());
+
+        TH2D hist("hist_nd_blocks", "", n, 0, n, n, 0, n);
+        hist.SetDirectory(0);
+        for (int i = 1; i <= n; ++i)
+            for (int j = 1; j <= n; ++j)
+                hist.SetBinContent(i, j, (i * j) % 7);
+
+        TF2 f("f_nd_blocks", "[0]*x*y", 0, n, 0, n);
+        f.SetParLimits(0, 0, 10);
+
+        BCHistogramFitterND fitter(hist, f, "nd_blocks");
+        fitter.SetIntegrationOrder(1);
+
+        const std::vector<double> p(1, 0.01);
+
+        // the serial sum over the bins, x first
+        double logl = 0;
+        for (int j = 1; j <= n; ++j)
+            for (int i = 1; i <= n; ++i)
+                logl += BCMath::LogPoisson(hist.GetBinContent(i, j), p[0] * (i - 0.5) * (j - 0.5));
+
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), logl, 1e-12);
+
+        // every bin is evaluated once
+        const std::vector<double>& e = fitter.GetExpectations(p);
+        TEST_CHECK_EQUAL(e.size(), unsigned(n * n));
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i)
+                TEST_CHECK_NEARLY_EQUAL(e[j * n + i], p[0] * (i + 0.5) * (j + 0.5), 1e-12);
+
+        // same result for repeated calls
+        TEST_CHECK_EQUAL(fitter.LogLikelihood(p), fitter.LogLikelihood(p));
+    }
+
+    virtual void run() const
+    {
+        Bins();
+        Blocks();
+    }
+} bcHistogramFitterNDTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCHistogramFitterND.TEST || cat test-suite.log)"
+// End:
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCHistogramFitter.h>
+
+#include <TF1.h>
+#include <TH1D.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace test;
+
+class BCHistogramFitterTest :
+    public TestCase
+{
+public:
+    BCHistogramFitterTest():
+        TestCase("BCHistogramFitter")
+    {
+    }
+
+    /**
+     * Compare the bin integrals of the fitter to TF1::Integral().
+     * @param fitter The fitter of a histogram with 20 bins on [0, 10]
+     * @param f The fit function
+     * @param p The parameters: amplitude, mean, and standard deviation
+     * @param eps The tolerance relative to the total integral */
+    static void Compare(BCHistogramFitter& fitter, TF1& f, const std::vector<double>& p, double eps)
+    {
+        const std::vector<double>& integrals = fitter.IntegrateBins(p);
+        TEST_CHECK_EQUAL(integrals.size(), 20);
+
+        f.SetParameters(&p[0]);
+        const double total = p[0] * std::sqrt(2 * M_PI) * p[2];
+        for (unsigned i = 0; i < integrals.size(); ++i)
+            TEST_CHECK_NEARLY_EQUAL(integrals[i], f.Integral(0.5 * i, 0.5 * (i + 1)), eps * total);
+    }
+
+    virtual void run() const
+    {
+        TH1D hist("hist_integration", "", 20, 0, 10);
+        for (int i = 1; i <= hist.GetNbinsX(); ++i)
+            hist.SetBinContent(i, 10);
+
+        TF1 f("f_integration", "[0]*exp(-0.5*((x-[1])/[2])^2)", 0, 10);
+        f.SetParLimits(0, 0, 200);
+        f.SetParLimits(1, 0, 10);
+        f.SetParLimits(2, 0.01, 5);
+
+        BCHistogramFitter fitter(hist, f, "histogram_integration");
+
+        // a smooth and a peaked function
+        std::vector<double> smooth(3);
+        smooth[0] = 100;
+        smooth[1] = 5.2;
+        smooth[2] = 2;
+        std::vector<double> peaked(smooth);
+        peaked[2] = 0.05;
+
+        // adaptive integration by default
+        Compare(fitter, f, smooth, 1e-12);
+        Compare(fitter, f, peaked, 1e-12);
+
+        // a fixed rule suffices for the smooth function
+        fitter.SetIntegrationOrder(8);
+        Compare(fitter, f, smooth, 1e-8);
+
+        // the fallback catches the peaked one
+        fitter.SetIntegrationTolerance(1e-8);
+        Compare(fitter, f, smooth, 1e-8);
+        Compare(fitter, f, peaked, 1e-6);
+    }
+} bcHistogramFitterTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCHistogramFitter.TEST || cat test-suite.log)"
+// End:
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <test.h>
+#include <BAT/BCLog.h>
+
+#include <string>
+
+using namespace test;
+
+namespace
+{
+unsigned n_formatted = 0;
+
+std::string format(const std::string& message)
+{
+    ++n_formatted;
+    return message;
+}
+
+void limited()
+{
+    BCLOG_LIMITED(debug, 3, format("limited"); format("twice"));
+}
+}
+
+class BCLogTest :
+    public TestCase
+{
+public:
+    BCLogTest() :
+        TestCase("BCLog test")
+    {
+    }
+
+    virtual void run() const
+    {
+        const BCLog::LogLevel screen = BCLog::GetLogLevelScreen();
+        const BCLog::LogLevel file = BCLog::GetLogLevelFile();
+
+        // levels
+        {
+            BCLog::SetLogLevel(BCLog::warning);
+            TEST_CHECK(BCLog::IsActive(BCLog::error));
+            TEST_CHECK(BCLog::IsActive(BCLog::warning));
+            TEST_CHECK(!BCLog::IsActive(BCLog::summary));
+            TEST_CHECK(!BCLog::IsActive(BCLog::debug));
+        }
+
+        // message not formatted below the log level
+        {
+            n_formatted = 0;
+            BCLog::SetLogLevel(BCLog::summary);
+            BCLOG_DEBUG(format("not formatted"));
+            BCLOG_DETAIL(format("not formatted"));
+            TEST_CHECK_EQUAL(n_formatted, 0u);
+            BCLOG_SUMMARY(format("formatted"));
+            TEST_CHECK_EQUAL(n_formatted, 1u);
+        }
+
+        // rate limit per place in the code
+        {
+            n_formatted = 0;
+            BCLog::SetLogLevel(BCLog::nothing, BCLog::debug);
+            for (unsigned i = 0; i < 10; ++i)
+                BCLOG_OUT_LIMITED(debug, 3, format("limited"));
+            TEST_CHECK_EQUAL(n_formatted, 3u);
+
+            // nothing counted while inactive
+            n_formatted = 0;
+            BCLog::SetLogLevel(BCLog::nothing);
+            for (unsigned i = 0; i < 10; ++i)
+                limited();
+            TEST_CHECK_EQUAL(n_formatted, 0u);
+            BCLog::SetLogLevel(BCLog::nothing, BCLog::debug);
+            for (unsigned i = 0; i < 10; ++i)
+                limited();
+            TEST_CHECK_EQUAL(n_formatted, 6u);
+
+            // and again after a reset
+            n_formatted = 0;
+            BCLog::ResetMessageLimits();
+            for (unsigned i = 0; i < 10; ++i)
+                limited();
+            TEST_CHECK_EQUAL(n_formatted, 6u);
+        }
+
+        BCLog::SetLogLevel(file, screen);
+    }
+} bcLogTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCLog.TEST || cat test-suite.log)"
+// End:
@@ -9,7 +9,9 @@
 #include <test.h>
 #include <BAT/BCMath.h>
 #include <BAT/BCEngineMCMC.h>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 using namespace test;
 using namespace BCMath;
@@ -66,6 +68,17 @@ public:
             /* p = 1 - P(1|1.3) */
             observed = std::vector<unsigned> (1, 0);
             TEST_CHECK_RELATIVE_ERROR(FastPValue(observed, expected, 1e6, 123), 1 - 0.35429133094421639, 5e-3);
+
+            /* several walkers with burn-in, reproducible for fixed seed */
+            TEST_CHECK_RELATIVE_ERROR(FastPValue(observed, expected, 1e6, 123, 4, 100), 1 - 0.35429133094421639, 5e-3);
+            TEST_CHECK_EQUAL(FastPValue(observed, expected, 1e5, 123, 3, 10), FastPValue(observed, expected, 1e5, 123, 3, 10));
+
+            /* defaults: one walker without burn-in, several with burn-in */
+            TEST_CHECK_EQUAL(FastPValue(observed, expected, 1e5, 123), FastPValue(observed, expected, 1e5, 123, 1, 0));
+            TEST_CHECK_EQUAL(FastPValue(observed, expected, 1e5, 123, 3), FastPValue(observed, expected, 1e5, 123, 3, 100));
+
+            /* stop early at the requested precision */
+            TEST_CHECK_RELATIVE_ERROR(FastPValue(observed, expected, 1e8, 123, 4, 100, 1e-3), 1 - 0.35429133094421639, 1e-2);
         }
     }
 } bcPValueTest;
@@ -105,6 +118,181 @@ public:
     }
 } gammaTest;
 
+class GaussLegendreTest :
+    public TestCase
+{
+public:
+    GaussLegendreTest() :
+        TestCase("GaussLegendre test")
+    {
+    }
+
+    virtual void run() const
+    {
+        static const double eps = 1e-13;
+
+        for (unsigned n = 1; n <= 20; ++n) {
+            std::vector<double> x, w;
+            BCMath::GaussLegendre(n, x, w);
+            TEST_CHECK_EQUAL(x.size(), n);
+            TEST_CHECK_EQUAL(w.size(), n);
+
+            // exact for polynomials of degree 2n-1
+            double sum0 = 0;
+            double sum2 = 0;
+            double sumn = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                sum0 += w[i];
+                sum2 += w[i] * x[i] * x[i];
+                sumn += w[i] * std::pow(x[i], 2 * int(n) - 2);
+            }
+            TEST_CHECK_RELATIVE_ERROR(sum0, 2, eps);
+            if (n > 1)
+                TEST_CHECK_RELATIVE_ERROR(sum2, 2. / 3., eps);
+            TEST_CHECK_RELATIVE_ERROR(sumn, 2. / (2 * n - 1), eps);
+        }
+
+        // smooth function: integral of exp over [-1, 1]
+        std::vector<double> x, w;
+        BCMath::GaussLegendre(8, x, w);
+        double sum = 0;
+        for (unsigned i = 0; i < x.size(); ++i)
+            sum += w[i] * std::exp(x[i]);
+        TEST_CHECK_RELATIVE_ERROR(sum, std::exp(1.) - std::exp(-1.), eps);
+    }
+} gaussLegendreTest;
+
+class LogFactTest :
+    public TestCase
+{
+public:
+    LogFactTest() :
+        TestCase("LogFact test")
+    {
+    }
+
+    virtual void run() const
+    {
+        static const double eps = 1e-13;
+
+        // table and Gamma function agree
+        TEST_CHECK_EQUAL(LogFact(0), 0);
+        TEST_CHECK_EQUAL(LogFact(1), 0);
+        TEST_CHECK_RELATIVE_ERROR(LogFact(10), std::log(3628800.), eps);
+        const unsigned n = CacheFactorials(0);
+        TEST_CHECK(n >= 100);
+        TEST_CHECK_RELATIVE_ERROR(LogFact(n - 1) + std::log(double(n)), LogFact(n), eps);
+        TEST_CHECK_RELATIVE_ERROR(LogFact(100000), lgamma(100001.), eps);
+        TEST_CHECK_RELATIVE_ERROR(ApproxLogFact(1e6), lgamma(1e6 + 1), eps);
+
+        // readers see old or new table while it grows
+        std::vector<double> expected(4 * n);
+        for (unsigned i = 0; i < expected.size(); ++i)
+            expected[i] = LogFact(i);
+        int wrong = 0;
+        #pragma omp parallel for reduction(+:wrong)
+        for (int i = 0; i < int(expected.size()); ++i) {
+            if (i % n == 0)
+                CacheFactorials(n + i);
+            wrong += std::fabs(LogFact(i) - expected[i]) > eps * expected[i];
+        }
+        TEST_CHECK_EQUAL(wrong, 0);
+        TEST_CHECK_EQUAL(CacheFactorials(0), 4 * n + 1);
+    }
+} logFactTest;
+
+class BatchTest :
+    public TestCase
+{
+public:
+    BatchTest() :
+        TestCase("batch log densities test")
+    {
+    }
+
+    /// equal up to relative precision eps, also for zero, infinite and NaN values
+    static bool Same(double a, double b, double eps = 1e-12)
+    {
+        if (std::isnan(a) or std::isnan(b))
+            return std::isnan(a) and std::isnan(b);
+        return a == b or std::fabs(a - b) <= eps * std::max(std::fabs(a), std::fabs(b));
+    }
+
+    virtual void run() const
+    {
+        static const double eps = 1e-12;
+        static const unsigned N = 1000;
+
+        // log: special values and values across the range of doubles
+        {
+            std::vector<double> x;
+            x.push_back(0);
+            x.push_back(-1);
+            x.push_back(std::numeric_limits<double>::infinity());
+            x.push_back(std::numeric_limits<double>::denorm_min());
+            x.push_back(std::numeric_limits<double>::max());
+            x.push_back(1);
+            x.push_back(std::sqrt(2.));
+            for (int e = -700; e < 700; ++e)
+                x.push_back(std::exp(e + 0.3));
+            std::vector<double> y(x.size());
+            Log(x.size(), &x[0], &y[0]);
+            unsigned wrong = 0;
+            for (unsigned i = 0; i < x.size(); ++i)
+                wrong += std::fabs(y[i] - std::log(x[i])) > 2.3e-16 * std::fabs(std::log(x[i]));
+            TEST_CHECK_EQUAL(wrong, 0);
+            TEST_CHECK(std::isnan(y[1]));
+            TEST_CHECK_EQUAL(y[0], -std::numeric_limits<double>::infinity());
+        }
+
+        // batch versions agree with scalar versions, including special cases
+        std::vector<double> x(N), mean(N), sigma(N), sigma2(N), lambda(N), p(N), result(N);
+        std::vector<unsigned> trials(N), k(N);
+        for (unsigned i = 0; i < N; ++i) {
+            x[i] = i % 37;
+            mean[i] = 0.01 * i - 5;
+            sigma[i] = (i % 17 == 0) ? 0 : (i % 2 ? 1 : -1) * (0.5 + 0.001 * i);
+            sigma2[i] = 0.2 + 0.003 * i;
+            lambda[i] = (i % 19 == 0) ? -1 : 2.3 * i;
+            p[i] = (i % 23) / 22.;
+            trials[i] = i % 50;
+            k[i] = i % 53;
+        }
+
+        double sum = 0;
+        LogGaus(N, &x[0], &mean[0], &sigma[0], &result[0], true);
+        for (unsigned i = 0; i < N; ++i) {
+            TEST_CHECK(Same(result[i], LogGaus(x[i], mean[i], sigma[i], true)));
+            sum += result[i];
+        }
+        TEST_CHECK_RELATIVE_ERROR(SumLogGaus(N, &x[0], &mean[0], &sigma[0], true), sum, eps);
+
+        LogSplitGaus(N, &x[0], &mean[0], &sigma2[0], &sigma[0], &result[0], true);
+        for (unsigned i = 0; i < N; ++i)
+            TEST_CHECK(Same(result[i], LogSplitGaus(x[i], mean[i], sigma2[i], sigma[i], true)));
+
+        LogPoisson(N, &x[0], &lambda[0], &result[0]);
+        for (unsigned i = 0; i < N; ++i) {
+            TEST_CHECK(Same(result[i], LogPoisson(x[i], lambda[i])));
+        }
+        for (unsigned i = 0; i < N; ++i)
+            lambda[i] = std::fabs(lambda[i]);
+        TEST_CHECK(std::isfinite(SumLogPoisson(N, &x[0], &lambda[0])));
+
+        LogApproxBinomial(N, &trials[0], &k[0], &p[0], &result[0]);
+        for (unsigned i = 0; i < N; ++i)
+            TEST_CHECK(Same(result[i], LogApproxBinomial(trials[i], k[i], p[i])));
+
+        LogLogNormal(N, &sigma2[0], &mean[0], &sigma[0], &result[0]);
+        for (unsigned i = 0; i < N; ++i)
+            TEST_CHECK(Same(result[i], LogLogNormal(sigma2[i], mean[i], sigma[i])));
+
+        LogGammaPDF(N, &sigma2[0], &sigma2[0], &lambda[0], &result[0]);
+        for (unsigned i = 0; i < N; ++i)
+            TEST_CHECK(Same(result[i], LogGammaPDF(sigma2[i], sigma2[i], lambda[i])));
+    }
+} batchTest;
+
 // Local Variables:
 // compile-command: "make check TESTS= && (./BCMath.TEST || cat test-suite.log)"
 // End:
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "GaussModel.h"
+#include "test.h"
+
+#include <BAT/BCH1D.h>
+#include <BAT/BCModelManager.h>
+
+#include <TDirectory.h>
+
+using namespace test;
+
+class BCModelManagerTest :
+    public TestCase
+{
+public:
+    BCModelManagerTest():
+        TestCase("BCModelManager")
+    {
+    }
+
+    /// models with one and two parameters, evidences 1/30 and 1/900
+    void compare(unsigned nconcurrent) const
+    {
+        GaussModel m1("one", 1);
+        GaussModel m2("two", 2);
+
+        BCModelManager mm;
+        mm.AddModel(&m1, 0.5);
+        mm.AddModel(&m2, 0.5);
+        mm.SetNConcurrentModels(nconcurrent);
+        TEST_CHECK_EQUAL(mm.GetNConcurrentModels(), nconcurrent);
+
+        mm.SetIntegrationMethod(BCIntegrate::kIntMonteCarlo);
+        mm.SetRelativePrecision(1e-2);
+        mm.Integrate();
+        TEST_CHECK_RELATIVE_ERROR(m1.GetIntegral(), m1.evidence(), 5e-2);
+        TEST_CHECK_RELATIVE_ERROR(m2.GetIntegral(), m2.evidence(), 5e-2);
+        TEST_CHECK_RELATIVE_ERROR(mm.BayesFactor(0, 1), 30, 1e-1);
+
+        const unsigned nobjects = gDirectory->GetList()->GetSize();
+        mm.SetPrecision(BCEngineMCMC::kLow);
+        mm.MarginalizeAll();
+        TEST_CHECK(m1.GetMarginalized(0).Valid());
+        TEST_CHECK(m2.GetMarginalized(1).Valid());
+        TEST_CHECK_NEARLY_EQUAL(m2.GetMarginalizedHistogram(1)->GetMean(), m2.mean(), 0.1);
+        if (nconcurrent > 1)
+            TEST_CHECK_EQUAL(gDirectory->GetList()->GetSize(), nobjects);
+
+        // Minuit keeps global state, so concurrent models take turns
+        mm.SetOptimizationMethod(BCIntegrate::kOptMinuit);
+        mm.FindMode();
+        TEST_CHECK_NEARLY_EQUAL(m1.GetBestFitParameters()[0], m1.mean(), 1e-3);
+        TEST_CHECK_NEARLY_EQUAL(m2.GetBestFitParameters()[0], m2.mean(), 1e-3);
+        TEST_CHECK_NEARLY_EQUAL(m2.GetBestFitParameters()[1], m2.mean(), 1e-3);
+
+        // so does simulated annealing, whose lookup table depends on the dimension
+        mm.SetOptimizationMethod(BCIntegrate::kOptSimAnn);
+        mm.FindMode();
+        TEST_CHECK_NEARLY_EQUAL(m1.GetBestFitParameters()[0], m1.mean(), 1e-2);
+        TEST_CHECK_NEARLY_EQUAL(m2.GetBestFitParameters()[0], m2.mean(), 1e-2);
+        TEST_CHECK_NEARLY_EQUAL(m2.GetBestFitParameters()[1], m2.mean(), 1e-2);
+
+        // the Laplace approximation is exact for a Gaussian
+        mm.SetIntegrationMethod(BCIntegrate::kIntLaplace);
+        mm.Integrate();
+        TEST_CHECK_RELATIVE_ERROR(m1.GetIntegral(), m1.evidence(), 1e-2);
+        TEST_CHECK_RELATIVE_ERROR(m2.GetIntegral(), m2.evidence(), 1e-2);
+    }
+
+    virtual void run() const
+    {
+        compare(1);
+        compare(2);
+    }
+} bcmodelmanager_test;
@@ -11,6 +11,8 @@
 
 #include <TH1.h>
 
+#include <BAT/BCDataPoint.h>
+#include <BAT/BCDataSet.h>
 #include <BAT/BCH1D.h>
 #include <BAT/BCH2D.h>
 #include <BAT/BCParameter.h>
@@ -128,6 +130,73 @@ public:
         TEST_CHECK_EQUAL(m2.GetNChains(), m.GetNChains());
     }
 
+    /// log density of a point is its first value
+    struct Identity : public BCModel::PointLogDensity
+    {
+        virtual double operator()(const BCDataSet::ConstRow& point) const
+        { return point[0]; }
+    };
+
+    /// log density of point i is 1 / (i + 1); checks the slot
+    struct Harmonic : public BCModel::BlockLogDensity
+    {
+        Harmonic(unsigned nslots) : nslots(nslots), bad_slot(false) {}
+
+        virtual void operator()(unsigned begin, unsigned end, unsigned slot, double* logdensity) const
+        {
+            if (slot >= nslots or end - begin > BCModel::GetLogDensityBlockSize())
+                bad_slot = true;
+            for (unsigned i = begin; i < end; ++i)
+                logdensity[i - begin] = 1. / (i + 1);
+        }
+
+        unsigned nslots;
+        mutable bool bad_slot;
+    };
+
+    void sumLogDensities() const
+    {
+        GaussModel m("sum", 1);
+        Identity f;
+
+        // no data
+        TEST_CHECK_EQUAL(m.SumLogDensities(f), 0);
+
+        // small terms lost in naive summation
+        static const unsigned N = 10000;
+        BCDataSet ds;
+        BCDataPoint p(1);
+        p[0] = 1;
+        ds.AddDataPoint(p);
+        p[0] = 1e-16;
+        for (unsigned i = 0; i < N; ++i)
+            ds.AddDataPoint(p);
+        m.SetDataSet(&ds);
+        TEST_CHECK_NEARLY_EQUAL(m.SumLogDensities(f), 1 + N * 1e-16, 1e-15);
+
+        // weighted points give the same result
+        ds.Compact();
+        TEST_CHECK_EQUAL(ds.GetNDataPoints(), 2);
+        TEST_CHECK_NEARLY_EQUAL(m.SumLogDensities(f), 1 + N * 1e-16, 1e-15);
+
+        // blocks of points outside of the data set, serial and parallel
+        static const unsigned M = 5 * BCModel::GetLogDensityBlockSize() + 3;
+        double expected = 0;
+        std::vector<double> weights(M);
+        for (unsigned i = M; i > 0; --i) {
+            expected += 1. / i;
+            weights[i - 1] = 2;
+        }
+        for (unsigned nslots = 1; nslots <= 64; nslots *= 64) {
+            Harmonic h(nslots);
+            TEST_CHECK_NEARLY_EQUAL(m.SumLogDensities(M, h, nslots), expected, 1e-13);
+            TEST_CHECK_NEARLY_EQUAL(m.SumLogDensities(M, h, nslots, &weights[0]), 2 * expected, 1e-13);
+            TEST_CHECK(!h.bad_slot);
+        }
+        Harmonic h(1);
+        TEST_CHECK_EQUAL(m.SumLogDensities(0, h, 1), 0);
+    }
+
     virtual void run() const
     {
         storing();
@@ -135,6 +204,7 @@ public:
         fixing(false);
         deltaPrior();
         copy();
+        sumLogDensities();
     }
 } bcmodel_test;
 
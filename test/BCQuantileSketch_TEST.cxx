@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <test.h>
+#include <BAT/BCQuantileSketch.h>
+
+#include <cmath>
+
+using namespace test;
+
+class BCQuantileSketchTest :
+    public TestCase
+{
+public:
+    BCQuantileSketchTest() :
+        TestCase("BCQuantileSketch test")
+    {
+    }
+
+    virtual void run() const
+    {
+        static const unsigned N = 100000;
+
+        // empty
+        {
+            BCQuantileSketch s;
+            const double q = s.GetQuantile(0.5);
+            TEST_CHECK(q != q);
+        }
+
+        // uniform values in a scrambled order
+        {
+            BCQuantileSketch s(100);
+            for (unsigned i = 0; i < N; ++i)
+                s.Add((i * 7919) % N);
+
+            TEST_CHECK_EQUAL(s.GetTotalWeight(), N);
+            TEST_CHECK_EQUAL(s.GetQuantile(0), 0);
+            TEST_CHECK_EQUAL(s.GetQuantile(1), N - 1);
+
+            // memory bounded by compression
+            TEST_CHECK(s.GetNCentroids() <= 100);
+
+            // any interval of a uniform distribution is smallest
+            std::pair<double, double> interval = s.GetSmallestInterval(0.68);
+            TEST_CHECK_NEARLY_EQUAL((interval.second - interval.first) / N, 0.68, 1e-2);
+
+            static const double p[] = { 0.001, 0.01, 0.16, 0.5, 0.84, 0.99, 0.999 };
+            for (unsigned i = 0; i < sizeof(p) / sizeof(p[0]); ++i) {
+                // relative accuracy is better in the tails
+                const double eps = 2e-2 * std::sqrt(p[i] * (1 - p[i]));
+                TEST_CHECK_NEARLY_EQUAL(s.GetQuantile(p[i]) / N, p[i], eps);
+            }
+        }
+
+        // merging is equivalent to adding all values
+        {
+            BCQuantileSketch all, a, b;
+            for (unsigned i = 0; i < N; ++i) {
+                const double x = std::exp(double((i * 7919) % N) / N);
+                all.Add(x);
+                if (i % 2)
+                    a.Add(x);
+                else
+                    b.Add(x);
+            }
+            a.Merge(b);
+
+            TEST_CHECK_EQUAL(a.GetTotalWeight(), all.GetTotalWeight());
+            TEST_CHECK_EQUAL(a.GetQuantile(0), all.GetQuantile(0));
+            TEST_CHECK_EQUAL(a.GetQuantile(1), all.GetQuantile(1));
+            TEST_CHECK_RELATIVE_ERROR(a.GetQuantile(0.05), all.GetQuantile(0.05), 1e-3);
+            TEST_CHECK_RELATIVE_ERROR(a.GetQuantile(0.5), all.GetQuantile(0.5), 1e-3);
+            TEST_CHECK_RELATIVE_ERROR(a.GetQuantile(0.95), all.GetQuantile(0.95), 1e-3);
+
+            // cleared but usable
+            a.Reset();
+            TEST_CHECK_EQUAL(a.GetTotalWeight(), 0);
+            a.Add(3.);
+            TEST_CHECK_EQUAL(a.GetQuantile(0.5), 3.);
+        }
+
+        // weights
+        {
+            BCQuantileSketch s;
+            s.Add(1., 3.);
+            s.Add(2., 1.);
+            TEST_CHECK_EQUAL(s.GetTotalWeight(), 4);
+            TEST_CHECK(s.GetQuantile(0.25) < s.GetQuantile(0.75));
+        }
+
+        // smallest interval of a peaked distribution: x = t^3 for uniform t in [-1, 1]
+        {
+            BCQuantileSketch s;
+            for (unsigned i = 0; i < N; ++i) {
+                const double t = 2. * ((i * 7919) % N) / N - 1;
+                s.Add(t * t * t);
+            }
+            std::pair<double, double> interval = s.GetSmallestInterval(0.5);
+            TEST_CHECK_NEARLY_EQUAL(interval.first, -0.125, 1e-2);
+            TEST_CHECK_NEARLY_EQUAL(interval.second, 0.125, 1e-2);
+        }
+    }
+} bcQuantileSketchTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCQuantileSketch.TEST || cat test-suite.log)"
+// End:
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCSimultaneousFitter.h>
+
+#include <BAT/BCModel.h>
+
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace test;
+
+/**
+ * A Gaussian likelihood in each parameter, centered at its index,
+ * that counts its evaluations and records the chains it ran in. */
+class CountingModel : public BCModel
+{
+public:
+    CountingModel(const std::string& name, const std::vector<std::string>& parameters) :
+        BCModel(name),
+        fCalls(0)
+    {
+        for (unsigned i = 0; i < parameters.size(); ++i)
+            AddParameter(parameters[i], -5, 5);
+        SetPriorConstantAll();
+    }
+
+    virtual double LogLikelihood(const std::vector<double>& parameters)
+    {
+        const unsigned chain = GetCurrentChain();
+        #pragma omp critical(CountingModel__LogLikelihood)
+        {
+            ++fCalls;
+            fChains.insert(chain);
+        }
+
+        double logl = 0;
+        for (unsigned i = 0; i < parameters.size(); ++i)
+            logl -= 0.5 * (parameters[i] - i) * (parameters[i] - i);
+        return logl;
+    }
+
+    unsigned long fCalls;
+    std::set<unsigned> fChains;
+};
+
+class BCSimultaneousFitterTest :
+    public TestCase
+{
+public:
+    BCSimultaneousFitterTest():
+        TestCase("BCSimultaneousFitter")
+    {
+    }
+
+    static std::vector<std::string> Names(const std::string& a, const std::string& b)
+    {
+        std::vector<std::string> names;
+        names.push_back(a);
+        names.push_back(b);
+        return names;
+    }
+
+    void Mapping() const
+    {
+        CountingModel a("a", Names("mu", "sigma"));
+        CountingModel b("b", Names("mu", "tau"));
+        CountingModel c("c", Names("x", "y"));
+
+        BCSimultaneousFitter fitter("simultaneous_mapping");
+        TEST_CHECK_EQUAL(fitter.AddModel(a), 0);
+        TEST_CHECK_EQUAL(fitter.AddModel(b), 1);
+        TEST_CHECK_EQUAL(fitter.GetNParameters(), 3);
+        TEST_CHECK_EQUAL(fitter.GetParameter(0).GetName(), "mu");
+        TEST_CHECK_EQUAL(fitter.GetParameter(1).GetName(), "sigma");
+        TEST_CHECK_EQUAL(fitter.GetParameter(2).GetName(), "tau");
+
+        // shared by name
+        TEST_CHECK_EQUAL(fitter.GetParameterIndices(0)[0], 0);
+        TEST_CHECK_EQUAL(fitter.GetParameterIndices(0)[1], 1);
+        TEST_CHECK_EQUAL(fitter.GetParameterIndices(1)[0], 0);
+        TEST_CHECK_EQUAL(fitter.GetParameterIndices(1)[1], 2);
+
+        // explicit map, in reverse order
+        std::vector<unsigned> indices(2);
+        indices[0] = 2;
+        indices[1] = 1;
+        TEST_CHECK_EQUAL(fitter.AddModel(c, indices), 2);
+        TEST_CHECK_EQUAL(fitter.GetNParameters(), 3);
+
+        // no model twice, none with bad indices
+        TEST_CHECK_THROWS(std::invalid_argument, fitter.AddModel(a));
+        TEST_CHECK_THROWS(std::invalid_argument, fitter.AddModel(b, indices));
+        indices[0] = 3;
+        CountingModel d("d", Names("x", "y"));
+        TEST_CHECK_THROWS(std::invalid_argument, fitter.AddModel(d, indices));
+        TEST_CHECK_EQUAL(fitter.GetNModels(), 3);
+    }
+
+    void Likelihood() const
+    {
+        CountingModel a("a", Names("mu", "sigma"));
+        CountingModel b("b", Names("mu", "tau"));
+
+        BCSimultaneousFitter fitter("simultaneous_likelihood");
+        fitter.AddModel(a);
+        fitter.AddModel(b);
+
+        std::vector<double> p(3);
+        p[0] = 0.3;
+        p[1] = -1.2;
+        p[2] = 2.5;
+
+        std::vector<double> pa(2);
+        pa[0] = p[0];
+        pa[1] = p[1];
+        std::vector<double> pb(2);
+        pb[0] = p[0];
+        pb[1] = p[2];
+
+        // the sum of the sub-likelihoods
+        const double expected = a.LogLikelihood(pa) + b.LogLikelihood(pb);
+        a.fCalls = b.fCalls = 0;
+        TEST_CHECK_NEARLY_EQUAL(fitter.LogLikelihood(p), expected, 1e-14);
+        TEST_CHECK_EQUAL(a.fCalls, 1);
+        TEST_CHECK_EQUAL(b.fCalls, 1);
+
+        // same point: both from the cache
+        TEST_CHECK_NEARLY_EQUAL(fitter.LogLikelihood(p), expected, 1e-14);
+        TEST_CHECK_EQUAL(a.fCalls, 1);
+        TEST_CHECK_EQUAL(b.fCalls, 1);
+
+        // tau only enters b
+        p[2] = 1.5;
+        pb[1] = p[2];
+        const double changed = a.LogLikelihood(pa) + b.LogLikelihood(pb);
+        a.fCalls = b.fCalls = 0;
+        TEST_CHECK_NEARLY_EQUAL(fitter.LogLikelihood(p), changed, 1e-14);
+        TEST_CHECK_EQUAL(a.fCalls, 0);
+        TEST_CHECK_EQUAL(b.fCalls, 1);
+
+        // mu enters both
+        a.fCalls = b.fCalls = 0;
+        p[0] = -0.7;
+        fitter.LogLikelihood(p);
+        TEST_CHECK_EQUAL(a.fCalls, 1);
+        TEST_CHECK_EQUAL(b.fCalls, 1);
+
+        // without the cache, every call evaluates every sub-model
+        fitter.SetFlagCacheLikelihoods(false);
+        fitter.LogLikelihood(p);
+        TEST_CHECK_EQUAL(a.fCalls, 2);
+        TEST_CHECK_EQUAL(b.fCalls, 2);
+    }
+
+    void Chains() const
+    {
+        CountingModel a("a", Names("mu", "sigma"));
+        CountingModel b("b", Names("mu", "tau"));
+
+        BCSimultaneousFitter fitter("simultaneous_chains");
+        fitter.AddModel(a);
+        fitter.AddModel(b);
+
+        // sub-models are run with the chains of the fitter
+        fitter.SetPrecision(BCEngineMCMC::kLow);
+        fitter.SetNChains(3);
+        fitter.MarginalizeAll(BCIntegrate::kMargMetropolis);
+
+        TEST_CHECK_EQUAL(a.GetNChains(), 3);
+        TEST_CHECK_EQUAL(b.GetNChains(), 3);
+        TEST_CHECK_EQUAL(a.fChains.size(), 3);
+        TEST_CHECK_EQUAL(b.fChains.size(), 3);
+        TEST_CHECK_EQUAL(*a.fChains.rbegin(), 2);
+
+        // the mode is at mu = 0, sigma = 1, tau = 1
+        TEST_CHECK_NEARLY_EQUAL(fitter.GetBestFitParameters()[0], 0, 0.3);
+        TEST_CHECK_NEARLY_EQUAL(fitter.GetBestFitParameters()[1], 1, 0.3);
+        TEST_CHECK_NEARLY_EQUAL(fitter.GetBestFitParameters()[2], 1, 0.3);
+    }
+
+    virtual void run() const
+    {
+        Mapping();
+        Likelihood();
+        Chains();
+    }
+} bcSimultaneousFitterTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCSimultaneousFitter.TEST || cat test-suite.log)"
+// End:
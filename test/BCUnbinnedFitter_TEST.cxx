@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2007-2015, the BAT core developer team
+ * All rights reserved.
+ *
+ * For the licensing terms see doc/COPYING.
+ * For documentation see http://mpp.mpg.de/bat
+ */
+
+#include <config.h>
+#include "test.h"
+
+#include <models/base/BCUnbinnedFitter.h>
+
+#include <BAT/BCDataPoint.h>
+#include <BAT/BCDataSet.h>
+#include <BAT/BCMath.h>
+
+#include <TF1.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace test;
+
+class BCUnbinnedFitterTest :
+    public TestCase
+{
+public:
+    BCUnbinnedFitterTest():
+        TestCase("BCUnbinnedFitter")
+    {
+    }
+
+    /**
+     * Five events with mean 1 and variance 2, far from the bounds,
+     * each repeated n times. */
+    static BCDataSet Events(unsigned n = 1)
+    {
+        BCDataSet data = UnboundedEvents(n);
+        data.SetBounds(0, -9, 11);
+        return data;
+    }
+
+    /**
+     * The same events without bounds set by the user. */
+    static BCDataSet UnboundedEvents(unsigned n = 1)
+    {
+        BCDataSet data;
+        for (unsigned k = 0; k < n; ++k)
+            for (int i = -2; i <= 2; ++i) {
+                data.AddDataPoint(BCDataPoint(1));
+                data.Back()[0] = 1 + i;
+            }
+        return data;
+    }
+
+    void Likelihood() const
+    {
+        TF1 f("f_unbinned_test", "exp(-0.5*((x-[0])/[1])^2)", -9, 11);
+        f.SetParLimits(0, -2, 4);
+        f.SetParLimits(1, 0.5, 4);
+
+        BCUnbinnedFitter fitter(f, Events(), "unbinned_test");
+        TEST_CHECK_EQUAL(fitter.GetNEvents(), 5);
+        TEST_CHECK_EQUAL(fitter.GetTotalWeight(), 5);
+
+        std::vector<double> p(2);
+        p[0] = 1;
+        p[1] = std::sqrt(2.);
+
+        // the integral over [-9, 11] misses tails beyond 7 sigma
+        const double norm = std::sqrt(2 * M_PI) * p[1];
+        TEST_CHECK_RELATIVE_ERROR(fitter.GetNormalization(p), norm, 1e-9);
+
+        // log densities -1, -1/4, 0, -1/4, -1
+        const double logf = -2.5;
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), logf - 5 * std::log(norm), 1e-9);
+
+        // extended: Poisson probability of five events for the expectation norm
+        fitter.SetExtended();
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), logf - norm - std::log(120.), 1e-9);
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p) - logf, BCMath::LogPoisson(5, norm), 1e-9);
+
+        // density declared normalized: no integral
+        fitter.SetExtended(false);
+        fitter.SetFlagNormalized();
+        TEST_CHECK_RELATIVE_ERROR(fitter.LogLikelihood(p), logf, 1e-12);
+    }
+
+    void Domain() const
+    {
+        std::vector<double> p(2);
+        p[0] = 1;
+        p[1] = std::sqrt(2.);
+        const double norm = std::sqrt(2 * M_PI) * p[1];
+
+        // without bounds: the range of the function, not the events in [-1, 3]
+        {
+            TF1 f("f_unbinned_domain", "exp(-0.5*((x-[0])/[1])^2)", -9, 11);
+            f.SetParLimits(0, -2, 4);
+            f.SetParLimits(1, 0.5, 4);
+
+            BCUnbinnedFitter fitter(f, UnboundedEvents(), "unbinned_domain");
+            TEST_CHECK_RELATIVE_ERROR(fitter.GetNormalization(p), norm, 1e-9);
+
+            // and the fit is unbiased
+            std::vector<double> start(2);
+            start[0] = 0.5;
+            start[1] = 1;
+            const std::vector<double> mode = fitter.FindMode(BCIntegrate::kOptMinuit, start);
+            TEST_CHECK_NEARLY_EQUAL(mode[0], 1, 1e-3);
+            TEST_CHECK_NEARLY_EQUAL(mode[1], std::sqrt(2.), 1e-3);
+        }
+
+        // bounds on the data take precedence over the range of the function
+        {
+            TF1 f("f_unbinned_domain_bounds", "exp(-0.5*((x-[0])/[1])^2)", -20, 20);
+            f.SetParLimits(0, -2, 4);
+            f.SetParLimits(1, 0.5, 4);
+
+            BCDataSet data = UnboundedEvents();
+            data.SetBounds(0, 1, 11);
+            BCUnbinnedFitter fitter(f, data, "unbinned_domain_bounds");
+            TEST_CHECK_RELATIVE_ERROR(fitter.GetNormalization(p), norm / 2, 1e-9);
+        }
+    }
+
+    void Fit() const
+    {
+        // maximum likelihood: sample mean and standard deviation
+        {
+            TF1 f("f_unbinned_fit", "exp(-0.5*((x-[0])/[1])^2)", -9, 11);
+            f.SetParLimits(0, -2, 4);
+            f.SetParLimits(1, 0.5, 4);
+
+            BCUnbinnedFitter fitter(f, Events(), "unbinned_fit");
+            std::vector<double> start(2);
+            start[0] = 0.5;
+            start[1] = 1;
+            const std::vector<double> mode = fitter.FindMode(BCIntegrate::kOptMinuit, start);
+            TEST_CHECK_NEARLY_EQUAL(mode[0], 1, 1e-3);
+            TEST_CHECK_NEARLY_EQUAL(mode[1], std::sqrt(2.), 1e-3);
+        }
+
+        // extended: the expected number of events equals the observed one
+        {
+            TF1 f("f_unbinned_fit_ext", "[2]*exp(-0.5*((x-[0])/[1])^2)", -9, 11);
+            f.SetParLimits(0, -2, 4);
+            f.SetParLimits(1, 0.5, 4);
+            f.SetParLimits(2, 0.1, 10);
+
+            BCUnbinnedFitter fitter(f, Events(), "unbinned_fit_ext");
+            fitter.SetExtended();
+            std::vector<double> start(3);
+            start[0] = 0.5;
+            start[1] = 1;
+            start[2] = 1;
+            const std::vector<double> mode = fitter.FindMode(BCIntegrate::kOptMinuit, start);
+            TEST_CHECK_NEARLY_EQUAL(mode[0], 1, 1e-3);
+            TEST_CHECK_NEARLY_EQUAL(mode[1], std::sqrt(2.), 1e-3);
+            TEST_CHECK_RELATIVE_ERROR(fitter.GetNormalization(mode), 5, 1e-3);
+        }
+    }
+
+    void Weights() const
+    {
+        TF1 f("f_unbinned_weights", "exp(-0.5*((x-[0])/[1])^2)", -9, 11);
+        f.SetParLimits(0, -2, 4);
+        f.SetParLimits(1, 0.5, 4);
+
+        // every event twice, compacted to weights of two
+        BCDataSet twice = Events(2);
+        TEST_CHECK_EQUAL(twice.Compact(), 5);
+
+        BCUnbinnedFitter once(f, Events(), "unbinned_once");
+        BCUnbinnedFitter compact(f, twice, "unbinned_twice");
+        TEST_CHECK_EQUAL(compact.GetNEvents(), 5);
+        TEST_CHECK_EQUAL(compact.GetTotalWeight(), 10);
+
+        std::vector<double> p(2);
+        p[0] = 0.7;
+        p[1] = 1.3;
+        TEST_CHECK_RELATIVE_ERROR(compact.LogLikelihood(p), 2 * once.LogLikelihood(p), 1e-12);
+    }
+
+    virtual void run() const
+    {
+        Likelihood();
+        Domain();
+        Fit();
+        Weights();
+    }
+} bcUnbinnedFitterTest;
+
+// Local Variables:
+// compile-command: "make check TESTS= && (./BCUnbinnedFitter.TEST || cat test-suite.log)"
+// End: